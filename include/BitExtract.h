@@ -0,0 +1,150 @@
+#pragma once
+/*!
+ * @file BitExtract.h
+ * @brief Bit-field extraction from big-endian process data records with
+ *        one 64-bit load per field, and the insertion for PD out
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace bitextract
+{
+
+// Readable bytes needed in front of a record: a field is loaded as the 8 (9
+// if it straddles) bytes ending at its least significant byte.
+constexpr std::size_t PADDING = 16u;
+
+inline uint64_t loadBigEndian64(const uint8_t *p)
+{
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+/** \brief The lowest bitLength (1..64) bits of value. */
+inline uint64_t lowBits(uint64_t value, unsigned bitLength)
+{
+#if defined(__BMI2__)
+    return _bzhi_u64(value, bitLength);
+#else
+    return (bitLength >= 64u) ? value : (value & ((uint64_t(1) << bitLength) - 1u));
+#endif
+}
+
+/**
+ * \brief Extracts a field of up to 64 bits.
+ *
+ * Bits outside the field are masked off, so the padding may hold anything.
+ *
+ * \param end pointer behind the last byte of the record, PADDING readable bytes
+ * have to precede the record
+ * \param bitOffset offset of the field from the LSB of the record (as in the IODD)
+ * \param bitLength 1..64, the field has to be inside the record
+ */
+inline uint64_t extractFromRight(const uint8_t *end, unsigned bitOffset, unsigned bitLength)
+{
+    const unsigned first = bitOffset >> 3u; // byte with the LSB, counted from the right
+    const unsigned shift = bitOffset & 7u;
+    uint64_t word = loadBigEndian64(end - first - 8u) >> shift;
+    if (shift + bitLength > 64u)
+    {
+        word |= uint64_t(end[-static_cast<std::ptrdiff_t>(first) - 9]) << (64u - shift);
+    }
+    return lowBits(word, bitLength);
+}
+
+/** \brief Two's complement value of the lowest bitLength (1..64) bits. */
+inline int64_t signExtend(uint64_t value, unsigned bitLength)
+{
+    const unsigned shift = 64u - bitLength;
+    return static_cast<int64_t>(value << shift) >> shift;
+}
+
+/** \brief Single bit, offset counted from the LSB of the record. */
+inline bool extractBit(const uint8_t *end, unsigned bitOffset)
+{
+    return (end[-static_cast<std::ptrdiff_t>(bitOffset >> 3u) - 1] >> (bitOffset & 7u)) & 1u;
+}
+
+/**
+ * \brief Replaces a field of up to 64 bits, the other bits of the touched
+ * bytes are kept. Writes only the bytes of the field, no padding needed.
+ *
+ * \param end pointer behind the last byte of the record
+ * \param bitOffset offset of the field from the LSB of the record (as in the IODD)
+ * \param bitLength 1..64, the field has to be inside the record
+ * \param value the lowest bitLength bits are written
+ */
+inline void insertFromRight(uint8_t *end, unsigned bitOffset, unsigned bitLength, uint64_t value)
+{
+    uint8_t *byte = end - static_cast<std::ptrdiff_t>(bitOffset >> 3u) - 1;
+    unsigned shift = bitOffset & 7u;
+    value = lowBits(value, bitLength);
+    while (bitLength != 0u)
+    {
+        const unsigned bits = (8u - shift < bitLength) ? (8u - shift) : bitLength;
+        const unsigned mask = ((1u << bits) - 1u) << shift;
+        *byte = static_cast<uint8_t>((*byte & ~mask) | ((static_cast<unsigned>(value) << shift) & mask));
+        value >>= bits;
+        bitLength -= bits;
+        shift = 0u;
+        byte--;
+    }
+}
+
+/** \brief Sets or clears a single bit, offset counted from the LSB of the record. */
+inline void insertBit(uint8_t *end, unsigned bitOffset, bool bit)
+{
+    uint8_t &byte = end[-static_cast<std::ptrdiff_t>(bitOffset >> 3u) - 1];
+    const unsigned mask = 1u << (bitOffset & 7u);
+    byte = static_cast<uint8_t>(bit ? (byte | mask) : (byte & ~mask));
+}
+
+/**
+ * \brief Copy of a record behind PADDING zero bytes, for records that don't
+ * come with readable memory in front of them.
+ */
+class PaddedRecord
+{
+public:
+    PaddedRecord(const uint8_t *data, std::size_t length)
+    {
+        uint8_t *buffer = inline_;
+        if (length > MAX_INLINE)
+        {
+            heap_.resize(PADDING + length);
+            buffer = heap_.data();
+        }
+        std::memset(buffer, 0, PADDING);
+        if (length != 0u)
+        {
+            std::memcpy(buffer + PADDING, data, length);
+        }
+        end_ = buffer + PADDING + length;
+    }
+
+    PaddedRecord(PaddedRecord const&) = delete;
+    PaddedRecord& operator=(PaddedRecord const&) = delete;
+
+    const uint8_t *end() const { return end_; }
+
+private:
+    static constexpr std::size_t MAX_INLINE = 64u;
+    uint8_t inline_[PADDING + MAX_INLINE];
+    std::vector<uint8_t> heap_;
+    const uint8_t *end_;
+};
+
+} // namespace bitextract
@@ -0,0 +1,79 @@
+/*!
+ * @file CycleScheduler.h
+ * @brief Drift-free PD cycle on absolute CLOCK_MONOTONIC deadlines with an
+ *        overrun policy, cycle time and per-port start time statistics.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef CYCLESCHEDULER_H_INCLUDED
+#define CYCLESCHEDULER_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "LatencyHistogram.h"
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+enum class OverrunPolicy : uint8_t{
+    SKIP,    // continue with the next deadline that is still ahead, missed cycles are dropped
+    CATCH_UP // run the missed cycles back-to-back (at most MAX_CATCH_UP), keeps the cycle count
+};
+
+constexpr uint64_t MAX_CATCH_UP = 10; // cycles, the deadlines further behind are skipped
+
+//!*******************************************************************************
+//!  class :       CycleScheduler
+//!*******************************************************************************
+//!  \brief        Deadlines are multiples of the period from the first cycle
+//!                on, so the phase doesn't drift with the duration of the
+//!                cycles. Driven by the cycle thread, the statistics can be
+//!                read and reset by any other thread.
+//!
+//!*******************************************************************************
+class CycleScheduler {
+private:
+    uint64_t deadline_;  // ns CLOCK_MONOTONIC, start of the current cycle
+    uint64_t lastStart_; // ns CLOCK_MONOTONIC, 0 = no cycle yet
+    atomic<OverrunPolicy> policy_;
+    atomic<uint64_t> cycles_;
+    atomic<uint64_t> overruns_; // cycles that took longer than the period
+    atomic<uint64_t> skipped_;  // deadlines dropped by the overrun policy
+    LatencyHistogram cycleTime_;      // start to start
+    LatencyHistogram wakeupLatency_;  // deadline to start
+    vector<LatencyHistogram> portStart_; // deadline to the start of the port
+
+    static uint64_t now();
+    static void sleepUntil(uint64_t deadline);
+public:
+    CycleScheduler(size_t portCount = 0);
+    ~CycleScheduler();
+    void beginCycle();
+    void beginPort(size_t port);
+    void endCycle(uint32_t period_ms);
+    void setPolicy(OverrunPolicy policy);
+    OverrunPolicy getPolicy() const;
+    void reset();
+    nlohmann::json toJson() const;
+    static bool policyFromString(const string &name, OverrunPolicy &policy);
+    static const char *policyName(OverrunPolicy policy);
+};
+
+#endif //CYCLESCHEDULER_H_INCLUDED
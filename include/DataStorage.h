@@ -0,0 +1,57 @@
+/*!
+ * @file DataStorage.h
+ * @brief IO-Link Data Storage (DS) engine. Keeps the parameter set of every
+ *        port on disk and uploads/downloads it only when the parameter
+ *        checksum of the device differs.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef DATASTORAGE_H_INCLUDED
+#define DATASTORAGE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "IOLMasterPortMax14819.h"
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+struct DataStorageRecord{
+    uint16_t VendorID = 0;
+    uint32_t DeviceID = 0;
+    uint32_t checksum = 0;
+    vector<IsduRequest> parameters; // index, subindex and data of every stored parameter
+};
+
+class DataStorage {
+private:
+    string directory_;
+
+    uint8_t upload(IOLMasterPortMax14819 &port, DataStorageRecord &record);
+    uint8_t download(IOLMasterPortMax14819 &port, DataStorageRecord &record);
+    uint8_t readChecksum(IOLMasterPortMax14819 &port, uint32_t &checksum, uint8_t &stateProperty);
+    string recordPath(uint8_t port_nr);
+    bool loadRecord(uint8_t port_nr, DataStorageRecord &record);
+    bool saveRecord(uint8_t port_nr, const DataStorageRecord &record);
+public:
+    DataStorage();
+    DataStorage(const string &directory);
+    ~DataStorage();
+    uint8_t synchronize(IOLMasterPortMax14819 &port, uint8_t port_nr);
+};
+
+#endif //DATASTORAGE_H_INCLUDED
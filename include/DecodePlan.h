@@ -0,0 +1,66 @@
+#pragma once
+/*!
+ * @file DecodePlan.h
+ * @brief Process data layouts compiled into flat decode plans and the
+ *        registry holding them per Vendor/Device/Revision
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PDSample.h"
+#include "ProcessdataElements.h"
+
+IolType iolTypeFromString(const std::string &type);
+const char *iolTypeName(IolType type);
+uint16_t iolDefaultBitLength(IolType type);
+
+struct PlanElement
+{
+    uint16_t bitOffset; // from the right (LSB) of the process data, as in the IODD
+    uint16_t bitLength;
+    IolType type;
+    uint16_t keyIndex;  // index into DecodePlan::keys
+    double gradient;    // numeric types: gradient * value + offset
+    double offset;
+    bool scaled;        // gradient or offset differ from 1 and 0
+};
+
+// Specialized code generated from an IODD (tools/IoddCodegen.cpp), one value
+// per plan element. They return false if dataLength is too short for them.
+using DecodeFn = bool (*)(const uint8_t *data, std::size_t dataLength, IolValue *values);
+using EncodeFn = bool (*)(const IolValue *values, uint8_t *data, std::size_t dataLength);
+
+struct DecodePlan
+{
+    std::vector<PlanElement> elements; // in decoding order, no strings on the hot path
+    std::vector<std::string> keys;
+    uint32_t id = 0;                   // fingerprint of the layout, never 0
+    bool views = false;                // has StringT/OctetStringT elements
+    DecodeFn decode = nullptr;         // generated decoder, the elements are walked otherwise
+    EncodeFn encode = nullptr;
+};
+
+DecodePlan compileDecodePlan(const std::vector<ProcessDataElement> &elements);
+
+class DecodePlanRegistry
+{
+public:
+    static constexpr uint8_t ANY_REVISION = 0u; // IO-Link revision 0 doesn't exist
+
+    void add(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID, const std::vector<ProcessDataElement> &elements, DecodeFn decode = nullptr, EncodeFn encode = nullptr);
+    std::shared_ptr<const DecodePlan> find(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const;
+
+private:
+    static uint64_t key(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID);
+
+    std::unordered_map<uint64_t, std::shared_ptr<const DecodePlan>> plans_;
+    mutable std::shared_mutex plansMutex_;
+};
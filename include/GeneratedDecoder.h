@@ -0,0 +1,131 @@
+#pragma once
+/*!
+ * @file GeneratedDecoder.h
+ * @brief Types used by the decoders that tools/IoddCodegen.cpp generates
+ *        from IODD files at build time
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "BitExtract.h"
+#include "DecodePlan.h"
+#include "IoddLoader.h"
+
+struct GeneratedElement
+{
+    const char *key;
+    IolType type;
+    uint16_t bitOffset;
+    uint16_t bitLength;
+    uint16_t subindex;
+    double gradient;
+    double offset;
+};
+
+struct GeneratedLayout
+{
+    uint16_t vendorId;
+    uint32_t deviceId;
+    PDDirection direction;
+    const GeneratedElement *elements;
+    std::size_t elementCount;
+    DecodeFn decode;
+    EncodeFn encode; // nullptr for PD in
+};
+
+namespace iodd_generated
+{
+
+inline IolValue makeBoolean(bool boolean)
+{
+    IolValue value;
+    value.type = IolType::BooleanT;
+    value.boolean = boolean;
+    return value;
+}
+
+inline IolValue makeUInteger(uint64_t uinteger)
+{
+    IolValue value;
+    value.type = IolType::UIntegerT;
+    value.uinteger = uinteger;
+    return value;
+}
+
+inline IolValue makeFloat32(uint32_t bits)
+{
+    IolValue value;
+    value.type = IolType::Float32T;
+    std::memcpy(&value.float32, &bits, sizeof(value.float32));
+    return value;
+}
+
+inline IolValue makeInteger(uint64_t bits, unsigned bitLength)
+{
+    IolValue value;
+    value.type = IolType::IntegerT;
+    value.integer = bitextract::signExtend(bits, bitLength);
+    return value;
+}
+
+inline IolValue makeTime(uint64_t bits)
+{
+    IolValue value;
+    value.type = IolType::TimeT;
+    value.integer = iolTimeToNs(bits);
+    return value;
+}
+
+inline IolValue makeTimeSpan(uint64_t bits)
+{
+    IolValue value;
+    value.type = IolType::TimeSpanT;
+    value.integer = iolTimeSpanToNs(bits);
+    return value;
+}
+
+inline IolValue makeOctetString(const uint8_t *data, uint16_t length)
+{
+    IolValue value;
+    value.type = IolType::OctetStringT;
+    value.bytes.data = data;
+    value.bytes.length = length;
+    return value;
+}
+
+// fixed length, shorter strings are terminated by 0x00
+inline IolValue makeString(const uint8_t *data, uint16_t length)
+{
+    IolValue value = makeOctetString(data, length);
+    const void *terminator = std::memchr(data, 0, length);
+    if (terminator != nullptr)
+    {
+        value.bytes.length = static_cast<uint16_t>(static_cast<const uint8_t *>(terminator) - data);
+    }
+    value.type = IolType::StringT;
+    return value;
+}
+
+/** \brief Writes a StringT/OctetStringT, shorter values are filled with 0x00. */
+inline void copyOctets(uint8_t *target, std::size_t length, const IolValue &value)
+{
+    const std::size_t copied = (value.bytes.length < length) ? value.bytes.length : length;
+    if (copied != 0u)
+    {
+        std::memcpy(target, value.bytes.data, copied);
+    }
+    std::memset(target + copied, 0, length - copied);
+}
+
+inline uint32_t float32Bits(float float32)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &float32, sizeof(bits));
+    return bits;
+}
+
+} // namespace iodd_generated
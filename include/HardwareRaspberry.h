@@ -41,6 +41,8 @@ public:
 	virtual void begin();	
 	virtual void IO_Write(PinNames pinnumber, uint8_t state);
 	virtual void IO_PinMode(PinNames pinnumber, PinMode mode); //pinMode
+	virtual uint8_t IO_Read(PinNames pinnumber);
+	virtual uint8_t IO_Interrupt(PinNames pinnumber, void (*function)(void)); //both edges
 	virtual void Serial_Write(char const * buf);
 	virtual void Serial_Write(int number);
 	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length);
@@ -0,0 +1,33 @@
+/*!
+ * @file IOLEvent.h
+ * @brief IO-Link event as read out of the event memory of a device.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef IOLEVENT_H_INCLUDED
+#define IOLEVENT_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <cstdint>
+
+//!***** Implementation *********************************************************
+
+struct IOLEvent{
+    uint8_t qualifier = 0;  // EventQualifier (IOL-Spec page 222, Table A.17), 0 for a legacy StatusCode type 1
+    uint16_t code = 0;      // EventCode
+    uint64_t timestamp = 0; // time of the readout in ns since epoch
+};
+
+#endif //IOLEVENT_H_INCLUDED
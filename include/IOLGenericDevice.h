@@ -39,23 +39,23 @@ public:
 	void readCycleTime();
 	void writeProcessData();
 	void readProcessData();
-	void writeCQ();
-	void readCQ();
-	void readDI();
+	uint8_t writeCQ(uint8_t level);
+	uint8_t readCQ(uint8_t &level);
+	uint8_t readDI(uint8_t &level);
 	void writeSpecISDU();
 	void readSpecISDU();
 	void readDeviceAccessLocks();
 	void readProfileCharacteristic();
 	void readPDInputDescriptor();
 	void readPDOutputDescriptor();
-	void readVendorName();
-	void readVendorText();
-	void readProductName();
-	void readProductID();
-	void readProductText();
-	void readSerialNumber();
-	void readHardwareRev();
-	void readFirmwareRev();
+	uint8_t readVendorName(vector<uint8_t>& oData);
+	uint8_t readVendorText(vector<uint8_t>& oData);
+	uint8_t readProductName(vector<uint8_t>& oData);
+	uint8_t readProductID(vector<uint8_t>& oData);
+	uint8_t readProductText(vector<uint8_t>& oData);
+	uint8_t readSerialNumber(vector<uint8_t>& oData);
+	uint8_t readHardwareRev(vector<uint8_t>& oData);
+	uint8_t readFirmwareRev(vector<uint8_t>& oData);
 	void writeMasterCycleTime();
 	void readMasterCycleTime();
 	void readMinCycleTime();
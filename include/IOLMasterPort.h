@@ -22,6 +22,7 @@
 
 //!***** Header-Files ***********************************************************
 #include "Max14819.h"
+#include "IOLEvent.h"
 #include <cstdint>
 
 //!***** Implementation *********************************************************
@@ -46,13 +47,15 @@ public:
     virtual void readPage() = 0;
     virtual void writePage() = 0;
     virtual uint8_t readISDU(vector<uint8_t> &data, uint16_t index, uint8_t subIndex) = 0;
+    virtual uint8_t readISDUCached(vector<uint8_t> &data, uint16_t index, uint8_t subIndex) = 0;
     virtual uint8_t writeISDU(uint8_t sizeData, vector<uint8_t>& oData, uint16_t index, uint8_t subIndex) = 0;
 	virtual uint8_t readDirectParameterPage(uint8_t address, uint8_t *pData) = 0;
     virtual uint8_t writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer) = 0;
-    virtual void readDI() = 0;
-    virtual void readCQ() = 0;
-    virtual void writeCQ() = 0;
+    virtual uint8_t readDI(uint8_t &level) = 0;
+    virtual uint8_t readCQ(uint8_t &level) = 0;
+    virtual uint8_t writeCQ(uint8_t level) = 0;
     virtual void isDeviceConnected() = 0;
+    virtual bool popEvent(IOLEvent &event) = 0;
 };
 
 #endif //IOLMASTERPORT_H_INCLUDED
@@ -31,29 +31,100 @@
 #include "IOLink.h"
 #include "IoddManager.h"
 #include "IoddService.h"
+#include "ParameterCache.h"
+#include "IOLEvent.h"
+#include "SpscRing.h"
+#include "SioChannel.h"
+#include "SeqLock.h"
+#include "PDSample.h"
+#include "PDHistory.h"
+#include "Span.h"
+#include "LatencyHistogram.h"
 using namespace std; //toDo replace
 using json = nlohmann::json;
 
 //!***** Implementation *********************************************************
 
+struct IsduRequest{
+    uint16_t index;
+    uint8_t subIndex;
+    bool write;           // false: read request, true: write request
+    vector<uint8_t> data; // data to write resp. data read
+    uint8_t status;       // SUCCESS or ERROR after execution
+    uint16_t errorCode;   // ErrorCode/AdditionalCode of a negative ISDU response
+};
+
+struct LastKnownDevice{
+    bool valid = false;
+    uint32_t comSpeed = 0;
+    uint8_t mSequenceType = 0;
+    uint8_t ProcessDataIn = 0;  // PD lengths in byte as used for the communication
+    uint8_t ProcessDataOut = 0;
+    uint8_t OnRequestData = 0;
+    uint16_t VendorID = 0;
+    uint32_t DeviceID = 0;
+    uint8_t RevisionID = 0;
+    uint8_t identPage[8] = {0}; // direct parameter page 1, RevisionID - DeviceID
+};
+
+enum class EventState : uint8_t{
+    IDLE,
+    READ_STATUS, // read the StatusCode
+    READ_SLOT,   // read the occupied event slots byte by byte
+    CONFIRM      // write the StatusCode to release the event memory
+};
+
+struct EventReadout{
+    EventState state = EventState::IDLE;
+    uint8_t slots = 0;   // occupied slots of the StatusCode
+    uint8_t slot = 0;    // slot being read
+    uint8_t byte = 0;    // byte of the slot being read
+    uint8_t entry[IOL::EVENT::SLOT_SIZE] = {0};
+    bool cksSeen = false; // driver delivers the CKS byte, the event flag can be used instead of polling
+    uint16_t pollCounter = 0;
+};
+
+constexpr size_t EVENT_QUEUE_SIZE = 32; // per port, power of two
+
+struct PDOutAck{
+    uint64_t sequence = 0;         // last PD out sequence that reached the wire, 0 = none
+    uint64_t requestTimestamp = 0; // ns since epoch, when it was written
+    uint64_t wireTimestamp = 0;    // ns since epoch, when it was sent first
+};
+
 class PDclass{
 private:
-    vector<uint8_t> procData;
-    vector<uint8_t> procDataOut;
+    SeqLock<PDSample> procData;    // written by the cycle thread
+    SeqLock<PDSample> procDataOut; // written by the REST threads, read by the cycle thread
+    PDHistory history;             // last received frames of procData
+    SeqLock<PDOutAck> procDataOutAck; // written by the cycle thread
+    LatencyHistogram outLatency;      // request to wire latency of procDataOut
     uint16_t VendorID;
     uint32_t DeviceID;
     uint8_t iolRev;
     std::tuple<bool, uint16_t, uint16_t> condition;
 public:
-    PDclass();
+    PDclass(size_t historyDepth = PD_HISTORY_DEPTH);
     ~PDclass();
     void write_pd_storage(vector<uint8_t>PData);
-    void write_procDataOut(vector<uint8_t>PDout);
+    void write_pd_storage(PDView pData, bool valid);
+    uint64_t write_procDataOut(const vector<uint8_t>& PDout);
+    uint64_t write_procDataOut(const DecodePlan& plan, const IolValue* values);
+    void confirm_procDataOut(const PDSample& sent, uint64_t wireTimestamp);
+    PDOutAck read_procDataOutAck() const;
+    LatencyHistogram& get_outLatency();
+    PDSample read_pd() const;
+    PDSample read_procDataOut() const;
+    const PDHistory &get_history() const;
     vector<float>get_float(uint8_t length);
     vector<uint8_t>get_uint8_t(uint8_t length);
     vector<uint8_t>get_procDataOut();
    // nlohmann::json interpretProcessData(IoddManager& instance);
     nlohmann::json interpretProcessData(IoddService& service);
+    nlohmann::json interpretProcessData(IoddService& service, const PDSample& sample);
+    nlohmann::json interpretHistory(IoddService& service, const vector<PDSample>& samples);
+    shared_ptr<const DecodePlan> findPlan(IoddService& service) const;
+    shared_ptr<const DecodePlan> findOutPlan(IoddService& service) const;
     void set_iodd(uint16_t VendorID_, uint32_t DeviceID_, uint8_t RevisionID_);
 };
 
@@ -63,7 +134,7 @@ private:
     max14819::PortSelect port_;
     uint16_t portType_;
     uint16_t diModeSupport_;
-    uint16_t portMode_;
+    SeqLock<uint16_t> portMode_; // IOL::PORT_MODE, read by the PD, decode and SIO threads
     uint16_t portStatus_;
     uint16_t actualCycleTime_;
     uint32_t comSpeed_;
@@ -77,13 +148,38 @@ private:
     uint8_t ProcessDataOutByte_;
     uint8_t OnRequestData_ = 0;
     PDclass pdclass;
+    ParameterCache paramCache_;
+    uint16_t isduErrorCode_ = 0;
+    uint8_t directParameterPage_[16] = {0};
+    LastKnownDevice lastDevice_;
+    bool fullStartupPending_ = false; // reconnect() found no or another device, begin() has to run
+    EventReadout eventReadout_;
+    SpscRing<IOLEvent, EVENT_QUEUE_SIZE> eventQueue_;
+    uint32_t eventsDropped_ = 0;
+    uint16_t eventPollCycles_ = 10;
+    SioChannel sioCQ_;
+    SioChannel sioDI_;
     bool deviceConnection=0;
 
+    uint8_t buildISDUFrame(uint8_t *pFrame, uint8_t sizeFrame, bool write, uint16_t index, uint8_t subIndex, const uint8_t *pData, uint8_t sizeData);
+    uint8_t sendISDU(const uint8_t *pFrame, uint8_t sizeFrame);
+    uint8_t receiveISDU(uint8_t *pBuffer, uint8_t sizeBuffer, uint8_t &sizeData, uint8_t &iService);
+    PDSample pdOutCycle_; // PD out latched for the current cycle
+    void loadProcessDataOut(uint8_t *pData);
+    void confirmProcessDataOut();
+    uint8_t startOperate(bool fastReconnect);
+    uint8_t nextEventMC();
+    void handleEventReply(uint8_t mc, const uint8_t *pOD, int16_t cks);
+    void pushEvent(IOLEvent &event);
+
 public:
     IOLMasterPortMax14819();
     IOLMasterPortMax14819(max14819::Max14819* pDriver, max14819::PortSelect port);
     ~IOLMasterPortMax14819();
     uint8_t begin();
+    uint8_t reconnect();
+    bool hasLastKnownDevice();
+    bool needsFullStartup();
     uint8_t end();
 	void portHandler();
 	void readStatus();
@@ -92,18 +188,35 @@ public:
 	void readPage();
 	void writePage();
 	uint8_t readISDU(vector<uint8_t>& oData, uint16_t index, uint8_t subIndex);
+	uint8_t readISDU(uint8_t *pBuffer, uint8_t sizeBuffer, uint8_t &sizeData, uint16_t index, uint8_t subIndex);
+	uint8_t readISDUCached(vector<uint8_t>& oData, uint16_t index, uint8_t subIndex);
+	bool lookupCachedISDU(vector<uint8_t>& oData, uint16_t index, uint8_t subIndex);
+	uint8_t processISDUBatch(vector<IsduRequest>& requests);
 	uint8_t writeISDU(uint8_t sizeData, vector<uint8_t>& oData, uint16_t index, uint8_t subIndex);
+	uint8_t writeISDU(const uint8_t *pData, uint8_t sizeData, uint16_t index, uint8_t subIndex);
+	uint16_t getIsduErrorCode();
 	uint8_t readDirectParameterPage(uint8_t address, uint8_t *pData);
-	uint8_t readPD(vector<uint8_t>& pData);
+	uint8_t readDirectParameterPage(uint8_t address, uint8_t count, uint8_t *pData);
+	const uint8_t *getDirectParameterPage();
+	uint8_t readPD();
 	uint8_t writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer);
-	void readDI();
-	void readCQ();
-	void writeCQ();
+	uint8_t writeProcessDataOut();
+	uint8_t readDI(uint8_t &level);
+	uint8_t readCQ(uint8_t &level);
+	uint8_t writeCQ(uint8_t level);
+	uint8_t setPortMode(uint16_t mode);
+	uint16_t getPortMode();
+	SioChannel* get_SioCQ();
+	SioChannel* get_SioDI();
 	void isDeviceConnected();
+	bool popEvent(IOLEvent &event);
+	uint32_t getEventsDropped();
+	void setEventPollCycles(uint16_t cycles);
     tuple<uint16_t, uint32_t> getDeviceId();
     tuple<uint8_t, uint8_t, uint8_t> getLengthParameter();
     uint8_t readErrorRegister();
     PDclass* get_PDclass();
+    ParameterCache* get_ParameterCache();
     vector<uint8_t> get_lastIsduRequest();
     bool get_DeviceConnection();
 };
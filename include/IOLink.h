@@ -30,6 +30,13 @@ namespace IOL{
     constexpr uint8_t M_TYPE_2_X         = 2u;
 
     constexpr uint8_t PD_VALID_BIT       = 0x40u;
+    // Port modes of the master
+    namespace PORT_MODE{
+        constexpr uint16_t IOLINK        = 0u; // IO-Link communication
+        constexpr uint16_t SIO_INPUT     = 1u; // CQ is a switching input (DI_C/Q)
+        constexpr uint16_t SIO_OUTPUT    = 2u; // CQ is a switching output (DO_C/Q)
+        constexpr uint16_t INACTIVE      = 3u; // port deactivated
+    }
     namespace MC{
         constexpr uint8_t IDLE           = 0xF1u; //MC for idle, device is waiting
         constexpr uint8_t PD_READ        = 0x80u;
@@ -39,6 +46,9 @@ namespace IOL{
         constexpr uint8_t OD_WRITE       = 0x70u;
         constexpr uint8_t OD_READ        = 0xF0u;
         constexpr uint8_t OD_FLOWCTRL    = 0x60u; //Beginn of FlowCtrl (there is no 0x60, start is 0x61)
+        constexpr uint8_t OD_READ_FLOWCTRL = 0xE0u; //FlowCtrl for reading ISDU segments, counter 0 - 15 wraps
+        constexpr uint8_t DIAG_READ      = 0xC0u; //Read diagnosis channel (event memory), address in the lower 5 bits
+        constexpr uint8_t DIAG_WRITE     = 0x40u; //Write diagnosis channel, used to confirm events
 
         constexpr uint8_t DEV_FALLBACK   = 0x5Au;
         constexpr uint8_t MAS_IDENT      = 0x95u;
@@ -72,6 +82,67 @@ namespace IOL{
         constexpr uint8_t READ_REQ_8BIT      = 0x9u;
         constexpr uint8_t READ_REQ_8BIT_SUB  = 0xAu;
         constexpr uint8_t READ_REQ_16BIT     = 0xBu;
+        constexpr uint8_t WRITE_RESP_NEG     = 0x4u;
+        constexpr uint8_t WRITE_RESP_POS     = 0x5u;
+        constexpr uint8_t READ_RESP_NEG      = 0xCu;
+        constexpr uint8_t READ_RESP_POS      = 0xDu;
+        constexpr uint8_t NO_SERVICE         = 0x00u; // device has no ISDU response yet
+        constexpr uint8_t BUSY               = 0x01u; // device is processing the request
+        constexpr uint8_t EXT_LENGTH         = 0x1u;  // length nibble 1: extended length byte follows
+        constexpr uint8_t MAX_SHORT_LENGTH   = 15u;   // maximum ISDU length without extended length
+        constexpr uint8_t MAX_LENGTH         = 238u;  // maximum ISDU length (IOL-Spec page 250)
+    }
+    namespace EVENT{
+        // Event memory (IOL-Spec page 221, Table A.16)
+        constexpr uint8_t CKS_EVENT_FLAG     = 0x80u; // event flag in the CKS byte of a device message
+        constexpr uint8_t STATUS_CODE        = 0x00u; // address of the StatusCode
+        constexpr uint8_t STATUS_DETAILS     = 0x80u; // StatusCode type 2, event details in the slots
+        constexpr uint8_t STATUS_SLOTS       = 0x3Fu; // event occurred flags of slot 1 - 6
+        constexpr uint8_t STATUS_CODE_TYPE1  = 0x1Fu; // EventCode of a StatusCode type 1
+        constexpr uint8_t SLOT_COUNT         = 6u;
+        constexpr uint8_t SLOT_SIZE          = 3u;    // EventQualifier, EventCode MSB, EventCode LSB
+        // EventQualifier
+        constexpr uint8_t MODE_MASK          = 0xC0u;
+        constexpr uint8_t MODE_SINGLE_SHOT   = 0x40u;
+        constexpr uint8_t MODE_DISAPPEARS    = 0x80u;
+        constexpr uint8_t MODE_APPEARS       = 0xC0u;
+        constexpr uint8_t TYPE_MASK          = 0x30u;
+        constexpr uint8_t TYPE_NOTIFICATION  = 0x10u;
+        constexpr uint8_t TYPE_WARNING       = 0x20u;
+        constexpr uint8_t TYPE_ERROR         = 0x30u;
+        constexpr uint8_t SOURCE_MASTER      = 0x08u;
+        constexpr uint8_t INSTANCE_MASK      = 0x07u;
+    }
+    namespace INDEX{
+        constexpr uint16_t SYSTEM_COMMAND    = 0x0002u;
+        constexpr uint16_t DATA_STORAGE      = 0x0003u;
+        // Identification parameters (IOL-Spec page 262, Table B.8)
+        constexpr uint16_t VENDOR_NAME       = 0x0010u;
+        constexpr uint16_t VENDOR_TEXT       = 0x0011u;
+        constexpr uint16_t PRODUCT_NAME      = 0x0012u;
+        constexpr uint16_t PRODUCT_ID        = 0x0013u;
+        constexpr uint16_t PRODUCT_TEXT      = 0x0014u;
+        constexpr uint16_t SERIAL_NUMBER     = 0x0015u;
+        constexpr uint16_t HARDWARE_REV      = 0x0016u;
+        constexpr uint16_t FIRMWARE_REV      = 0x0017u;
+        constexpr uint16_t APPLICATION_TAG   = 0x0018u;
+    }
+    namespace DS{
+        // Subindices of the Data Storage Index (IOL-Spec page 264, Table B.10)
+        constexpr uint8_t SUB_COMMAND        = 0x01u;
+        constexpr uint8_t SUB_STATE_PROPERTY = 0x02u;
+        constexpr uint8_t SUB_SIZE           = 0x03u;
+        constexpr uint8_t SUB_CHECKSUM       = 0x04u;
+        constexpr uint8_t SUB_INDEX_LIST     = 0x05u;
+        // DS_Command values
+        constexpr uint8_t UPLOAD_START       = 0x01u;
+        constexpr uint8_t UPLOAD_END         = 0x02u;
+        constexpr uint8_t DOWNLOAD_START     = 0x03u;
+        constexpr uint8_t DOWNLOAD_END       = 0x04u;
+        constexpr uint8_t BREAK              = 0x05u;
+        // State Property
+        constexpr uint8_t UPLOAD_FLAG        = 0x80u; // device requests an upload
+        constexpr uint8_t REVISION           = 0x11u; // first IO-Link revision with Data Storage
     }
 }
 
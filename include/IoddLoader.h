@@ -0,0 +1,94 @@
+#pragma once
+/*!
+ * @file IoddLoader.h
+ * @brief Reads the process data layouts out of IODD files and keeps them in a
+ *        memory-mapped binary cache
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "ProcessdataElements.h"
+
+enum class PDDirection : uint8_t
+{
+    In = 0,
+    Out = 1,
+};
+
+/** \brief Process data layout of one device and direction as read from its IODD. */
+struct IoddLayout
+{
+    uint16_t vendorId = 0;
+    uint32_t deviceId = 0;
+    PDDirection direction = PDDirection::In;
+    std::string conditionVariable; // empty if the layout doesn't depend on a variable
+    int64_t conditionValue = 0;
+    bool isDefault = true;         // layout used with the default value of the variable
+    std::vector<ProcessDataElement> elements;
+};
+
+/** \brief Variable of an IODD with accessRights="ro", its value can be cached. */
+struct IoddReadOnly
+{
+    uint16_t vendorId = 0;
+    uint16_t index = 0;
+    uint32_t deviceId = 0;
+};
+
+bool parseIodd(const std::string &xml, std::vector<IoddLayout> &layouts, std::vector<IoddReadOnly> &readOnly);
+
+/**
+ * \brief Process data layouts of all IODD files of a directory.
+ *
+ * The XML files are only parsed if the directory changed since the cache file
+ * was written. Otherwise the cache is mapped read-only, so startup doesn't
+ * depend on the number of installed IODDs and the pages are shared. Layouts
+ * are copied out of the mapping on demand by find().
+ */
+class IoddLoader
+{
+public:
+    static constexpr int64_t DEFAULT_CONDITION = std::numeric_limits<int64_t>::min();
+
+    IoddLoader() = default;
+    ~IoddLoader();
+
+    IoddLoader(IoddLoader const&) = delete;
+    IoddLoader& operator=(IoddLoader const&) = delete;
+
+    bool load(const std::string &directory, const std::string &cacheFile);
+    bool find(uint16_t VendorID, uint32_t DeviceID, PDDirection direction, std::vector<ProcessDataElement> &elements, int64_t conditionValue = DEFAULT_CONDITION) const;
+    bool findReadOnly(uint16_t VendorID, uint32_t DeviceID, std::vector<uint16_t> &indices) const;
+    std::size_t layoutCount() const { return entryCount_; }
+
+private:
+    struct CacheHeader;
+    struct CacheEntry;
+    struct CacheElement;
+    struct CacheReadOnly;
+
+    static std::vector<uint8_t> buildCache(uint64_t fingerprint, std::vector<IoddLayout> layouts, std::vector<IoddReadOnly> readOnly);
+    bool map(const std::string &cacheFile, uint64_t fingerprint);
+    bool attach(const uint8_t *image, std::size_t size, uint64_t fingerprint);
+    void unmap();
+
+    const uint8_t *image_ = nullptr;
+    std::size_t imageSize_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> ownedImage_; // used if the cache file can't be written
+
+    const CacheEntry *entries_ = nullptr; // sorted by vendor, device, direction, default first
+    uint32_t entryCount_ = 0;
+    const CacheElement *elements_ = nullptr;
+    uint32_t elementCount_ = 0;
+    const CacheReadOnly *readOnly_ = nullptr; // sorted by vendor, device, index
+    uint32_t readOnlyCount_ = 0;
+    const char *strings_ = nullptr;
+    uint32_t stringsSize_ = 0;
+};
@@ -9,17 +9,18 @@
  */
 #include <memory>
 #include <vector>
-#include<list>
 #include <nlohmann/json.hpp>
 #include "ProcessdataElements.h"
-#include <variant>
+#include "Span.h"
+#include "PDSample.h"
+#include "DecodePlan.h"
+#include "IoddLoader.h"
 #include <chrono>
-using IolDataReturn_t = std::variant<bool, uint64_t, int64_t, float, std::string, std::list<char>, long double, std::chrono::system_clock::time_point>;
 class IoddService
 {
  
 public:
-    IoddService() = default;
+    IoddService();
     ~IoddService() = default;
 
     IoddService(IoddService const&) = default;
@@ -28,17 +29,50 @@ public:
     IoddService(IoddService&&) noexcept = default;
     IoddService& operator=(IoddService&&) noexcept = default;
 
-    std::tuple<nlohmann::json, nlohmann::json> interpretProcessData(std::vector<uint8_t> rawProcessData, uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID);
+    std::tuple<nlohmann::json, nlohmann::json> interpretProcessData(PDView rawProcessData, uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID);
+    void registerPlan(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID, const std::vector<ProcessDataElement>& elements);
+    std::shared_ptr<const DecodePlan> findPlan(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const;
+    std::shared_ptr<const DecodePlan> findOutPlan(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const;
+    bool loadIodds(const std::string& directory, const std::string& cacheFile);
+    bool findReadOnly(uint16_t VendorID, uint32_t DeviceID, std::vector<uint16_t>& indices) const;
+    static std::vector<IoddLayout> builtinLayouts();
+    static void decode(const DecodePlan& plan, const uint8_t* data, std::size_t dataLength, IolValue* values);
+    static void decodeBatch(const DecodePlan& plan, Span<const PDSample> samples, IolValue* values);
+    static bool encode(const DecodePlan& plan, const IolValue* values, uint8_t* data, std::size_t dataLength);
+    static nlohmann::json toJson(const DecodePlan& plan, const IolValue* values);
 
 private:
 
-    std::tuple<nlohmann::json, nlohmann::json> interpretProcessData(const std::vector <ProcessDataElement> iodd,const uint8_t* data, std::size_t dataLength, uint16_t conditionVariable);
-    IolDataReturn_t getProcessDataVar(const ProcessDataElement& dataItem, const uint8_t* data, std::size_t dataLength);
-    uint8_t getByteFromRight(const uint8_t* const pData, const std::size_t bitShiftRight);
- 
-    uint64_t getUInt64(const uint8_t* const pData, const uint16_t bitLength, const uint16_t bitOffset);
-    void setBitLength(ProcessDataElement* element);
+    void registerBuiltinPlans();
+    std::shared_ptr<const DecodePlan> findPlan(DecodePlanRegistry& registry, PDDirection direction, uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const;
+    std::tuple<nlohmann::json, nlohmann::json> interpretProcessData(const DecodePlan& plan, const uint8_t* data, std::size_t dataLength);
+    using Extractor = IolValue (*)(const uint8_t* end, const PlanElement& element);
+    static const Extractor extractors_[static_cast<std::size_t>(IolType::Count)];
+    static IolValue extractInvalid(const uint8_t* end, const PlanElement& element);
+    static IolValue extractBoolean(const uint8_t* end, const PlanElement& element);
+    static IolValue extractUInteger(const uint8_t* end, const PlanElement& element);
+    static IolValue extractFloat32(const uint8_t* end, const PlanElement& element);
+    static IolValue extractInteger(const uint8_t* end, const PlanElement& element);
+    static IolValue extractString(const uint8_t* end, const PlanElement& element);
+    static IolValue extractOctetString(const uint8_t* end, const PlanElement& element);
+    static IolValue extractTime(const uint8_t* end, const PlanElement& element);
+    static IolValue extractTimeSpan(const uint8_t* end, const PlanElement& element);
+    using Inserter = void (*)(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static const Inserter inserters_[static_cast<std::size_t>(IolType::Count)];
+    static void insertInvalid(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertBoolean(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertUInteger(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertFloat32(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertInteger(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertOctets(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertTime(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static void insertTimeSpan(uint8_t* end, const PlanElement& element, const IolValue& value);
+    static IolValue getProcessDataVar(const PlanElement& element, const uint8_t* end, std::size_t dataLength);
+    static void decodeRecord(const DecodePlan& plan, const uint8_t* end, std::size_t dataLength, IolValue* values);
 
     std::unique_ptr<IoddService> mIoddService;
+    std::shared_ptr<DecodePlanRegistry> registry_;    // PD in layouts, compiled once
+    std::shared_ptr<DecodePlanRegistry> outRegistry_; // PD out layouts
+    std::shared_ptr<const IoddLoader> loader_;        // installed IODDs, compiled into the registries on first use
 };
 
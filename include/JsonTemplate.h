@@ -0,0 +1,51 @@
+#pragma once
+/*!
+ * @file JsonTemplate.h
+ * @brief JSON payload of a decode plan, serialized from a precomputed template
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DecodePlan.h"
+
+/**
+ * \brief Writes decoded process data in the format of
+ * IoddService::toJson(plan, values) plus a timestamp, dump()ed by nlohmann.
+ *
+ * The key set is fixed per plan, so the keys are escaped, sorted like the
+ * members of a nlohmann object and joined with their separators once. Per
+ * cycle only the values and the timestamp are written into the caller's
+ * buffer, which keeps its capacity between the cycles.
+ */
+class JsonTemplate
+{
+public:
+    explicit JsonTemplate(std::shared_ptr<const DecodePlan> plan, const std::string &timestampKey = "ts");
+
+    const DecodePlan *plan() const { return plan_.get(); }
+    void serialize(const IolValue *values, const std::string &timestamp, std::string &out) const;
+
+    static void appendNumber(double value, std::string &out);
+    static void appendInteger(int64_t value, std::string &out);
+    static void appendOctets(PDView octets, std::string &out);
+    static void appendString(std::string_view value, std::string &out);
+
+private:
+    static constexpr std::size_t TIMESTAMP = static_cast<std::size_t>(-1);
+
+    struct Field
+    {
+        std::string prefix;  // separator and escaped key, e.g. ,"Distance":
+        std::size_t element; // index into plan_->elements or TIMESTAMP
+    };
+
+    std::shared_ptr<const DecodePlan> plan_;
+    std::vector<Field> fields_;
+};
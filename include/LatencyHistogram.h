@@ -0,0 +1,55 @@
+/*!
+ * @file LatencyHistogram.h
+ * @brief Lock-free histogram of durations with logarithmic (power of two)
+ *        buckets, filled by one thread and read by any other.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef LATENCYHISTOGRAM_H_INCLUDED
+#define LATENCYHISTOGRAM_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+constexpr size_t LATENCY_BUCKETS = 32; // bucket 0: < 1 us, bucket i: [2^(i-1), 2^i) us
+
+class LatencyHistogram {
+private:
+    atomic<uint64_t> buckets_[LATENCY_BUCKETS];
+    atomic<uint64_t> count_;
+    atomic<uint64_t> sum_; // ns
+    atomic<uint64_t> min_; // ns
+    atomic<uint64_t> max_; // ns
+
+    void copyFrom(const LatencyHistogram &other);
+public:
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram &other);
+    LatencyHistogram &operator=(const LatencyHistogram &other);
+    ~LatencyHistogram();
+    void add(uint64_t duration_ns);
+    void reset();
+    uint64_t count() const;
+    uint64_t percentile(double percent) const;
+    nlohmann::json toJson() const;
+};
+
+#endif //LATENCYHISTOGRAM_H_INCLUDED
@@ -24,6 +24,7 @@
 //!**** Header-Files **********************************************************
 #include <stdint.h>
 #include <iostream>
+#include <mutex>
 #include <vector>
 #include "HardwareRaspberry.h"
 using namespace std; // toDo: Replace
@@ -281,6 +282,9 @@ namespace max14819 {
         uint8_t isLedCtrlPortAEn_;
         uint8_t isLedCtrlPortBEn_;
 		HardwareRaspberry* Hardware;
+		recursive_mutex* busMutex_; // locked per SPI transaction, shared with the users of the chip
+
+		void transfer(uint8_t channel, uint8_t *buf);
 
     public:
         uint8_t comSpeedRegA;
@@ -288,6 +292,7 @@ namespace max14819 {
         Max14819();
         Max14819(DriverSelect driver, HardwareRaspberry* Hardware);
         ~Max14819();
+        void setBusMutex(recursive_mutex *busMutex);
         uint8_t begin (PortSelect port);
         uint8_t end(PortSelect port);
         uint8_t reset(void);
@@ -296,8 +301,13 @@ namespace max14819 {
         uint8_t wakeUpRequest(PortSelect port, uint32_t * comSpeed_ret);
         uint8_t readRegister(uint8_t reg);
         uint8_t writeISDU(uint8_t mc, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port, vector<uint8_t>& isduDataFramee, uint8_t ProcessDataOut, vector<uint8_t> completeframe);
+        uint8_t writeISDU(uint8_t mc, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port, uint8_t *pData, uint8_t sizeData);
         uint8_t readISDU(vector<uint8_t>& oData, uint8_t sizeData, PortSelect port);
+        uint8_t readISDU(uint8_t *pData, uint8_t sizeData, PortSelect port);
+        uint8_t waitForAnswer(PortSelect port, uint8_t sizeAnswer, uint32_t timeout_ms);
         uint8_t readPD(vector<uint8_t>& pData, uint8_t sizeData, PortSelect port, uint8_t sizeOD);
+        uint8_t readPD(vector<uint8_t>& pData, uint8_t sizeData, PortSelect port, uint8_t sizeOD, uint8_t *pOD, int16_t &cks);
+        uint8_t readPD(uint8_t *pData, uint8_t &length, uint8_t sizeData, PortSelect port, uint8_t sizeOD, uint8_t *pOD, int16_t &cks);
         uint8_t writeRegister(uint8_t reg, uint8_t data);
         uint8_t writeData(uint8_t mc, uint8_t data, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port);
         uint8_t writeData(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port);
@@ -310,6 +320,7 @@ namespace max14819 {
         uint8_t writeDIConfig(PortSelect port, uint8_t currentType, uint8_t threshold, uint8_t filter);
         uint8_t readDIConfig(PortSelect port);
         uint8_t writeCQ(PortSelect port, uint8_t value);
+        uint8_t configureSIO(PortSelect port, uint8_t output);
         uint8_t readCQ(PortSelect port);
         uint8_t readDI(PortSelect port);
 		void Serial_Write(char const * buf);
@@ -0,0 +1,56 @@
+/*!
+ * @file PDHistory.h
+ * @brief Preallocated ring buffer of the last received PD frames of a port,
+ *        queried lock-free by time range or sequence number.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef PDHISTORY_H_INCLUDED
+#define PDHISTORY_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PDSample.h"
+#include "SeqLock.h"
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+constexpr size_t PD_HISTORY_DEPTH = 8192; // default depth, ~8 s at a 1 ms cycle
+
+class PDHistory {
+private:
+    vector<SeqLock<PDSample>> slots_;
+    atomic<uint64_t> newest_; // sequence number of the newest sample, 0 = empty
+
+    bool readSlot(uint64_t sequence, PDSample &sample) const;
+    uint64_t oldestSequence(uint64_t newest) const;
+    uint64_t findTime(uint64_t timestamp, uint64_t oldest, uint64_t newest) const;
+public:
+    PDHistory(size_t depth = PD_HISTORY_DEPTH);
+    PDHistory(const PDHistory &other);
+    PDHistory &operator=(const PDHistory &other);
+    ~PDHistory();
+    void push(const PDSample &sample);
+    size_t depth() const;
+    uint64_t newestSequence() const;
+    size_t querySequence(uint64_t fromSequence, size_t step, size_t maxCount, vector<PDSample> &samples) const;
+    size_t queryTime(uint64_t fromTimestamp, uint64_t toTimestamp, size_t step, size_t maxCount, vector<PDSample> &samples) const;
+};
+
+#endif //PDHISTORY_H_INCLUDED
@@ -0,0 +1,50 @@
+#pragma once
+/*!
+ * @file PDOutValues.h
+ * @brief PD out values named by field, parsed from JSON or a binary payload
+ *        and packed by IoddService::encode()
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "DecodePlan.h"
+#include "PayloadEncoder.h"
+
+/**
+ * \brief Raw values for the elements of a PD out plan, in the units the PD
+ * in is published with: scaled numbers are converted back, TimeT is ns since
+ * epoch, TimeSpanT ns, StringT text and OctetStringT bytes. Fields that aren't
+ * given stay Invalid, their bits of the PD out are kept.
+ *
+ * JSON is an object of keys and values, an OctetStringT an array of bytes.
+ * CBOR and MessagePack are a map from field id (index of the element, see
+ * payload::schema()) or key to the value, or the message the PD in is
+ * published with, [planId, timestamp, map]. A planId other than 0 has to
+ * match the plan.
+ *
+ * Lives on the stack of the caller, nothing is allocated unless an error is
+ * reported. Strings and bytes point into the parsed input, which has to
+ * outlive the values.
+ */
+class PDOutValues
+{
+public:
+    static constexpr std::size_t MAX_ELEMENTS = 8u * PD_MAX_LENGTH; // one bit each
+
+    bool fromJson(const DecodePlan &plan, const nlohmann::json &object, std::string &error);
+    bool fromBinary(PayloadEncoding encoding, const DecodePlan &plan, const uint8_t *data, std::size_t length, std::string &error);
+
+    const IolValue *values() const { return values_; }
+
+private:
+    bool reset(const DecodePlan &plan, std::string &error);
+
+    IolValue values_[MAX_ELEMENTS];
+    uint8_t octets_[PD_MAX_LENGTH]; // OctetStringT arrays of the JSON
+    std::size_t octetsUsed_ = 0;
+};
@@ -0,0 +1,44 @@
+/*!
+ * @file PDSample.h
+ * @brief Raw process data frame of a port with sequence number, timestamp and
+ *        validity, fixed size so it can be exchanged without allocation.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef PDSAMPLE_H_INCLUDED
+#define PDSAMPLE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <chrono>
+#include <cstdint>
+
+//!***** Implementation *********************************************************
+
+constexpr uint8_t PD_MAX_LENGTH = 32; // maximum process data length of IO-Link
+
+struct PDSample{
+    uint64_t sequence = 0;  // counts every written frame, 0 = nothing written yet
+    uint64_t timestamp = 0; // acquisition time in ns since epoch
+    uint8_t length = 0;     // number of valid bytes in data
+    uint8_t valid = 0;      // 1 if the frame was received without error
+    uint8_t data[PD_MAX_LENGTH] = {0};
+};
+
+inline uint64_t pdTimestamp()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+#endif //PDSAMPLE_H_INCLUDED
@@ -0,0 +1,61 @@
+/*!
+ * @file ParameterCache.h
+ * @brief Per-port cache for static ISDU parameters (identification data and
+ *        other read-only indices), bound to the identity of the connected device.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef PARAMETERCACHE_H_INCLUDED
+#define PARAMETERCACHE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <cstdint>
+#include <map>
+#include <set>
+#include <mutex>
+#include <vector>
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+class ParameterCache {
+private:
+    map<uint32_t, vector<uint8_t>> entries_; // key: (index << 8) | subIndex
+    set<uint32_t> readOnly_;
+    uint16_t VendorID_;
+    uint32_t DeviceID_;
+    vector<uint8_t> serialNumber_;
+    bool serialVerified_;
+    mutable mutex cacheMutex_;
+
+    static uint32_t key(uint16_t index, uint8_t subIndex);
+    void seedReadOnly();
+public:
+    ParameterCache();
+    ParameterCache(const ParameterCache& other);
+    ParameterCache& operator=(const ParameterCache& other);
+    ~ParameterCache();
+    void setDevice(uint16_t VendorID, uint32_t DeviceID);
+    bool verifySerialNumber(const vector<uint8_t>& serialNumber);
+    bool isSerialVerified() const;
+    void addReadOnly(uint16_t index, uint8_t subIndex);
+    bool isCacheable(uint16_t index, uint8_t subIndex) const;
+    bool lookup(uint16_t index, uint8_t subIndex, vector<uint8_t>& oData) const;
+    void store(uint16_t index, uint8_t subIndex, const vector<uint8_t>& oData);
+    void invalidate(uint16_t index, uint8_t subIndex);
+    void clear();
+};
+
+#endif //PARAMETERCACHE_H_INCLUDED
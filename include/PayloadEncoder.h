@@ -0,0 +1,57 @@
+#pragma once
+/*!
+ * @file PayloadEncoder.h
+ * @brief Compact binary process data payloads (CBOR, MessagePack) with
+ *        integer field ids and the schema describing them
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "DecodePlan.h"
+
+enum class PayloadEncoding : uint8_t
+{
+    Json = 0,
+    Cbor = 1,
+    MsgPack = 2,
+};
+
+/** \brief Payload settings of a port. */
+struct PayloadFormat
+{
+    PayloadEncoding encoding = PayloadEncoding::Json;
+    bool raw = false; // binary encodings only: PD bytes instead of the decoded values
+
+    bool operator==(const PayloadFormat &other) const { return (encoding == other.encoding) && (raw == other.raw); }
+    bool operator!=(const PayloadFormat &other) const { return !(*this == other); }
+};
+
+bool payloadEncodingFromString(const std::string &name, PayloadEncoding &encoding);
+const char *payloadEncodingName(PayloadEncoding encoding);
+
+/**
+ * Binary payloads are an array of three items:
+ *
+ *     [planId, timestamp, values]
+ *
+ * planId is DecodePlan::id (0 if the device is unknown), timestamp the
+ * acquisition time in ns since epoch. values is a map from field id (index
+ * of the element in the plan) to the scaled value, or a byte string with the
+ * raw PD. Unscaled integers and floats keep their type, scaled values are
+ * float64, strings are text, octet strings bytes, TimeT (ns since epoch) and
+ * TimeSpanT (ns) integers and invalid values null. The schema maps the ids to
+ * the keys.
+ */
+namespace payload
+{
+
+void encodeValues(PayloadEncoding encoding, const DecodePlan &plan, const IolValue *values, uint64_t timestamp, std::string &out);
+void encodeRaw(PayloadEncoding encoding, uint32_t planId, const uint8_t *data, std::size_t length, uint64_t timestamp, std::string &out);
+nlohmann::json schema(const PayloadFormat &format, const DecodePlan *plan);
+
+} // namespace payload
@@ -0,0 +1,116 @@
+/*!
+ * @file Pipeline.h
+ * @brief Items and counters of the process data pipeline: a cycle thread per
+ *        MAX14819 acquires the PD of its ports, a worker decodes and
+ *        serializes it, the publisher hands it to MQTT. The stages are joined
+ *        by SpscRings.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef PIPELINE_H_INCLUDED
+#define PIPELINE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "CycleScheduler.h"
+#include "PDSample.h"
+#include "PayloadEncoder.h"
+#include "SpscRing.h"
+
+//!***** Implementation *********************************************************
+
+constexpr size_t PIPELINE_CHIPS = 2;     // MAX14819 on the shield, one acquisition thread each
+constexpr size_t PORTS_PER_CHIP = 2;
+constexpr size_t PIPELINE_SAMPLES = 64;  // acquisition -> decode per chip, power of two
+constexpr size_t PIPELINE_MESSAGES = 64; // decode -> publish, power of two
+
+struct PipelineSample{
+    uint8_t port = 0;
+    bool sio = false; // SIO port, the levels are read by the decode stage
+    PDSample sample;  // raw PD of an IO-Link port
+};
+
+struct PipelineMessage{
+    uint8_t port = 0;
+    bool schema = false; // retained schema instead of PD
+    PayloadEncoding encoding = PayloadEncoding::Json;
+    std::string payload; // the slots keep their capacity, no allocation once warmed up
+};
+
+//!*******************************************************************************
+//!  class :       PipelineStage
+//!*******************************************************************************
+//!  \brief        Counters of a stage, written by its thread only and read by
+//!                the REST API. A stage never waits for the next one, an item
+//!                that doesn't fit into the full queue is dropped and counted.
+//!
+//!*******************************************************************************
+struct PipelineStage{
+    std::atomic<uint64_t> processed{0}; // items handed on (published by the last stage)
+    std::atomic<uint64_t> dropped{0};   // queue full (publish failed for the last stage)
+    std::atomic<size_t> maxQueued{0};   // highest fill level of the output queue
+
+    //! Producer side of the output queue
+    template <typename T, size_t Size>
+    bool forward(SpscRing<T, Size> &queue, const T &item)
+    {
+        if (!queue.push(item))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        processed.fetch_add(1, std::memory_order_relaxed);
+        size_t queued = queue.size();
+        if (queued > maxQueued.load(std::memory_order_relaxed))
+        {
+            maxQueued.store(queued, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void count(bool success)
+    {
+        (success ? processed : dropped).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        processed.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+        maxQueued.store(0, std::memory_order_relaxed);
+    }
+};
+
+//!*******************************************************************************
+//!  class :       AcquisitionChip
+//!*******************************************************************************
+//!  \brief        Acquisition context of one MAX14819: its ports, its queue to
+//!                the decode stage and its own cycle. Only the thread of the
+//!                chip touches the ports of it in the cycle, the chips run
+//!                concurrently.
+//!
+//!*******************************************************************************
+struct AcquisitionChip{
+    uint8_t firstPort = 0;
+    uint8_t portCount = 0; // 0: chip not fitted
+    SpscRing<PipelineSample, PIPELINE_SAMPLES> samples; // -> PD_decode
+    PipelineStage stage;
+    CycleScheduler scheduler{PORTS_PER_CHIP}; // port statistics by index within the chip
+};
+
+#endif //PIPELINE_H_INCLUDED
@@ -7,6 +7,107 @@
  * @author See AUTHORS file
  * @since 11.08.2022
  */
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Span.h"
+
+enum class IolType : uint8_t
+{
+    Invalid = 0,
+    BooleanT,
+    UIntegerT,
+    Float32T,
+    IntegerT,
+    StringT,
+    OctetStringT,
+    TimeT,
+    TimeSpanT,
+    Count // number of types, size of the extractor table
+};
+
+// View into the decoded process data, valid as long as that buffer
+struct IolBytes
+{
+    const uint8_t *data;
+    uint16_t length;
+};
+
+// Decoded value, trivially copyable. type is IolType::Invalid if the value
+// couldn't be extracted. StringT and OctetStringT point into the process
+// data they were decoded from, TimeT is in ns since 1970-01-01 UTC and
+// TimeSpanT in ns, both in integer.
+struct IolValue
+{
+    IolType type;
+    union
+    {
+        bool boolean;
+        uint64_t uinteger;
+        int64_t integer;
+        float float32;
+        IolBytes bytes;
+    };
+
+    IolValue()
+        : type(IolType::Invalid)
+        , bytes{nullptr, 0}
+    {
+    }
+
+    std::string_view string() const { return std::string_view(reinterpret_cast<const char *>(bytes.data), bytes.length); }
+    PDView octets() const { return PDView(bytes.data, bytes.length); }
+};
+
+// TimeT: seconds since 1900-01-01 (32 bit, values below 2^31 continue after
+// 2036-02-07) and the fraction of the second in 2^-32 s (32 bit).
+// TimeSpanT: signed 64 bit in 2^-32 s.
+constexpr int64_t IOL_TIME_UNIX_OFFSET = 2208988800; // seconds from 1900 to 1970
+
+inline int64_t iolTimeToNs(uint64_t raw)
+{
+    uint64_t seconds = raw >> 32u;
+    if (!(seconds & 0x80000000u))
+    {
+        seconds += 0x100000000ull;
+    }
+    const uint64_t fraction = ((raw & 0xFFFFFFFFu) * 1000000000ull) >> 32u;
+    return (static_cast<int64_t>(seconds) - IOL_TIME_UNIX_OFFSET) * 1000000000 + static_cast<int64_t>(fraction);
+}
+
+inline uint64_t nsToIolTime(int64_t ns)
+{
+    int64_t seconds = ns / 1000000000;
+    int64_t nanoseconds = ns % 1000000000;
+    if (nanoseconds < 0)
+    {
+        seconds--;
+        nanoseconds += 1000000000;
+    }
+    const uint64_t fraction = ((static_cast<uint64_t>(nanoseconds) << 32u) + 999999999u) / 1000000000u;
+    return (static_cast<uint64_t>(seconds + IOL_TIME_UNIX_OFFSET) << 32u) + fraction;
+}
+
+inline int64_t iolTimeSpanToNs(uint64_t raw)
+{
+    const int64_t seconds = static_cast<int64_t>(raw) >> 32; // arithmetic shift keeps the sign
+    const uint64_t fraction = ((raw & 0xFFFFFFFFu) * 1000000000ull) >> 32u;
+    return seconds * 1000000000 + static_cast<int64_t>(fraction);
+}
+
+inline uint64_t nsToIolTimeSpan(int64_t ns)
+{
+    int64_t seconds = ns / 1000000000;
+    int64_t nanoseconds = ns % 1000000000;
+    if (nanoseconds < 0)
+    {
+        seconds--;
+        nanoseconds += 1000000000;
+    }
+    const uint64_t fraction = ((static_cast<uint64_t>(nanoseconds) << 32u) + 999999999u) / 1000000000u;
+    return (static_cast<uint64_t>(seconds) << 32u) + fraction;
+}
+
 
 struct ProcessDataInfo_t
 {
@@ -27,9 +128,9 @@ class ProcessDataElement
 public:
 	std::string key;
     ProcessDataInfo_t processDataInfo;
-    std::string type;
-    uint16_t bitOffset;
-    uint16_t bitLength;
-	uint16_t    subindex;
+    IolType type = IolType::Invalid; // resolved from the IODD name when loaded
+    uint16_t bitOffset = 0;
+    uint16_t bitLength = 0; // 0: default length of the type
+	uint16_t    subindex = 0;
 
 };
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*!
+ * @file PublishFilter.h
+ * @brief Decides per port whether the process data of a cycle has to be
+ *        published: raw byte compare first, deadbands on the decoded values
+ *        second and a heartbeat as upper limit for the silence.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef PUBLISHFILTER_H_INCLUDED
+#define PUBLISHFILTER_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "DecodePlan.h"
+#include "PDSample.h"
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+constexpr uint32_t PUBLISH_HEARTBEAT_MS = 1000; // default maximum silence of a port
+
+struct Deadband{
+    double absolute = 0; // change has to be larger than this value
+    double percent = 0;  // or larger than this percentage of the last published value
+};
+
+class PublishFilter {
+private:
+    bool changeDriven_;               // false: publish every cycle
+    chrono::milliseconds heartbeat_;  // 0: no heartbeat
+    map<string, Deadband> deadbands_; // key: element name of the decoded PD
+    bool published_;
+    uint8_t lastLength_;
+    uint8_t lastValid_;
+    uint8_t lastRaw_[PD_MAX_LENGTH];
+    nlohmann::json lastValues_;
+    shared_ptr<const DecodePlan> lastPlan_;   // plan of lastDecoded_, nullptr if lastValues_ is used
+    vector<IolValue> lastDecoded_;
+    uint8_t publishedRaw_[PD_MAX_LENGTH];     // PD the strings in lastDecoded_ point into
+    vector<const Deadband *> planDeadbands_;  // per plan element, nullptr: no deadband
+    const DecodePlan *deadbandPlan_;          // plan planDeadbands_ was resolved for
+    chrono::steady_clock::time_point lastPublish_;
+    uint64_t suppressed_;
+    mutable mutex filterMutex_;
+
+    bool heartbeatDue(chrono::steady_clock::time_point now) const;
+    bool rawEqual(const PDSample &sample) const;
+    bool valueChanged(const string &key, const nlohmann::json &value, const nlohmann::json &last) const;
+    bool valueChanged(const PlanElement &element, const Deadband *deadband, const IolValue &value, const IolValue &last) const;
+    void rememberRaw(const PDSample &sample);
+public:
+    PublishFilter();
+    PublishFilter(const PublishFilter &other);
+    PublishFilter &operator=(const PublishFilter &other);
+    ~PublishFilter();
+    void setChangeDriven(bool changeDriven);
+    void setHeartbeat(uint32_t heartbeat_ms);
+    void setDeadband(const string &key, double absolute, double percent);
+    void clearDeadbands();
+    void reset();
+    bool needsDecode(const PDSample &sample, chrono::steady_clock::time_point now);
+    bool needsPublish(const PDSample &sample, const nlohmann::json &values, chrono::steady_clock::time_point now);
+    bool needsPublish(const PDSample &sample, const shared_ptr<const DecodePlan> &plan, const IolValue *values, chrono::steady_clock::time_point now);
+    nlohmann::json getConfig() const;
+};
+
+#endif //PUBLISHFILTER_H_INCLUDED
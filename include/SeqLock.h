@@ -0,0 +1,143 @@
+/*!
+ * @file SeqLock.h
+ * @brief Sequence lock for small trivially copyable values. Readers never
+ *        block and never take a lock, they retry if a write was in progress.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef SEQLOCK_H_INCLUDED
+#define SEQLOCK_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//!***** Implementation *********************************************************
+
+//!*******************************************************************************
+//!  class :       SeqLock
+//!*******************************************************************************
+//!  \brief        The value is kept in atomic words, so a reader racing with a
+//!                writer is no data race, it just sees an odd or changed
+//!                version and reads again. Writers are serialized by the
+//!                version itself (odd = write in progress), so several threads
+//!                may write. Copying is only allowed while the value isn't used
+//!                by other threads.
+//!
+//!*******************************************************************************
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    std::atomic<uint64_t> version_;
+    std::atomic<uint64_t> words_[WORDS];
+
+    void load(T &value) const
+    {
+        uint64_t buffer[WORDS];
+        for (size_t i = 0; i < WORDS; i++)
+        {
+            buffer[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        memcpy(&value, buffer, sizeof(T));
+    }
+
+    void store(const T &value)
+    {
+        uint64_t buffer[WORDS] = {0};
+        memcpy(buffer, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++)
+        {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t lockWrite()
+    {
+        uint64_t version = version_.load(std::memory_order_relaxed);
+        while ((version & 1u) || !version_.compare_exchange_weak(version, version + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            version = version_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return version + 1;
+    }
+
+    void unlockWrite(uint64_t version)
+    {
+        version_.store(version + 1, std::memory_order_release);
+    }
+
+public:
+    SeqLock() : version_(0)
+    {
+        store(T());
+    }
+
+    SeqLock(const SeqLock &other) : version_(0)
+    {
+        store(other.read());
+    }
+
+    SeqLock &operator=(const SeqLock &other)
+    {
+        if (this != &other)
+        {
+            write(other.read());
+        }
+        return *this;
+    }
+
+    //! Lock-free read of a consistent value
+    T read() const
+    {
+        T value;
+        uint64_t before;
+        uint64_t after;
+        do
+        {
+            before = version_.load(std::memory_order_acquire);
+            load(value);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = version_.load(std::memory_order_relaxed);
+        } while ((before & 1u) || (before != after));
+        return value;
+    }
+
+    void write(const T &value)
+    {
+        uint64_t version = lockWrite();
+        store(value);
+        unlockWrite(version);
+    }
+
+    //! Read-modify-write under the write lock, e.g. to count a sequence number
+    template <typename F>
+    void update(F modify)
+    {
+        uint64_t version = lockWrite();
+        T value;
+        load(value);
+        modify(value);
+        store(value);
+        unlockWrite(version);
+    }
+};
+
+#endif //SEQLOCK_H_INCLUDED
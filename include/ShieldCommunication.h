@@ -32,12 +32,17 @@
 #include <mutex>
 #include <condition_variable>
 #include <any>
+#include <set>
 #include "HardwareRaspberry.h"
 #include "crow_all.h"
 #include "Max14819.h"
 #include "IOLMasterPort.h"
 #include "IOLMasterPortMax14819.h"
 #include "IOLGenericDevice.h"
+#include "DataStorage.h"
+#include "PublishFilter.h"
+#include "PayloadEncoder.h"
+#include "Pipeline.h"
 #include "IOLink.h"
 #include <string>
 //!**** Functions **********************************************************
@@ -48,35 +53,76 @@ private:
    // IoddManager instance;
     IoddService service;
     vector<IOLMasterPortMax14819> ports;
+    DataStorage dataStorage;
+    vector<PublishFilter> publishFilters; // one per port, decides what PD_decode publishes
+    vector<PayloadFormat> payloadFormats; // one per port, encoding of the published PD
+    mutex payloadFormatsMutex;
+    mutex pdOutWriteMutex; // serializes the REST writers of the PD out
+    AcquisitionChip chips[PIPELINE_CHIPS]; // PD_chip_ports -> PD_decode, one per MAX14819
+    atomic<bool> dataStoragePending[PIPELINE_CHIPS * PORTS_PER_CHIP]; // fast reconnect done, Port_startup synchronizes
+    atomic<bool> portClaimed[PIPELINE_CHIPS * PORTS_PER_CHIP]; // a startup runs on the port without the chip mutex
+    SpscRing<PipelineMessage, PIPELINE_MESSAGES> pipelineMessages; // PD_decode -> PD_publish
+    PipelineStage decodeStage;
+    PipelineStage publishStage;
     vector<int> port_nr;
     vector<uint8_t> pData;
     map<string, uint8_t> pData_ports;
     bool extended_board = false;
-    int cycleTime=100;
+    atomic<int> cycleTime{100}; // ms, written by the REST API
     int timeSinceEpochMillisec();
     void Communication_startup(bool extended_board);
     void Communication_shutdown();
     struct mosquitto *mosq;
     string brokerIP = "localhost";
     const char* mqtt_IP;
+    set<crow::websocket::connection*> eventClients;
+    mutex eventClientsMutex;
+    nlohmann::json eventToJson(uint8_t port_nr, const IOLEvent &event);
+    nlohmann::json sioToJson(IOLMasterPortMax14819 &port);
+    nlohmann::json pdSampleToJson(const PDSample &sample);
+    recursive_mutex &chipMutex(uint8_t port_nr);
+    bool claimPort(uint8_t port_nr);
+    void releasePort(uint8_t port_nr);
+    void registerReadOnly(IOLMasterPortMax14819 &nr);
 public:
-    mutex max1Mutex;
-    mutex max2Mutex;
+    recursive_mutex max1Mutex; // also locked by the driver per SPI transaction
+    recursive_mutex max2Mutex;
     void signalHandler(int signum);
     ShieldCommunication(bool extended_board);
     ~ShieldCommunication();
     void Read_port(uint8_t port_nr);
-    void PD_all_ports();
+    size_t chipCount() const;
+    void PD_chip_ports(uint8_t chip);
+    void Port_startup();
+    void PD_decode();
+    void PD_publish();
+    void PD_pipeline_status(bool reset, nlohmann::json &result);
+    uint8_t PD_cycle_status(const string &policy, bool reset, nlohmann::json &result);
+    void Event_dispatch();
+    void SIO_poll();
+    uint8_t setPortMode(uint8_t port_nr, uint16_t mode, uint32_t debounce_us);
+    uint8_t writeCQ(uint8_t port_nr, uint8_t level);
+    PublishFilter *get_PublishFilter(uint8_t port_nr);
+    uint8_t set_PayloadFormat(uint8_t port_nr, const PayloadFormat &format);
+    uint8_t get_PayloadFormat(uint8_t port_nr, PayloadFormat &format);
+    uint8_t PD_history(uint8_t port_nr, bool bySequence, uint64_t from, uint64_t to, size_t step, size_t maxCount, bool decode, nlohmann::json &result);
+    void addEventClient(crow::websocket::connection *client);
+    void removeEventClient(crow::websocket::connection *client);
     void send_all_PD();
     vector<uint8_t> get_PD_portx(string port);
     void ISDU_Write(uint8_t port_nr, uint16_t index, uint8_t subIndex, vector<uint8_t> pData);
     void ISDU_Read(uint8_t port_nr, uint16_t index, uint8_t subIndex, vector<uint8_t> &Data);
+    uint8_t ISDU_Batch(uint8_t port_nr, vector<IsduRequest> &requests);
     void Write_Port(uint8_t port_nr);
-    void Write_procDataOut(uint8_t port_nr, vector<uint8_t> pData);
+    uint64_t Write_procDataOut(uint8_t port_nr, vector<uint8_t> pData);
+    uint8_t Write_procDataOutValues(uint8_t port_nr, PayloadEncoding encoding, const string &body, uint64_t &sequence, string &error);
+    uint8_t waitProcDataOut(uint8_t port_nr, uint64_t sequence, uint32_t timeout_ms, PDOutAck &ack);
+    uint8_t PD_out_status(uint8_t port_nr, bool resetLatency, nlohmann::json &result);
     void writeCycleTime(int time_in_ms);
     void isDeviceConnected(vector<uint8_t>& portConnection);
     int getCycleTime();
     void writeIP(string newIP);
     std::string getCurrentTimeStamp();
+    std::string getTimeStamp(std::chrono::system_clock::time_point now);
 };
 int timeSinceEpochMillisec();
@@ -0,0 +1,67 @@
+/*!
+ * @file SioChannel.h
+ * @brief Sampling of a switching signal (CQ or DI line in SIO mode) with
+ *        timestamped edge capture, debounce and pulse counting.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef SIOCHANNEL_H_INCLUDED
+#define SIOCHANNEL_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstdint>
+#include "SpscRing.h"
+using namespace std; //toDo replace
+
+//!***** Implementation *********************************************************
+
+struct SioEdge{
+    uint64_t timestamp = 0; // ns since epoch
+    uint8_t level = 0;      // level after the edge
+};
+
+constexpr size_t SIO_EDGE_RING_SIZE = 1024; // per channel, power of two
+
+class SioChannel {
+private:
+    SpscRing<SioEdge, SIO_EDGE_RING_SIZE> edges_;
+    atomic<uint8_t> level_;          // debounced level
+    atomic<uint32_t> pulseCount_;    // rising edges since the last reset
+    atomic<uint32_t> overruns_;      // edges lost because the ring was full
+    atomic<uint64_t> debounce_;      // debounce time in ns
+    atomic<bool> enabled_;           // producer only samples while enabled
+    atomic<bool> primed_;            // first sample after enable sets the level without edge
+    uint64_t lastEdge_;              // timestamp of the last accepted edge, producer only
+public:
+    SioChannel();
+    SioChannel(const SioChannel& other);
+    SioChannel& operator=(const SioChannel& other);
+    ~SioChannel();
+    static uint64_t now();
+    void enable();
+    void disable();
+    bool isEnabled() const;
+    void sample(uint8_t level, uint64_t timestamp);
+    bool popEdge(SioEdge& edge);
+    uint8_t getLevel() const;
+    uint32_t getPulseCount() const;
+    void resetPulseCount();
+    uint32_t getOverruns() const;
+    void setDebounce(uint32_t debounce_us);
+    uint32_t getDebounce() const;
+};
+
+#endif //SIOCHANNEL_H_INCLUDED
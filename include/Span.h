@@ -0,0 +1,76 @@
+/*!
+ * @file Span.h
+ * @brief Non-owning view of a contiguous range (subset of C++20 std::span),
+ *        used to pass process data around without copying it.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef SPAN_H_INCLUDED
+#define SPAN_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//!***** Implementation *********************************************************
+
+//!*******************************************************************************
+//!  class :       Span
+//!*******************************************************************************
+//!  \brief        Pointer and length of data owned by someone else. The owner
+//!                has to outlive the view. Replace with std::span once the
+//!                project moves to C++20.
+//!
+//!*******************************************************************************
+template <typename T>
+class Span {
+private:
+    T *data_;
+    size_t size_;
+
+public:
+    constexpr Span() : data_(nullptr), size_(0) {}
+    constexpr Span(T *data, size_t size) : data_(data), size_(size) {}
+    template <typename U>
+    Span(const std::vector<U> &vector) : data_(vector.data()), size_(vector.size()) {}
+    template <typename U>
+    Span(std::vector<U> &vector) : data_(vector.data()), size_(vector.size()) {}
+
+    constexpr T *data() const { return data_; }
+    constexpr size_t size() const { return size_; }
+    constexpr bool empty() const { return size_ == 0; }
+    constexpr T *begin() const { return data_; }
+    constexpr T *end() const { return data_ + size_; }
+    constexpr T &operator[](size_t index) const { return data_[index]; }
+
+    //! View of count elements starting at offset, clipped to the range
+    constexpr Span subspan(size_t offset, size_t count = SIZE_MAX) const
+    {
+        if (offset > size_)
+        {
+            offset = size_;
+        }
+        if (count > size_ - offset)
+        {
+            count = size_ - offset;
+        }
+        return Span(data_ + offset, count);
+    }
+};
+
+using PDView = Span<const uint8_t>; // view of raw process data bytes
+
+#endif //SPAN_H_INCLUDED
@@ -0,0 +1,120 @@
+/*!
+ * @file SpscRing.h
+ * @brief Lock-free single producer / single consumer ring buffer. Used to hand
+ *        over data from the port communication thread to the publishing side
+ *        without taking the driver mutexes.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#ifndef SPSCRING_H_INCLUDED
+#define SPSCRING_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//!***** Implementation *********************************************************
+
+//!*******************************************************************************
+//!  class :       SpscRing
+//!*******************************************************************************
+//!  \brief        Ring buffer for exactly one producer and one consumer thread.
+//!                Size has to be a power of two, one slot stays unused to tell
+//!                full and empty apart. Copying is only allowed while neither
+//!                side is active (e.g. when the owning port is stored in a
+//!                vector during startup).
+//!
+//!*******************************************************************************
+template <typename T, size_t Size>
+class SpscRing {
+    static_assert((Size >= 2) && ((Size & (Size - 1)) == 0), "SpscRing size has to be a power of two");
+
+private:
+    T buffer_[Size];
+    alignas(64) std::atomic<size_t> head_; // next slot to write, owned by the producer
+    alignas(64) std::atomic<size_t> tail_; // next slot to read, owned by the consumer
+
+    void copyFrom(const SpscRing &other)
+    {
+        size_t tail = other.tail_.load(std::memory_order_acquire);
+        size_t head = other.head_.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; i = (i + 1) & (Size - 1))
+        {
+            buffer_[i] = other.buffer_[i];
+        }
+        head_.store(head, std::memory_order_relaxed);
+        tail_.store(tail, std::memory_order_relaxed);
+    }
+
+public:
+    SpscRing() : head_(0), tail_(0) {}
+    SpscRing(const SpscRing &other) : head_(0), tail_(0) { copyFrom(other); }
+    SpscRing &operator=(const SpscRing &other)
+    {
+        if (this != &other)
+        {
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    //! Producer side, returns false if the ring is full (element is dropped)
+    bool push(const T &value)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (Size - 1);
+        if (next == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        buffer_[head] = value;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    //! Consumer side, returns false if the ring is empty
+    bool pop(T &value)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = buffer_[tail];
+        tail_.store((tail + 1) & (Size - 1), std::memory_order_release);
+        return true;
+    }
+
+    //! Consumer side, drops all elements
+    void clear()
+    {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    bool empty() const
+    {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const
+    {
+        return (head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire)) & (Size - 1);
+    }
+
+    static constexpr size_t capacity() { return Size - 1; }
+};
+
+#endif //SPSCRING_H_INCLUDED
@@ -0,0 +1,335 @@
+/*!
+ * @file CycleScheduler.cpp
+ * @brief Drift-free PD cycle on absolute CLOCK_MONOTONIC deadlines with an
+ *        overrun policy, cycle time and per-port start time statistics.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "CycleScheduler.h"
+#include <cerrno>
+#include <time.h>
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    CycleScheduler
+//!*******************************************************************************
+//!  \brief        Constructor for CycleScheduler, the first cycle starts the
+//!                deadline grid
+//!
+//!  \type         local
+//!
+//!  \param[in]    portCount            number of ports with start time statistics
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+CycleScheduler::CycleScheduler(size_t portCount)
+    : deadline_(0), lastStart_(0), policy_(OverrunPolicy::SKIP), portStart_(portCount)
+{
+    reset();
+}
+
+//!*******************************************************************************
+//!  function :    ~CycleScheduler
+//!*******************************************************************************
+//!  \brief        Destructor for CycleScheduler
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+CycleScheduler::~CycleScheduler()
+{
+}
+
+//!*******************************************************************************
+//!  function :    now
+//!*******************************************************************************
+//!  \brief        CLOCK_MONOTONIC, doesn't jump with NTP or a set date
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       ns
+//!
+//!*******************************************************************************
+uint64_t CycleScheduler::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+//!*******************************************************************************
+//!  function :    sleepUntil
+//!*******************************************************************************
+//!  \brief        Sleeps until an absolute deadline, a signal doesn't shorten
+//!                the sleep. Returns at once if the deadline has passed.
+//!
+//!  \type         local
+//!
+//!  \param[in]    deadline             ns CLOCK_MONOTONIC
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void CycleScheduler::sleepUntil(uint64_t deadline)
+{
+    struct timespec ts;
+    ts.tv_sec = time_t(deadline / 1000000000u);
+    ts.tv_nsec = long(deadline % 1000000000u);
+    // clock_nanosleep returns the error instead of setting errno
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+    {
+    }
+}
+
+//!*******************************************************************************
+//!  function :    beginCycle
+//!*******************************************************************************
+//!  \brief        Marks the start of a cycle, counts the time since the start
+//!                of the last cycle and how late the cycle thread woke up
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void CycleScheduler::beginCycle()
+{
+    uint64_t start = now();
+    if (lastStart_ == 0)
+    {
+        deadline_ = start;
+    }
+    else
+    {
+        cycleTime_.add(start - lastStart_);
+        wakeupLatency_.add((start > deadline_) ? start - deadline_ : 0);
+    }
+    lastStart_ = start;
+    cycles_.fetch_add(1, memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    beginPort
+//!*******************************************************************************
+//!  \brief        Marks the start of the I/O of a port, counts its offset from
+//!                the deadline of the cycle (jitter of the port)
+//!
+//!  \type         local
+//!
+//!  \param[in]    port                 port number
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void CycleScheduler::beginPort(size_t port)
+{
+    if (port >= portStart_.size())
+    {
+        return;
+    }
+    uint64_t start = now();
+    portStart_[port].add((start > deadline_) ? start - deadline_ : 0);
+}
+
+//!*******************************************************************************
+//!  function :    endCycle
+//!*******************************************************************************
+//!  \brief        Sleeps until the deadline of the next cycle. If the cycle
+//!                took longer than the period, the overrun policy decides on
+//!                the deadlines that already passed.
+//!
+//!  \type         local
+//!
+//!  \param[in]    period_ms            cycle time, 0 starts the next cycle at once
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void CycleScheduler::endCycle(uint32_t period_ms)
+{
+    const uint64_t period = uint64_t(period_ms) * 1000000u;
+    uint64_t end = now();
+    if (period == 0)
+    {
+        deadline_ = end;
+        return;
+    }
+    uint64_t next = deadline_ + period;
+    if (end - lastStart_ > period)
+    {
+        overruns_.fetch_add(1, memory_order_relaxed);
+    }
+    if (end > next)
+    {
+        // deadlines next, next + period, ... up to end have passed
+        uint64_t missed = (end - next) / period + 1;
+        uint64_t skip = missed;
+        if (policy_.load(memory_order_relaxed) == OverrunPolicy::CATCH_UP)
+        {
+            // the oldest deadline starts at once, the others follow back-to-back
+            skip = (missed > MAX_CATCH_UP) ? missed - MAX_CATCH_UP : 0;
+        }
+        next += skip * period;
+        skipped_.fetch_add(skip, memory_order_relaxed);
+    }
+    deadline_ = next;
+    sleepUntil(deadline_);
+}
+
+//!*******************************************************************************
+//!  function :    setPolicy
+//!*******************************************************************************
+//!  \brief        Sets the overrun policy, used from the next overrun on
+//!
+//!  \type         local
+//!
+//!  \param[in]    policy               OverrunPolicy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void CycleScheduler::setPolicy(OverrunPolicy policy)
+{
+    policy_.store(policy, memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    getPolicy
+//!*******************************************************************************
+//!  \brief        Returns the overrun policy
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       OverrunPolicy
+//!
+//!*******************************************************************************
+OverrunPolicy CycleScheduler::getPolicy() const
+{
+    return policy_.load(memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    reset
+//!*******************************************************************************
+//!  \brief        Clears the counters and histograms, the deadline grid is kept
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void CycleScheduler::reset()
+{
+    cycles_.store(0, memory_order_relaxed);
+    overruns_.store(0, memory_order_relaxed);
+    skipped_.store(0, memory_order_relaxed);
+    cycleTime_.reset();
+    wakeupLatency_.reset();
+    for (auto &histogram : portStart_)
+    {
+        histogram.reset();
+    }
+}
+
+//!*******************************************************************************
+//!  function :    toJson
+//!*******************************************************************************
+//!  \brief        Policy, counters and histograms as JSON
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       nlohmann::json
+//!
+//!*******************************************************************************
+nlohmann::json CycleScheduler::toJson() const
+{
+    nlohmann::json jsonobject;
+    jsonobject["Policy"] = policyName(getPolicy());
+    jsonobject["Cycles"] = cycles_.load(memory_order_relaxed);
+    jsonobject["Overruns"] = overruns_.load(memory_order_relaxed);
+    jsonobject["Skipped"] = skipped_.load(memory_order_relaxed);
+    jsonobject["CycleTime"] = cycleTime_.toJson();
+    jsonobject["WakeupLatency"] = wakeupLatency_.toJson();
+    nlohmann::json ports = nlohmann::json::array();
+    for (const auto &histogram : portStart_)
+    {
+        ports.push_back(histogram.toJson());
+    }
+    jsonobject["PortStart"] = ports;
+    return jsonobject;
+}
+
+//!*******************************************************************************
+//!  function :    policyFromString
+//!*******************************************************************************
+//!  \brief        Parses the name of an overrun policy
+//!
+//!  \type         local
+//!
+//!  \param[in]    name                 "skip" or "catchup"
+//!  \param[out]   policy               OverrunPolicy
+//!
+//!  \return       true if the name is known
+//!
+//!*******************************************************************************
+bool CycleScheduler::policyFromString(const string &name, OverrunPolicy &policy)
+{
+    if (name == "skip")
+    {
+        policy = OverrunPolicy::SKIP;
+        return true;
+    }
+    if (name == "catchup")
+    {
+        policy = OverrunPolicy::CATCH_UP;
+        return true;
+    }
+    return false;
+}
+
+//!*******************************************************************************
+//!  function :    policyName
+//!*******************************************************************************
+//!  \brief        Name of an overrun policy, see policyFromString
+//!
+//!  \type         local
+//!
+//!  \param[in]    policy               OverrunPolicy
+//!
+//!  \return       name
+//!
+//!*******************************************************************************
+const char *CycleScheduler::policyName(OverrunPolicy policy)
+{
+    return (policy == OverrunPolicy::CATCH_UP) ? "catchup" : "skip";
+}
@@ -0,0 +1,405 @@
+/*!
+ * @file DataStorage.cpp
+ * @brief IO-Link Data Storage (DS) engine. Keeps the parameter set of every
+ *        port on disk and uploads/downloads it only when the parameter
+ *        checksum of the device differs.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "DataStorage.h"
+#include "IOLink.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    DataStorage
+//!*******************************************************************************
+//!  \brief        Constructor for DataStorage, records are stored in the
+//!                directory "datastorage" of the working directory
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+DataStorage::DataStorage()
+    : directory_("datastorage")
+{
+}
+
+//!*******************************************************************************
+//!  function :    DataStorage
+//!*******************************************************************************
+//!  \brief        Constructor for DataStorage
+//!
+//!  \type         local
+//!
+//!  \param[in]    directory            directory for the records
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+DataStorage::DataStorage(const string &directory)
+    : directory_(directory)
+{
+}
+
+//!*******************************************************************************
+//!  function :    ~DataStorage
+//!*******************************************************************************
+//!  \brief        Destructor for DataStorage
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+DataStorage::~DataStorage()
+{
+}
+
+//!*******************************************************************************
+//!  function :    synchronize
+//!*******************************************************************************
+//!  \brief        Compares the parameter checksum of the device with the stored
+//!                record of the port and decides what to do:
+//!                - no record or another device type: upload
+//!                - device requests an upload (DS_UPLOAD_FLAG): upload
+//!                - same checksum: nothing, a reconnect costs one ISDU read
+//!                - different checksum: download (replaced device)
+//!                Has to be called after begin() with the port claimed or
+//!                the driver lock held.
+//!
+//!  \type         local
+//!
+//!  \param[in]    &port                connected port
+//!  \param[in]    port_nr              number of the port, selects the record
+//!
+//!  \return       0 if success or nothing to do
+//!
+//!*******************************************************************************
+uint8_t DataStorage::synchronize(IOLMasterPortMax14819 &port, uint8_t port_nr)
+{
+    uint8_t retValue = SUCCESS;
+    uint32_t checksum = 0;
+    uint8_t stateProperty = 0;
+    uint16_t VendorID = get<0>(port.getDeviceId());
+    uint32_t DeviceID = get<1>(port.getDeviceId());
+
+    if (port.getDirectParameterPage()[IOL::PAGE::REVISION_ID] < IOL::DS::REVISION)
+    {
+        return SUCCESS; // IO-Link 1.0 devices have no Data Storage
+    }
+    if (readChecksum(port, checksum, stateProperty) != SUCCESS)
+    {
+        cout << "Data Storage: port " << int(port_nr) << " has no DS object" << endl;
+        return SUCCESS;
+    }
+
+    DataStorageRecord record;
+    bool stored = loadRecord(port_nr, record);
+    if (!stored || (record.VendorID != VendorID) || (record.DeviceID != DeviceID))
+    {
+        record = DataStorageRecord();
+        record.VendorID = VendorID;
+        record.DeviceID = DeviceID;
+        cout << "Data Storage: upload port " << int(port_nr) << " (new device)" << endl;
+        retValue = upload(port, record);
+    }
+    else if (stateProperty & IOL::DS::UPLOAD_FLAG)
+    {
+        cout << "Data Storage: upload port " << int(port_nr) << " (requested by device)" << endl;
+        retValue = upload(port, record);
+    }
+    else if (record.checksum == checksum)
+    {
+        return SUCCESS; // parameters unchanged, nothing to transfer
+    }
+    else
+    {
+        cout << "Data Storage: download port " << int(port_nr) << endl;
+        retValue = download(port, record);
+    }
+
+    if (retValue == SUCCESS)
+    {
+        // store the checksum the device calculated over the transferred set
+        retValue = readChecksum(port, record.checksum, stateProperty);
+    }
+    if (retValue == SUCCESS)
+    {
+        saveRecord(port_nr, record);
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    readChecksum
+//!*******************************************************************************
+//!  \brief        Reads State Property and Parameter Checksum of the DS object
+//!
+//!  \type         local
+//!
+//!  \param[in]    &port                connected port
+//!  \param[out]   &checksum            parameter checksum (subindex 4)
+//!  \param[out]   &stateProperty       state property (subindex 2)
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t DataStorage::readChecksum(IOLMasterPortMax14819 &port, uint32_t &checksum, uint8_t &stateProperty)
+{
+    vector<IsduRequest> requests(2);
+    requests[0] = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_STATE_PROPERTY, false, {}, ERROR, 0};
+    requests[1] = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_CHECKSUM, false, {}, ERROR, 0};
+
+    if ((port.processISDUBatch(requests) != SUCCESS) || requests[0].data.empty() || (requests[1].data.size() != 4))
+    {
+        return ERROR;
+    }
+    stateProperty = requests[0].data[0];
+    checksum = (uint32_t(requests[1].data[0]) << 24) | (uint32_t(requests[1].data[1]) << 16) |
+               (uint32_t(requests[1].data[2]) << 8) | requests[1].data[3];
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    upload
+//!*******************************************************************************
+//!  \brief        Reads the Index_List of the DS object and all parameters
+//!                listed in it (device -> master), framed by DS_UploadStart and
+//!                DS_UploadEnd. DS_UploadEnd clears the upload flag. The first
+//!                failing read ends the upload with DS_Break, the record is
+//!                incomplete then and must not be stored.
+//!
+//!  \type         local
+//!
+//!  \param[in]    &port                connected port
+//!  \param[out]   &record              record to fill
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t DataStorage::upload(IOLMasterPortMax14819 &port, DataStorageRecord &record)
+{
+    uint8_t retValue = SUCCESS;
+    vector<IsduRequest> requests(2);
+    requests[0] = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, true, {IOL::DS::UPLOAD_START}, ERROR, 0};
+    requests[1] = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_INDEX_LIST, false, {}, ERROR, 0};
+    vector<IsduRequest> abort = {{IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, true, {IOL::DS::BREAK}, ERROR, 0}};
+    retValue = port.processISDUBatch(requests);
+    if (retValue != SUCCESS)
+    {
+        port.processISDUBatch(abort);
+        return retValue;
+    }
+
+    // Index_List: entries of index (16 bit) and subindex, terminated by index 0
+    vector<uint8_t> &indexList = requests[1].data;
+    record.parameters.clear();
+    for (size_t i = 0; (i + 2) < indexList.size(); i += 3)
+    {
+        uint16_t index = uint16_t((indexList[i] << 8) | indexList[i + 1]);
+        if (index == 0)
+        {
+            break;
+        }
+        record.parameters.push_back({index, indexList[i + 2], false, {}, ERROR, 0});
+    }
+    // a batch doesn't stop at a failing request, so the parameters are read one by one
+    for (auto &parameter : record.parameters)
+    {
+        retValue = port.readISDU(parameter.data, parameter.index, parameter.subIndex);
+        parameter.status = retValue;
+        if (retValue != SUCCESS)
+        {
+            cout << "Data Storage: reading index " << parameter.index << " failed, upload aborted" << endl;
+            port.processISDUBatch(abort);
+            return retValue;
+        }
+        parameter.write = true; // stored parameters are written back on download
+    }
+    vector<IsduRequest> uploadEnd = {{IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, true, {IOL::DS::UPLOAD_END}, ERROR, 0}};
+    return port.processISDUBatch(uploadEnd);
+}
+
+//!*******************************************************************************
+//!  function :    download
+//!*******************************************************************************
+//!  \brief        Writes the stored parameter set (master -> device) as one
+//!                block framed by DS_DownloadStart and DS_DownloadEnd
+//!
+//!  \type         local
+//!
+//!  \param[in]    &port                connected port
+//!  \param[in]    &record              stored record
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t DataStorage::download(IOLMasterPortMax14819 &port, DataStorageRecord &record)
+{
+    uint8_t retValue = SUCCESS;
+    vector<IsduRequest> requests;
+    requests.reserve(record.parameters.size() + 2);
+    requests.push_back({IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, true, {IOL::DS::DOWNLOAD_START}, ERROR, 0});
+    requests.insert(requests.end(), record.parameters.begin(), record.parameters.end());
+    requests.push_back({IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, true, {IOL::DS::DOWNLOAD_END}, ERROR, 0});
+
+    retValue = port.processISDUBatch(requests);
+    if (retValue != SUCCESS)
+    {
+        vector<IsduRequest> abort = {{IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, true, {IOL::DS::BREAK}, ERROR, 0}};
+        port.processISDUBatch(abort);
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    recordPath
+//!*******************************************************************************
+//!  \brief        Returns the file name of the record of a port
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              number of the port
+//!
+//!  \return       path of the record file
+//!
+//!*******************************************************************************
+string DataStorage::recordPath(uint8_t port_nr)
+{
+    return directory_ + "/port" + to_string(port_nr) + ".json";
+}
+
+//!*******************************************************************************
+//!  function :    loadRecord
+//!*******************************************************************************
+//!  \brief        Loads the stored record of a port
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              number of the port
+//!  \param[out]   &record              stored record
+//!
+//!  \return       true if a valid record exists, a malformed record is
+//!                treated as missing
+//!
+//!*******************************************************************************
+bool DataStorage::loadRecord(uint8_t port_nr, DataStorageRecord &record)
+{
+    ifstream file(recordPath(port_nr));
+    if (!file.is_open())
+    {
+        return false;
+    }
+    json stored = json::parse(file, nullptr, false);
+    if (stored.is_discarded() || !stored.is_object())
+    {
+        return false;
+    }
+    // hand-edited or damaged files must not throw out of synchronize()
+    try
+    {
+        record.VendorID = stored.value("VendorID", uint16_t(0));
+        record.DeviceID = stored.value("DeviceID", uint32_t(0));
+        record.checksum = stored.value("Checksum", uint32_t(0));
+        record.parameters.clear();
+        for (auto &item : stored.at("Parameters"))
+        {
+            IsduRequest parameter = {item.at("Index").get<uint16_t>(), item.at("Subindex").get<uint8_t>(), true, {}, ERROR, 0};
+            string hexStr = item.at("Data").get<string>();
+            for (size_t i = 0; (i + 1) < hexStr.size(); i += 2)
+            {
+                size_t length = 0;
+                parameter.data.push_back(uint8_t(stoul(hexStr.substr(i, 2), &length, 16)));
+                if (length != 2)
+                {
+                    return false;
+                }
+            }
+            record.parameters.push_back(parameter);
+        }
+    }
+    catch (const exception &e)
+    {
+        cout << "Data Storage: record of port " << int(port_nr) << " is invalid: " << e.what() << endl;
+        record = DataStorageRecord();
+        return false;
+    }
+    return true;
+}
+
+//!*******************************************************************************
+//!  function :    saveRecord
+//!*******************************************************************************
+//!  \brief        Stores the record of a port. The file is written under a
+//!                temporary name and renamed, so a power loss never leaves a
+//!                half written record behind.
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              number of the port
+//!  \param[in]    &record              record to store
+//!
+//!  \return       true if success
+//!
+//!*******************************************************************************
+bool DataStorage::saveRecord(uint8_t port_nr, const DataStorageRecord &record)
+{
+    json stored;
+    stored["VendorID"] = record.VendorID;
+    stored["DeviceID"] = record.DeviceID;
+    stored["Checksum"] = record.checksum;
+    stored["Parameters"] = json::array();
+    for (auto &parameter : record.parameters)
+    {
+        std::ostringstream os;
+        for (uint8_t value : parameter.data)
+        {
+            os << hex << setw(2) << setfill('0') << int(value);
+        }
+        stored["Parameters"].push_back({{"Index", parameter.index}, {"Subindex", parameter.subIndex}, {"Data", os.str()}});
+    }
+
+    mkdir(directory_.c_str(), 0755);
+    string path = recordPath(port_nr);
+    string tmpPath = path + ".tmp";
+    {
+        ofstream file(tmpPath, ios::trunc);
+        if (!file.is_open())
+        {
+            cout << "Data Storage: cannot write " << tmpPath << endl;
+            return false;
+        }
+        file << stored.dump(1);
+    }
+    return rename(tmpPath.c_str(), path.c_str()) == 0;
+}
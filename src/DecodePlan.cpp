@@ -0,0 +1,190 @@
+#include "DecodePlan.h"
+/*!
+ * @file DecodePlan.cpp
+ * @brief Process data layouts compiled into flat decode plans and the
+ *        registry holding them per Vendor/Device/Revision
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+#include <mutex>
+
+/**
+ * \brief Resolves the IODD datatype name once, when a layout is loaded.
+ *
+ * \param type datatype as written in the IODD, e.g. "UIntegerT"
+ * \return the datatype, IolType::Invalid if not supported
+ */
+IolType iolTypeFromString(const std::string &type)
+{
+    for (std::size_t i = 1; i < static_cast<std::size_t>(IolType::Count); i++)
+    {
+        if (type == iolTypeName(static_cast<IolType>(i)))
+        {
+            return static_cast<IolType>(i);
+        }
+    }
+    return IolType::Invalid;
+}
+
+/**
+ * \brief Datatype name as written in the IODD.
+ *
+ * \return the name, "Invalid" if not supported
+ */
+const char *iolTypeName(IolType type)
+{
+    switch (type)
+    {
+    case IolType::BooleanT:
+        return "BooleanT";
+    case IolType::UIntegerT:
+        return "UIntegerT";
+    case IolType::Float32T:
+        return "Float32T";
+    case IolType::IntegerT:
+        return "IntegerT";
+    case IolType::StringT:
+        return "StringT";
+    case IolType::OctetStringT:
+        return "OctetStringT";
+    case IolType::TimeT:
+        return "TimeT";
+    case IolType::TimeSpanT:
+        return "TimeSpanT";
+    default:
+        return "Invalid";
+    }
+}
+
+/**
+ * \brief Bit length of a datatype if the IODD doesn't specify one.
+ *
+ * \return the bit length, 0 for types without a fixed length
+ */
+uint16_t iolDefaultBitLength(IolType type)
+{
+    switch (type)
+    {
+    case IolType::BooleanT:
+        return 1;
+    case IolType::UIntegerT:
+    case IolType::IntegerT:
+    case IolType::TimeT:
+    case IolType::TimeSpanT:
+        return 64;
+    case IolType::Float32T:
+        return 32;
+    default:
+        return 0;
+    }
+}
+
+namespace
+{
+
+uint64_t fnv1a(uint64_t hash, const void *data, std::size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/** \brief Identifies a layout in binary payloads, equal layouts get equal ids. */
+uint32_t planId(const DecodePlan &plan)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const PlanElement &element : plan.elements)
+    {
+        const std::string &key = plan.keys[element.keyIndex];
+        hash = fnv1a(hash, &element.bitOffset, sizeof(element.bitOffset));
+        hash = fnv1a(hash, &element.bitLength, sizeof(element.bitLength));
+        hash = fnv1a(hash, &element.type, sizeof(element.type));
+        hash = fnv1a(hash, &element.gradient, sizeof(element.gradient));
+        hash = fnv1a(hash, &element.offset, sizeof(element.offset));
+        hash = fnv1a(hash, key.c_str(), key.size() + 1u);
+    }
+    const uint32_t id = static_cast<uint32_t>(hash ^ (hash >> 32u));
+    return (id != 0u) ? id : 1u;
+}
+
+} // namespace
+
+/**
+ * \brief Compiles a list of process data elements into a decode plan.
+ *
+ * Missing bit lengths are filled in here, so the decoder only walks a flat
+ * array.
+ *
+ * \param elements process data elements of one device
+ * \return the decode plan
+ */
+DecodePlan compileDecodePlan(const std::vector<ProcessDataElement> &elements)
+{
+    DecodePlan plan;
+    plan.elements.reserve(elements.size());
+    plan.keys.reserve(elements.size());
+    for (const ProcessDataElement &element : elements)
+    {
+        PlanElement planElement;
+        planElement.type = element.type;
+        planElement.bitOffset = element.bitOffset;
+        planElement.bitLength = element.bitLength;
+        if (planElement.bitLength > 8u * PD_MAX_LENGTH || planElement.bitLength == 0)
+        {
+            planElement.bitLength = iolDefaultBitLength(planElement.type);
+        }
+        planElement.keyIndex = static_cast<uint16_t>(plan.keys.size());
+        planElement.gradient = element.processDataInfo.gradient;
+        planElement.offset = element.processDataInfo.offset;
+        planElement.scaled = (planElement.gradient != 1.0) || (planElement.offset != 0.0);
+        plan.views = plan.views || (planElement.type == IolType::StringT) || (planElement.type == IolType::OctetStringT);
+        plan.keys.push_back(element.key);
+        plan.elements.push_back(planElement);
+    }
+    plan.id = planId(plan);
+    return plan;
+}
+
+uint64_t DecodePlanRegistry::key(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID)
+{
+    // DeviceID has 24 bits
+    return (static_cast<uint64_t>(VendorID) << 32u) | (static_cast<uint64_t>(DeviceID & 0xFFFFFFu) << 8u) | RevisionID;
+}
+
+/**
+ * \brief Compiles and stores the plan of a device, replacing an older one.
+ *
+ * \param RevisionID IO-Link revision, ANY_REVISION for all revisions
+ * \param decode generated decoder of the device, nullptr for none
+ * \param encode generated encoder of the device, nullptr for none
+ */
+void DecodePlanRegistry::add(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID, const std::vector<ProcessDataElement> &elements, DecodeFn decode, EncodeFn encode)
+{
+    DecodePlan compiled = compileDecodePlan(elements);
+    compiled.decode = decode;
+    compiled.encode = encode;
+    auto plan = std::make_shared<const DecodePlan>(std::move(compiled));
+    std::unique_lock<std::shared_mutex> lock(plansMutex_);
+    plans_[key(VendorID, DeviceID, RevisionID)] = plan;
+}
+
+/**
+ * \brief Looks up the plan of a device, an exact revision match first.
+ *
+ * \return the plan, nullptr if the device is unknown
+ */
+std::shared_ptr<const DecodePlan> DecodePlanRegistry::find(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const
+{
+    std::shared_lock<std::shared_mutex> lock(plansMutex_);
+    auto it = plans_.find(key(VendorID, DeviceID, RevisionID));
+    if (it == plans_.end())
+    {
+        it = plans_.find(key(VendorID, DeviceID, ANY_REVISION));
+    }
+    return (it != plans_.end()) ? it->second : nullptr;
+}
@@ -134,6 +134,42 @@ void HardwareRaspberry::IO_PinMode(PinNames pinname, PinMode mode)
 	}
 }
 
+//!*****************************************************************************
+//! function :      IO_Read
+//!*****************************************************************************
+//!  \brief        Reads the logical value of a pin
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the Pin
+//!
+//!  \return       HIGH or LOW
+//!
+//!*****************************************************************************
+uint8_t HardwareRaspberry::IO_Read(PinNames pinname)
+{
+	return digitalRead(get_pinnumber(pinname)) ? HIGH : LOW;
+}
+
+//!*****************************************************************************
+//! function :      IO_Interrupt
+//!*****************************************************************************
+//!  \brief        Registers a function which is called on both edges of a pin.
+//!                The function runs in a separate thread created by wiringPi.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the Pin
+//!  			   function   interrupt handler
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t HardwareRaspberry::IO_Interrupt(PinNames pinname, void (*function)(void))
+{
+	return (wiringPiISR(get_pinnumber(pinname), INT_EDGE_BOTH, function) < 0) ? 1 : 0;
+}
+
 //!*****************************************************************************
 //! function :      Serial_Write
 //!*****************************************************************************
@@ -19,6 +19,7 @@
 
 //!**** Header-Files ***********************************************************
 #include "IOLGenericDevice.h"
+#include "IOLink.h"
 #include <stdio.h>
 
 //!**** Implementation *********************************************************
@@ -63,7 +64,9 @@ void IOLGenericDevice::end()
 //!*****************************************************************************
 //!  function :    eventHandler
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Not implemented yet. The event queue of the port has a single
+//!                consumer, ShieldCommunication::Event_dispatch, which pushes
+//!                the events to MQTT and websocket.
 //!
 //!  \type         local
 //!
@@ -175,49 +178,52 @@ void IOLGenericDevice::readProcessData()
 //!*****************************************************************************
 //!  function :    writeCQ
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Drives the CQ line of a port in SIO output mode
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]	   level                HIGH or LOW
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::writeCQ()
+uint8_t IOLGenericDevice::writeCQ(uint8_t level)
 {
+	return port->writeCQ(level);
 }
 
 //!*****************************************************************************
 //!  function :    readCQ
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the CQ line of a port in SIO mode
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]	   &level               HIGH or LOW
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readCQ()
+uint8_t IOLGenericDevice::readCQ(uint8_t &level)
 {
+	return port->readCQ(level);
 }
 
 //!*****************************************************************************
 //!  function :    readDI
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the DI line of the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]	   &level               HIGH or LOW
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readDI()
+uint8_t IOLGenericDevice::readDI(uint8_t &level)
 {
+	return port->readDI(level);
 }
 
 //!*****************************************************************************
@@ -319,129 +325,145 @@ void IOLGenericDevice::readPDOutputDescriptor()
 //!*****************************************************************************
 //!  function :    readVendorName
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the vendor name (ISDU index 0x10), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    vendor name as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readVendorName()
+uint8_t IOLGenericDevice::readVendorName(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::VENDOR_NAME, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readVendorText
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the vendor text (ISDU index 0x11), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    vendor text as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readVendorText()
+uint8_t IOLGenericDevice::readVendorText(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::VENDOR_TEXT, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readProductName
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the product name (ISDU index 0x12), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    product name as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProductName()
+uint8_t IOLGenericDevice::readProductName(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::PRODUCT_NAME, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readProductID
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the product ID (ISDU index 0x13), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    product ID as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProductID()
+uint8_t IOLGenericDevice::readProductID(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::PRODUCT_ID, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readProductText
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the product text (ISDU index 0x14), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    product text as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProductText()
+uint8_t IOLGenericDevice::readProductText(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::PRODUCT_TEXT, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readSerialNumber
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the serial number (ISDU index 0x15), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    serial number as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readSerialNumber()
+uint8_t IOLGenericDevice::readSerialNumber(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::SERIAL_NUMBER, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readHardwareRev
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the hardware revision (ISDU index 0x16), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    hardware revision as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readHardwareRev()
+uint8_t IOLGenericDevice::readHardwareRev(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::HARDWARE_REV, 0);
 }
 
 //!*****************************************************************************
 //!  function :    readFirmwareRev
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the firmware revision (ISDU index 0x17), served by the
+//!                parameter cache of the port after the first read
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   oData    firmware revision as received from the device
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readFirmwareRev()
+uint8_t IOLGenericDevice::readFirmwareRev(vector<uint8_t>& oData)
 {
+	return port->readISDUCached(oData, IOL::INDEX::FIRMWARE_REV, 0);
 }
 
 //!*****************************************************************************
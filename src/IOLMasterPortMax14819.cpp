@@ -29,6 +29,7 @@
 #include <math.h>
 #include "IoddManager.h"
 #include <cstdio>
+#include <chrono>
 
 //!***** Implementation **********************************************************
 
@@ -49,7 +50,6 @@ IOLMasterPortMax14819::IOLMasterPortMax14819()
       port_(max14819::PORTA),
       portType_(0),
       diModeSupport_(0),
-      portMode_(0),
       portStatus_(0),
       actualCycleTime_(0),
       comSpeed_(0)
@@ -73,7 +73,6 @@ IOLMasterPortMax14819::IOLMasterPortMax14819(max14819::Max14819 *pDriver, max148
       port_(port),
       portType_(0),
       diModeSupport_(0),
-      portMode_(0),
       portStatus_(0),
       actualCycleTime_(0),
       comSpeed_(0),
@@ -119,6 +118,7 @@ uint8_t IOLMasterPortMax14819::begin()
     char buf[256];
     uint8_t retValue = SUCCESS;
 
+    fullStartupPending_ = false;
     // Initialize drivers
     if (pDriver_->begin(port_) == ERROR)
     {
@@ -147,25 +147,23 @@ uint8_t IOLMasterPortMax14819::begin()
         // BOS DEBUG
 
         pDriver_->Serial_Write("Device");
-        uint8_t pData[3];
+        // Read the identification part of the direct parameter page 1 in one go (MinCycleTime - DeviceID)
+        uint8_t *page = directParameterPage_;
+        readDirectParameterPage(IOL::PAGE::MIN_CYCLE_TIME, uint8_t(IOL::PAGE::DEVICE_ID3 - IOL::PAGE::MIN_CYCLE_TIME + 1), &page[IOL::PAGE::MIN_CYCLE_TIME]);
         // M-sequence Capability (IOL-Specification page: 239)
-        readDirectParameterPage(IOL::PAGE::M_SEQ_CAP, pData);
-        mSequenceType_ = uint8_t((pData[0] >> 1) & 0x07); // shift 1 to the right (first bit is ISDU support bit), clear all bits except first three (get a range of possible values: 0 - 7)
+        mSequenceType_ = uint8_t((page[IOL::PAGE::M_SEQ_CAP] >> 1) & 0x07); // shift 1 to the right (first bit is ISDU support bit), clear all bits except first three (get a range of possible values: 0 - 7)
         // cout<<"MSequence Type: "<<int(mSequenceType_)<<endl;
         // RevisionID IOL-Version
-        readDirectParameterPage(IOL::PAGE::REVISION_ID, pData);
-        RevisionID_ = uint8_t(pData[0]);
+        RevisionID_ = uint8_t(page[IOL::PAGE::REVISION_ID]);
         // ProcessDataIn
-        readDirectParameterPage(IOL::PAGE::PD_IN, pData);
-        ProcessDataIn_ = uint8_t(pData[0] & 0x1F);         // get pData in Range: 0 - 31 (5 Bits)
-        ProcessDataInByte_ = uint8_t((pData[0] >> 7) & 1); // read last bit of the Byte
+        ProcessDataIn_ = uint8_t(page[IOL::PAGE::PD_IN] & 0x1F);         // get pData in Range: 0 - 31 (5 Bits)
+        ProcessDataInByte_ = uint8_t((page[IOL::PAGE::PD_IN] >> 7) & 1); // read last bit of the Byte
         // cout<<"ProcessDataIn_: "<<int(ProcessDataIn_)<<endl;
         // cout<<"ProcessDataInByte_: "<<int(ProcessDataInByte_)<<endl;
 
         // ProcessDataOut
-        readDirectParameterPage(IOL::PAGE::PD_OUT, pData);
-        ProcessDataOut_ = uint8_t(pData[0] & 0x1F);         // get pData in Range: 0 - 7
-        ProcessDataOutByte_ = uint8_t((pData[0] >> 7) & 1); // read last bit of the Byte
+        ProcessDataOut_ = uint8_t(page[IOL::PAGE::PD_OUT] & 0x1F);         // get pData in Range: 0 - 7
+        ProcessDataOutByte_ = uint8_t((page[IOL::PAGE::PD_OUT] >> 7) & 1); // read last bit of the Byte
         // cout<<"ProcessDataOut_: "<<int(ProcessDataOut_)<<endl;
         // cout<<"ProcessDataOutByte_: "<<int(ProcessDataOutByte_)<<endl;
 
@@ -346,14 +344,11 @@ uint8_t IOLMasterPortMax14819::begin()
         // End of Calculation=============================================
 
         // VendorID (writeen in string)
-        readDirectParameterPage(IOL::PAGE::VENDOR_ID1, pData);     // MSB = Most Significant Bit
-        readDirectParameterPage(IOL::PAGE::VENDOR_ID2, pData + 1); // LSB = Least Significant Bit
-        VendorID_ = uint16_t((pData[0] << 8) | pData[1]);
+        VendorID_ = uint16_t((page[IOL::PAGE::VENDOR_ID1] << 8) | page[IOL::PAGE::VENDOR_ID2]); // MSB, LSB
         // DeviceID
-        readDirectParameterPage(IOL::PAGE::DEVICE_ID1, pData); // MSB
-        readDirectParameterPage(IOL::PAGE::DEVICE_ID2, pData + 1);
-        readDirectParameterPage(IOL::PAGE::DEVICE_ID3, pData + 2); // LSB
-        DeviceID_ = (pData[0] << 16) | (pData[1] << 8) | pData[2];
+        DeviceID_ = (page[IOL::PAGE::DEVICE_ID1] << 16) | (page[IOL::PAGE::DEVICE_ID2] << 8) | page[IOL::PAGE::DEVICE_ID3];
+        // drops the cached parameters if another device type has been connected
+        paramCache_.setDevice(VendorID_, DeviceID_);
 
         // quick fix BES (OD Data = 2 Byte anstatt 1 Byte)
         if (DeviceID_ == 132099)
@@ -364,10 +359,6 @@ uint8_t IOLMasterPortMax14819::begin()
         sprintf(buf, "Vendor ID: %d, Device ID: %d, MSequenceType: %d, ProcessDataIn: %d, ProcessDataOut: %d, OD: %d, RevisionID: %d\n", VendorID_, DeviceID_, mSequenceType_, ProcessDataIn_, ProcessDataOut_, OnRequestData_, RevisionID_);
         pDriver_->Serial_Write(buf);
 
-        if (DeviceID_ == 263955)
-        { // TODO: BCM timing problem, check if necessary
-            pDriver_->wait_for(1000);
-        }
         // std::string ioddRev("1.1");
         // std::shared_ptr<std::string> parsedIODD = iodd::IoddStore::getInstance().getIoddFile(VendorID_, DeviceID_, ioddRev);
         // std::shared_ptr<std::string> parsedIODD = iodd::IoddStore::getInstance().getIoddFile(VendorID_, uint32_t(917761), ioddRev);
@@ -380,14 +371,45 @@ uint8_t IOLMasterPortMax14819::begin()
 
         // cout << parsedIODD << endl;
 
-        // Switch from STARTUP Mode directly (without PREOPERATE) to OPERATE Mode (IOL-Spec page 75)
-        uint8_t value[1] = {IOL::MC::DEV_OPERATE};
-        if (pDriver_->writeData(IOL::MC::PAGE_WRITE, 1, value, 1, IOL::M_TYPE_0, port_) == ERROR)
-        {
-            sprintf(buf, "Error operate driver01 PortA"); // TODO:
-            pDriver_->Serial_Write(buf);
-        }
-        if (ProcessDataOut_)
+        retValue = uint8_t(retValue | startOperate(false));
+        // pDriver_->wait_for(200);
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    startOperate
+//!*******************************************************************************
+//!  \brief        Switches the device from STARTUP to OPERATE and validates the
+//!                process data output. Used by begin() and reconnect().
+//!
+//!  \type         local
+//!
+//!  \param[in]	   fastReconnect        true if the device is the last known one,
+//!                                     skips the fixed startup delays
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::startOperate(bool fastReconnect)
+{
+    uint8_t retValue = SUCCESS;
+
+    if ((DeviceID_ == 263955) && !fastReconnect)
+    { // TODO: BCM timing problem, check if necessary
+        pDriver_->wait_for(1000);
+    }
+
+    // Switch from STARTUP Mode directly (without PREOPERATE) to OPERATE Mode (IOL-Spec page 75)
+    uint8_t value[1] = {IOL::MC::DEV_OPERATE};
+    if (pDriver_->writeData(IOL::MC::PAGE_WRITE, 1, value, 1, IOL::M_TYPE_0, port_) == ERROR)
+    {
+        pDriver_->Serial_Write("Error operate driver01 PortA"); // TODO:
+        retValue = ERROR;
+    }
+    if (ProcessDataOut_)
+    {
+        if (!fastReconnect)
         {
             // ProzessData initial mit 0 Beschreiben
             vector<uint8_t> pDataOut;
@@ -396,44 +418,165 @@ uint8_t IOLMasterPortMax14819::begin()
                 pDataOut.push_back(0);
             }
             get_PDclass()->write_procDataOut(pDataOut);
-
             // MC für valide PDout Daten senden
             pDriver_->wait_for(200);
-            uint8_t value2[ProcessDataOut_ + OnRequestData_];
-            for (int i = 0; i < ProcessDataOut_ + OnRequestData_; i++)
+        }
+        else
+        {
+            // the device is already known, keep the last PDout and only wait for the answer to the operate command
+            pDriver_->waitForAnswer(port_, 1, 10);
+        }
+        uint8_t value2[ProcessDataOut_ + OnRequestData_];
+        for (int i = 0; i < ProcessDataOut_ + OnRequestData_; i++)
+        {
+            if (i == (ProcessDataOut_))
             {
-                if (i == (ProcessDataOut_))
-                {
-                    value2[i] = IOL::MC::PDOUT_VALID; // place MC on first Byte of OD Data
-                }
-                else
-                {
-                    value2[i] = 0;
-                }
+                value2[i] = IOL::MC::PDOUT_VALID; // place MC on first Byte of OD Data
+            }
+            else
+            {
+                value2[i] = 0;
             }
-            cout << "PDOUT erforderlicher Mastercommand wurde gesendet" << endl;
+        }
+        cout << "PDOUT erforderlicher Mastercommand wurde gesendet" << endl;
 
-            pDriver_->writeData(IOL::MC::PAGE_WRITE, ProcessDataOut_ + OnRequestData_, value2, 1, mSequenceType_, port_);
+        pDriver_->writeData(IOL::MC::PAGE_WRITE, ProcessDataOut_ + OnRequestData_, value2, 1, mSequenceType_, port_);
 
-            // quick fix BOS0285
-            // first message doesn't send the right bits (parity error or something else is the fault)
-            if (DeviceID_ == 264968)
+        // quick fix BOS0285
+        // first message doesn't send the right bits (parity error or something else is the fault)
+        if (DeviceID_ == 264968)
+        {
+            vector<uint8_t> oData;
+            for (uint8_t i = 0; i < 2; i++)
             {
-                vector<uint8_t> oData;
-                for (uint8_t i = 0; i < 2; i++)
-                {
-                    pDriver_->wait_for(10);
-                    readISDU(oData, 0x0010, 0x00);
-                    oData.clear();
-                }
+                pDriver_->wait_for(10);
+                readISDU(oData, 0x0010, 0x00);
+                oData.clear();
             }
         }
-        get_PDclass()->set_iodd(VendorID_, DeviceID_, RevisionID_);
-        // pDriver_->wait_for(200);
     }
+    get_PDclass()->set_iodd(VendorID_, DeviceID_, RevisionID_);
+
+    // start the event readout of the new device from scratch
+    eventReadout_ = EventReadout();
+
+    // remember the device for a fast reconnect after a dropout
+    lastDevice_.valid = true;
+    lastDevice_.comSpeed = comSpeed_;
+    lastDevice_.mSequenceType = mSequenceType_;
+    lastDevice_.ProcessDataIn = ProcessDataIn_;
+    lastDevice_.ProcessDataOut = ProcessDataOut_;
+    lastDevice_.OnRequestData = OnRequestData_;
+    lastDevice_.VendorID = VendorID_;
+    lastDevice_.DeviceID = DeviceID_;
+    lastDevice_.RevisionID = RevisionID_;
+    memcpy(lastDevice_.identPage, &directParameterPage_[IOL::PAGE::REVISION_ID], sizeof(lastDevice_.identPage));
     return retValue;
 }
 
+//!*******************************************************************************
+//!  function :    reconnect
+//!*******************************************************************************
+//!  \brief        Reconnects to the device after a dropout. If the same device
+//!                as before answers (COM speed and identification pages
+//!                RevisionID - DeviceID unchanged) the port jumps straight to
+//!                OPERATE with the stored parameters. Otherwise the port is
+//!                only marked for the complete begin() sequence (see
+//!                needsFullStartup), it takes seconds and must not run in the
+//!                PD cycle.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       0 if success, ERROR if no device answers or a full startup
+//!                is needed
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::reconnect()
+{
+    if (!lastDevice_.valid)
+    {
+        fullStartupPending_ = true;
+        return ERROR;
+    }
+
+    uint32_t comSpeed = 0;
+    if (pDriver_->wakeUpRequest(port_, &comSpeed) == ERROR)
+    {
+        deviceConnection = 1;
+        return ERROR;
+    }
+    if (comSpeed != lastDevice_.comSpeed)
+    {
+        deviceConnection = 1;
+        fullStartupPending_ = true;
+        return ERROR;
+    }
+
+    // a failed read must not compare the bytes of the last device
+    uint8_t *page = directParameterPage_;
+    memset(&page[IOL::PAGE::REVISION_ID], 0, sizeof(lastDevice_.identPage));
+    if ((readDirectParameterPage(IOL::PAGE::REVISION_ID, sizeof(lastDevice_.identPage), &page[IOL::PAGE::REVISION_ID]) != SUCCESS) ||
+        (memcmp(&page[IOL::PAGE::REVISION_ID], lastDevice_.identPage, sizeof(lastDevice_.identPage)) != 0))
+    {
+        pDriver_->Serial_Write("Different device connected, full startup");
+        deviceConnection = 1;
+        fullStartupPending_ = true;
+        return ERROR;
+    }
+
+    deviceConnection = 0;
+    comSpeed_ = lastDevice_.comSpeed;
+    mSequenceType_ = lastDevice_.mSequenceType;
+    ProcessDataIn_ = lastDevice_.ProcessDataIn;
+    ProcessDataOut_ = lastDevice_.ProcessDataOut;
+    OnRequestData_ = lastDevice_.OnRequestData;
+    VendorID_ = lastDevice_.VendorID;
+    DeviceID_ = lastDevice_.DeviceID;
+    RevisionID_ = lastDevice_.RevisionID;
+    // same device type, the serial number still has to be verified before cache hits
+    paramCache_.setDevice(VendorID_, DeviceID_);
+    pDriver_->Serial_Write("Known device reconnected");
+    return startOperate(true);
+}
+
+//!*******************************************************************************
+//!  function :    hasLastKnownDevice
+//!*******************************************************************************
+//!  \brief        Returns if a device has been in OPERATE on this port before,
+//!                i.e. a fast reconnect is possible
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       true if a last known device is stored
+//!
+//!*******************************************************************************
+bool IOLMasterPortMax14819::hasLastKnownDevice()
+{
+    return lastDevice_.valid;
+}
+
+//!*******************************************************************************
+//!  function :    needsFullStartup
+//!*******************************************************************************
+//!  \brief        Returns if reconnect() gave up on the fast path, the port
+//!                waits for begin() then
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       true if begin() has to run
+//!
+//!*******************************************************************************
+bool IOLMasterPortMax14819::needsFullStartup()
+{
+    return fullStartupPending_;
+}
+
 //!*******************************************************************************
 //!  function :    end
 //!*******************************************************************************
@@ -466,55 +609,286 @@ uint8_t IOLMasterPortMax14819::end()
 //!  function :    readPD
 //!*******************************************************************************
 //!  \brief        Sends a process data request to the device and receive the
-//!                answer from the slave.
+//!                answer from the slave. The PD is read from the FIFO straight
+//!                into a stack buffer and published in the PDclass.
 //!
 //!  \type         local
 //!
-//!  \param[in]    &pData               reference of pData
+//!  \param[in]    void
 //!
 //!  \return       0 if success and processdata valid
 //!
 //!*******************************************************************************
 
-uint8_t IOLMasterPortMax14819::readPD(vector<uint8_t> &pData) // wird aktuell verwendet
+uint8_t IOLMasterPortMax14819::readPD() // wird aktuell verwendet
 {
     uint8_t retValue = SUCCESS;
     uint8_t sizeAnswer = ProcessDataIn_ + OnRequestData_;
-
+    uint8_t pOut[max14819::MAX_MSG_LENGTH] = {0};
+    uint8_t pOD[max14819::MAX_MSG_LENGTH] = {0};
+    uint8_t pIn[max14819::MAX_MSG_LENGTH];
+    uint8_t sizeIn = 0;
+    uint8_t sizeOut = ProcessDataOut_;
+    uint8_t sizeOD = OnRequestData_;
+    int16_t cks = -1;
+
+    if ((sizeAnswer > max14819::MAX_MSG_LENGTH) || ((ProcessDataOut_ + OnRequestData_ + 2) > max14819::MAX_MSG_LENGTH))
+    {
+        return ERROR;
+    }
+    // the OD part of the cycle reads the event memory if there is an event pending
+    uint8_t mc = nextEventMC();
+    // cycle boundary: PDout updates written since the last cycle are applied
+    // as a whole, all frames of this cycle carry the same PDout
+    pdOutCycle_ = pdclass.read_procDataOut();
     if (ProcessDataOut_ > 0)
     {
-        vector<uint8_t> pOut;
         pDriver_->wait_for(10);
-        vector<uint8_t> tmp1 = pdclass.get_procDataOut();
-        if (tmp1.size() != sizeAnswer)
+        loadProcessDataOut(pOut);
+    }
+    if (mc == uint8_t(IOL::MC::DIAG_WRITE | IOL::EVENT::STATUS_CODE))
+    {
+        // confirm the events, written value doesn't matter
+        pOut[ProcessDataOut_] = 0xFF;
+        sizeOut = uint8_t(ProcessDataOut_ + OnRequestData_);
+        // the reply to a write M-sequence carries PDin and CKS only, no OD
+        sizeOD = 0;
+        sizeAnswer = ProcessDataIn_;
+    }
+    // Send process data request to device
+    retValue = uint8_t(retValue | pDriver_->writeData(mc, sizeOut, (sizeOut > 0) ? pOut : nullptr, sizeAnswer, mSequenceType_, port_));
+    if (retValue == SUCCESS)
+    {
+        confirmProcessDataOut();
+    }
+    pDriver_->wait_for(5);
+    // read received answer
+    retValue = uint8_t(retValue | pDriver_->readPD(pIn, sizeIn, sizeAnswer, port_, sizeOD, pOD, cks));
+    deviceConnection = retValue;
+    pdclass.write_pd_storage(PDView(pIn, sizeIn), retValue == SUCCESS);
+    if (retValue == SUCCESS)
+    {
+        handleEventReply(mc, pOD, cks); // CONFIRM only advances on the reply of the write
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    nextEventMC
+//!*******************************************************************************
+//!  \brief        Returns the master command for the next PD cycle. While an
+//!                event is read out, the OD part of the cycle addresses the event
+//!                memory on the diagnosis channel (one byte per cycle), otherwise
+//!                a plain PD read is sent. If the driver doesn't deliver the CKS
+//!                byte, the StatusCode is polled every eventPollCycles_ cycles.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       master command
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::nextEventMC()
+{
+    if (OnRequestData_ == 0)
+    {
+        return IOL::MC::PD_READ; // no OD, no event memory access possible
+    }
+    switch (eventReadout_.state)
+    {
+    case EventState::IDLE:
+        if (!eventReadout_.cksSeen && (eventPollCycles_ > 0) && (++eventReadout_.pollCounter >= eventPollCycles_))
         {
-            tmp1.resize(sizeAnswer);
+            eventReadout_.pollCounter = 0;
+            eventReadout_.state = EventState::READ_STATUS;
+            return uint8_t(IOL::MC::DIAG_READ | IOL::EVENT::STATUS_CODE);
         }
-        for (int i = 0; i < tmp1.size(); i++)
+        return IOL::MC::PD_READ;
+    case EventState::READ_STATUS:
+        return uint8_t(IOL::MC::DIAG_READ | IOL::EVENT::STATUS_CODE);
+    case EventState::READ_SLOT:
+        return uint8_t(IOL::MC::DIAG_READ | (1 + eventReadout_.slot * IOL::EVENT::SLOT_SIZE + eventReadout_.byte));
+    case EventState::CONFIRM:
+        return uint8_t(IOL::MC::DIAG_WRITE | IOL::EVENT::STATUS_CODE);
+    default:
+        eventReadout_.state = EventState::IDLE;
+        return IOL::MC::PD_READ;
+    }
+}
+
+//!*******************************************************************************
+//!  function :    handleEventReply
+//!*******************************************************************************
+//!  \brief        Evaluates the event flag and the OD byte of a successful PD
+//!                cycle and advances the event readout. Complete events are put
+//!                into the event queue of the port.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   mc                   master command of the cycle
+//!  \param[in]	   *pOD                 OD bytes of the answer
+//!  \param[in]	   cks                  CKS byte of the answer, -1 if not available
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::handleEventReply(uint8_t mc, const uint8_t *pOD, int16_t cks)
+{
+    if (OnRequestData_ == 0)
+    {
+        return;
+    }
+    if (cks >= 0)
+    {
+        eventReadout_.cksSeen = true;
+        if ((eventReadout_.state == EventState::IDLE) && (cks & IOL::EVENT::CKS_EVENT_FLAG))
         {
-            // cout<<"Daten: "<<int(tmp1[i])<<endl;
+            eventReadout_.state = EventState::READ_STATUS;
+            return;
         }
+    }
+    if (mc == IOL::MC::PD_READ)
+    {
+        return;
+    }
 
-        for (uint8_t i = 0; i < sizeAnswer; i++)
+    switch (eventReadout_.state)
+    {
+    case EventState::READ_STATUS:
+    {
+        uint8_t status = pOD[0];
+        if (status & IOL::EVENT::STATUS_DETAILS)
         {
-            auto tmp = tmp1.at(i);
-            pOut.push_back(tmp);
+            eventReadout_.slots = uint8_t(status & IOL::EVENT::STATUS_SLOTS);
+            eventReadout_.slot = 0;
+            eventReadout_.byte = 0;
+            while ((eventReadout_.slot < IOL::EVENT::SLOT_COUNT) && !(eventReadout_.slots & (1u << eventReadout_.slot)))
+            {
+                eventReadout_.slot++;
+            }
+            eventReadout_.state = (eventReadout_.slot < IOL::EVENT::SLOT_COUNT) ? EventState::READ_SLOT : EventState::CONFIRM;
         }
-        uint8_t *ppOut = &pOut[0];
-        // Send process data request to device
-        retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::PD_READ, uint8_t(ProcessDataOut_), ppOut, sizeAnswer, mSequenceType_, port_));
-        pOut.clear();
+        else if (status & IOL::EVENT::STATUS_CODE_TYPE1)
+        {
+            // legacy StatusCode type 1, the EventCode is in the StatusCode itself
+            IOLEvent event;
+            event.code = uint16_t(status & IOL::EVENT::STATUS_CODE_TYPE1);
+            pushEvent(event);
+            eventReadout_.state = EventState::CONFIRM;
+        }
+        else
+        {
+            eventReadout_.state = EventState::IDLE; // nothing pending
+        }
+        break;
     }
-    else
+    case EventState::READ_SLOT:
+        eventReadout_.entry[eventReadout_.byte] = pOD[0];
+        eventReadout_.byte++;
+        if (eventReadout_.byte >= IOL::EVENT::SLOT_SIZE)
+        {
+            IOLEvent event;
+            event.qualifier = eventReadout_.entry[0];
+            event.code = uint16_t((eventReadout_.entry[1] << 8) | eventReadout_.entry[2]);
+            pushEvent(event);
+            // next occupied slot
+            eventReadout_.byte = 0;
+            eventReadout_.slot++;
+            while ((eventReadout_.slot < IOL::EVENT::SLOT_COUNT) && !(eventReadout_.slots & (1u << eventReadout_.slot)))
+            {
+                eventReadout_.slot++;
+            }
+            if (eventReadout_.slot >= IOL::EVENT::SLOT_COUNT)
+            {
+                eventReadout_.state = EventState::CONFIRM;
+            }
+        }
+        break;
+    case EventState::CONFIRM:
+        eventReadout_.state = EventState::IDLE;
+        break;
+    default:
+        eventReadout_.state = EventState::IDLE;
+        break;
+    }
+}
+
+//!*******************************************************************************
+//!  function :    pushEvent
+//!*******************************************************************************
+//!  \brief        Timestamps an event and puts it into the event queue. If the
+//!                queue is full the event is dropped and counted.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   event                event read out of the device
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::pushEvent(IOLEvent &event)
+{
+    event.timestamp = uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count());
+    if (!eventQueue_.push(event))
     {
-        // Send process data request to devicec
-        retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::PD_READ, 0, nullptr, sizeAnswer, mSequenceType_, port_));
+        eventsDropped_++;
     }
-    pDriver_->wait_for(5);
-    // read received answer
-    retValue = uint8_t(retValue | pDriver_->readPD(pData, sizeAnswer, port_, OnRequestData_));
-    deviceConnection = retValue;
-    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    popEvent
+//!*******************************************************************************
+//!  \brief        Takes the oldest event out of the event queue. The queue has a
+//!                single consumer, either the publishing thread of the shield or
+//!                an IOLGenericDevice.
+//!
+//!  \type         local
+//!
+//!  \param[out]	   &event               oldest event
+//!
+//!  \return       true if an event was available
+//!
+//!*******************************************************************************
+bool IOLMasterPortMax14819::popEvent(IOLEvent &event)
+{
+    return eventQueue_.pop(event);
+}
+
+//!*******************************************************************************
+//!  function :    getEventsDropped
+//!*******************************************************************************
+//!  \brief        Number of events dropped because the event queue was full
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of dropped events
+//!
+//!*******************************************************************************
+uint32_t IOLMasterPortMax14819::getEventsDropped()
+{
+    return eventsDropped_;
+}
+
+//!*******************************************************************************
+//!  function :    setEventPollCycles
+//!*******************************************************************************
+//!  \brief        Sets after how many PD cycles the StatusCode is polled if the
+//!                event flag of the device messages isn't available. 0 disables
+//!                polling.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   cycles               number of PD cycles
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::setEventPollCycles(uint16_t cycles)
+{
+    eventPollCycles_ = cycles;
 }
 //!*******************************************************************************
 //!  function :    writePD
@@ -529,198 +903,537 @@ uint8_t IOLMasterPortMax14819::readPD(vector<uint8_t> &pData) // wird aktuell ve
 //!  \param[in]    sizeAnswer           size in byte of answer
 //!  \param[in]    mSeqType             M-sequence type
 //!
-//!  \return       0 if success
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer)
+{
+    uint8_t retValue = SUCCESS;
+    pDriver_->wait_for(10);
+    for (int i = 0; i < sizeData; i++)
+    {
+        // cout<<"Daten: "<<int(pData[i])<<endl;
+    }
+    retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::PAGE_WRITE, ProcessDataOut_ + OnRequestData_, pData, sizeAnswer, mSequenceType_, port_)); // Write Data with PAGE_WRITE MC because of PDValid
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    writeProcessDataOut
+//!*******************************************************************************
+//!  \brief        Sends the PDout latched for this cycle together with
+//!                PDOUT_VALID and acknowledges it
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::writeProcessDataOut()
+{
+    uint8_t frame[max14819::MAX_MSG_LENGTH] = {0};
+    if ((OnRequestData_ == 0) || ((ProcessDataOut_ + OnRequestData_ + 2) > max14819::MAX_MSG_LENGTH))
+    {
+        cout << "ERROR - Wrong PDout Length" << endl;
+        return ERROR;
+    }
+    bool matching = (pdOutCycle_.length == ProcessDataOut_);
+    if (matching)
+    {
+        loadProcessDataOut(frame); // otherwise no matching PDout written yet, send zeros
+    }
+    frame[ProcessDataOut_] = IOL::MC::PDOUT_VALID;
+    uint8_t retValue = writePD(uint8_t(ProcessDataOut_ + OnRequestData_), frame, 2); // answer: MC + CKS
+    if ((retValue == SUCCESS) && matching)
+    {
+        confirmProcessDataOut();
+    }
+    return retValue;
+}
+//!*******************************************************************************
+//!  function :    readISDU
+//!*******************************************************************************
+//!  \brief        The readISDU service is used to read On-request Data from a
+//!                Device connected to a specific port
+//!
+//!  \type         local
+//!
+//!  \param[out]    &oData              reference of the data read
+//!  \param[in]     index	            index of register
+//!  \param[in]     subIndex            subindex of register
+//!
+//!  \return        0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readISDU(vector<uint8_t> &oData, uint16_t index, uint8_t subIndex)
+{
+    uint8_t sizeData = 0;
+    oData.resize(IOL::ISDU::MAX_LENGTH);
+    uint8_t retValue = readISDU(oData.data(), uint8_t(oData.size()), sizeData, index, subIndex);
+    oData.resize(sizeData);
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    readISDU
+//!*******************************************************************************
+//!  \brief        The readISDU service is used to read On-request Data from a
+//!                Device connected to a specific port. The data is streamed
+//!                segment by segment into the caller supplied buffer, ISDU
+//!                framing (I-Service, extended length, CHKPDU) is stripped on
+//!                the fly. Supports the full ISDU length of 238 bytes.
+//!
+//!  \type         local
+//!
+//!  \param[out]    *pBuffer            buffer for the data read
+//!  \param[in]     sizeBuffer          size of the buffer in byte
+//!  \param[out]    &sizeData           number of data bytes read
+//!  \param[in]     index	            index of register
+//!  \param[in]     subIndex            subindex of register
+//!
+//!  \return        0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readISDU(uint8_t *pBuffer, uint8_t sizeBuffer, uint8_t &sizeData, uint16_t index, uint8_t subIndex)
+{
+    uint8_t retValue = SUCCESS;
+    uint8_t isduDataFrame[IOL::ISDU::MAX_SHORT_LENGTH];
+    uint8_t iService = 0;
+
+    sizeData = 0;
+    isduErrorCode_ = 0;
+    uint8_t sizeFrame = buildISDUFrame(isduDataFrame, sizeof(isduDataFrame), false, index, subIndex, nullptr, 0);
+    if (sizeFrame == 0)
+    {
+        return ERROR;
+    }
+
+    //==== Send ISDU - Request to device -> ISDU Answer from device ====
+    retValue = uint8_t(retValue | sendISDU(isduDataFrame, sizeFrame));
+    if (retValue != SUCCESS)
+    {
+        return retValue;
+    }
+    retValue = uint8_t(retValue | receiveISDU(pBuffer, sizeBuffer, sizeData, iService));
+    if (retValue != SUCCESS)
+    {
+        sizeData = 0;
+        return retValue;
+    }
+    if ((iService >> 4) != IOL::ISDU::READ_RESP_POS)
+    {
+        if (((iService >> 4) == IOL::ISDU::READ_RESP_NEG) && (sizeData >= 2))
+        {
+            isduErrorCode_ = uint16_t((pBuffer[0] << 8) | pBuffer[1]); // ErrorCode, AdditionalCode
+        }
+        sizeData = 0;
+        return ERROR;
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    buildISDUFrame
+//!*******************************************************************************
+//!  \brief        Builds an ISDU request (I-Service, extended length if needed,
+//!                index, subindex, data and CHKPDU) in the given buffer
+//!
+//!  \type         local
+//!
+//!  \param[out]    *pFrame             buffer for the request
+//!  \param[in]     sizeFrame           size of the buffer in byte
+//!  \param[in]     write               true for a write request
+//!  \param[in]     index	            index of register
+//!  \param[in]     subIndex            subindex of register
+//!  \param[in]     *pData              data to write (write request only)
+//!  \param[in]     sizeData            size of data in byte
+//!
+//!  \return        length of the request, 0 if it doesn't fit
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::buildISDUFrame(uint8_t *pFrame, uint8_t sizeFrame, bool write, uint16_t index, uint8_t subIndex, const uint8_t *pData, uint8_t sizeData)
+{
+    uint8_t service = 0;
+    uint8_t sizeIndex = 0;
+
+    if (index < 256)
+    {
+        if (subIndex == 0) // subindex 0 is used to reference the entire data object
+        {
+            service = write ? IOL::ISDU::WRITE_REQ_8BIT : IOL::ISDU::READ_REQ_8BIT;
+            sizeIndex = 1;
+        }
+        else
+        {
+            service = write ? IOL::ISDU::WRITE_REQ_8BIT_SUB : IOL::ISDU::READ_REQ_8BIT_SUB;
+            sizeIndex = 2;
+        }
+    }
+    else
+    {
+        service = write ? IOL::ISDU::WRITE_REQ_16BIT : IOL::ISDU::READ_REQ_16BIT;
+        sizeIndex = 3;
+    }
+
+    uint16_t length = uint16_t(1 + sizeIndex + sizeData + 1); // I-Service, index, data, CHKPDU
+    bool extendedLength = (length > IOL::ISDU::MAX_SHORT_LENGTH);
+    if (extendedLength)
+    {
+        length++;
+    }
+    if ((length > IOL::ISDU::MAX_LENGTH) || (length > sizeFrame))
+    {
+        return 0;
+    }
+
+    uint8_t pos = 0;
+    if (extendedLength)
+    {
+        pFrame[pos++] = uint8_t((service << 4) | IOL::ISDU::EXT_LENGTH);
+        pFrame[pos++] = uint8_t(length);
+    }
+    else
+    {
+        pFrame[pos++] = uint8_t((service << 4) | length);
+    }
+    if (sizeIndex == 3)
+    {
+        pFrame[pos++] = uint8_t((index & 0xFF00) >> 8);
+    }
+    pFrame[pos++] = uint8_t(index & 0x00FF);
+    if (sizeIndex >= 2)
+    {
+        pFrame[pos++] = subIndex;
+    }
+    for (uint8_t i = 0; i < sizeData; i++)
+    {
+        pFrame[pos++] = pData[i];
+    }
+    // Calculate Checksum
+    uint8_t chkpdu = 0;
+    for (uint8_t i = 0; i < pos; i++)
+    {
+        chkpdu ^= pFrame[i];
+    }
+    pFrame[pos++] = chkpdu;
+    return pos;
+}
+
+//!*******************************************************************************
+//!  function :    sendISDU
+//!*******************************************************************************
+//!  \brief        Sends an ISDU request segment by segment. The first segment is
+//!                sent with FlowCtrl START, the following ones with the FlowCtrl
+//!                counter which wraps from 15 to 0.
+//!
+//!  \type         local
+//!
+//!  \param[in]     *pFrame             ISDU request
+//!  \param[in]     sizeFrame           length of the request
+//!
+//!  \return        0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::sendISDU(const uint8_t *pFrame, uint8_t sizeFrame)
+{
+    uint8_t retValue = SUCCESS;
+    uint8_t segment[max14819::MAX_MSG_LENGTH];
+
+    if ((OnRequestData_ == 0) || ((ProcessDataOut_ + OnRequestData_ + 2) > max14819::MAX_MSG_LENGTH))
+    {
+        return ERROR;
+    }
+    loadProcessDataOut(segment); // PDout stays valid while the ISDU is transferred
+
+    uint8_t segments = uint8_t((sizeFrame + OnRequestData_ - 1) / OnRequestData_);
+    for (uint8_t i = 0; i < segments; i++)
+    {
+        for (uint8_t j = 0; j < OnRequestData_; j++)
+        {
+            uint16_t pos = uint16_t(i * OnRequestData_ + j);
+            segment[ProcessDataOut_ + j] = (pos < sizeFrame) ? pFrame[pos] : 0x00u; // fill up the last segment
+        }
+        uint8_t mc = (i == 0) ? IOL::MC::OD_WRITE : uint8_t(IOL::MC::OD_FLOWCTRL + (i & 0x0F));
+        retValue = uint8_t(retValue | pDriver_->writeISDU(mc, 0, mSequenceType_, port_, segment, uint8_t(ProcessDataOut_ + OnRequestData_)));
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    receiveISDU
+//!*******************************************************************************
+//!  \brief        Receives an ISDU response. Polls with FlowCtrl START while the
+//!                device is busy, then reads the remaining segments with the
+//!                wrapping FlowCtrl counter. The data part is written directly
+//!                into the caller buffer, the CHKPDU is validated.
+//!
+//!  \type         local
+//!
+//!  \param[out]    *pBuffer            buffer for the data part of the response
+//!  \param[in]     sizeBuffer          size of the buffer in byte
+//!  \param[out]    &sizeData           number of data bytes received
+//!  \param[out]    &iService           I-Service byte of the response
+//!
+//!  \return        0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::receiveISDU(uint8_t *pBuffer, uint8_t sizeBuffer, uint8_t &sizeData, uint8_t &iService)
+{
+    uint8_t retValue = SUCCESS;
+    uint8_t pdOut[max14819::MAX_MSG_LENGTH];
+    uint8_t segment[max14819::MAX_MSG_LENGTH];
+    uint8_t sizeAnswer = uint8_t(ProcessDataIn_ + OnRequestData_);
+    uint8_t timeout = 0;
+
+    if ((OnRequestData_ == 0) || (sizeAnswer > max14819::MAX_MSG_LENGTH))
+    {
+        return ERROR;
+    }
+    loadProcessDataOut(pdOut);
+
+    // Receive first segment, device answers with NO_SERVICE/BUSY until the response is ready
+    do
+    {
+        retValue = pDriver_->writeData(IOL::MC::OD_READ, ProcessDataOut_, pdOut, sizeAnswer, mSequenceType_, port_);
+        pDriver_->waitForAnswer(port_, sizeAnswer, 5);
+        retValue = uint8_t(retValue | pDriver_->readISDU(segment, OnRequestData_, port_));
+        timeout++;
+        if (timeout >= 254)
+            return ERROR; // timeout, if device doesn't respond
+    } while ((segment[0] == IOL::ISDU::NO_SERVICE) || (segment[0] == IOL::ISDU::BUSY));
+
+    // vector oData in Format: (iService+length) [extended length] (Data in Bytes....) (Checksum)
+    uint16_t length = 0;     // length of the complete ISDU, known after the header
+    uint8_t sizeHeader = 1;  // I-Service [+ extended length]
+    uint16_t pos = 0;        // position in the complete ISDU
+    uint8_t chkpdu = 0;
+    bool overflow = false;
+    uint8_t flowCtrl = 1;
+
+    while (true)
+    {
+        for (uint8_t i = 0; i < OnRequestData_; i++)
+        {
+            uint8_t value = segment[i];
+            if (pos == 0)
+            {
+                iService = value;
+                if ((value & 0x0F) == IOL::ISDU::EXT_LENGTH)
+                {
+                    sizeHeader = 2;
+                }
+                else
+                {
+                    length = value & 0x0F;
+                }
+            }
+            else if ((pos == 1) && (sizeHeader == 2))
+            {
+                length = value;
+            }
+            else if (pos >= length)
+            {
+                break; // fill bytes of the last segment
+            }
+            else if (pos < length - 1)
+            {
+                uint16_t posData = uint16_t(pos - sizeHeader);
+                if (posData < sizeBuffer)
+                {
+                    pBuffer[posData] = value;
+                }
+                else
+                {
+                    overflow = true;
+                }
+            }
+            chkpdu ^= value;
+            pos++;
+            if ((pos == sizeHeader) && ((length <= sizeHeader) || (length > IOL::ISDU::MAX_LENGTH)))
+            {
+                return ERROR; // invalid length
+            }
+        }
+        if ((pos >= sizeHeader) && (pos >= length))
+        {
+            break;
+        }
+        // Receive next segment
+        retValue = uint8_t(retValue | pDriver_->writeData(uint8_t(IOL::MC::OD_READ_FLOWCTRL + (flowCtrl & 0x0F)), ProcessDataOut_, pdOut, sizeAnswer, mSequenceType_, port_));
+        pDriver_->waitForAnswer(port_, sizeAnswer, 15);
+        retValue = uint8_t(retValue | pDriver_->readISDU(segment, OnRequestData_, port_));
+        flowCtrl++;
+    }
+
+    if (chkpdu != 0)
+    {
+        pDriver_->Serial_Write("ISDU checksum error\n");
+        return ERROR;
+    }
+    if (overflow)
+    {
+        return ERROR;
+    }
+    sizeData = uint8_t(length - sizeHeader - 1);
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    loadProcessDataOut
+//!*******************************************************************************
+//!  \brief        Copies the PDout latched for this cycle into a message buffer
+//!                (zero padded to the PDout length of the device)
+//!
+//!  \type         local
+//!
+//!  \param[out]    *pData              message buffer
+//!
+//!  \return        void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::loadProcessDataOut(uint8_t *pData)
+{
+    for (uint8_t i = 0; i < ProcessDataOut_; i++)
+    {
+        pData[i] = (i < pdOutCycle_.length) ? pdOutCycle_.data[i] : 0;
+    }
+}
+
+//!*******************************************************************************
+//!  function :    confirmProcessDataOut
+//!*******************************************************************************
+//!  \brief        Acknowledges the latched PDout after it has been sent
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
 //!
 //!*******************************************************************************
-uint8_t IOLMasterPortMax14819::writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer)
+void IOLMasterPortMax14819::confirmProcessDataOut()
 {
-    uint8_t retValue = SUCCESS;
-    pDriver_->wait_for(10);
-    for (int i = 0; i < sizeData; i++)
+    if (ProcessDataOut_ > 0)
     {
-        // cout<<"Daten: "<<int(pData[i])<<endl;
+        pdclass.confirm_procDataOut(pdOutCycle_, pdTimestamp());
     }
-    retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::PAGE_WRITE, ProcessDataOut_ + OnRequestData_, pData, sizeAnswer, mSequenceType_, port_)); // Write Data with PAGE_WRITE MC because of PDValid
-    return retValue;
 }
+
 //!*******************************************************************************
-//!  function :    readISDU
+//!  function :    readISDUCached
 //!*******************************************************************************
-//!  \brief        The readISDU service is used to write On-request Data to a
-//!                Device connected to a specific port
+//!  \brief        Reads static parameters (identification data and registered
+//!                read-only indices) out of the parameter cache. On a miss the
+//!                parameter is read from the device and stored. After every
+//!                device detection the serial number is read once to verify the
+//!                cached data belongs to the connected device.
+//!                Other indices are passed through to readISDU.
 //!
 //!  \type         local
 //!
-//!  \param[in]     *data               pointer to transmit data
+//!  \param[out]    &oData              reference of the parameter data
 //!  \param[in]     index	            index of register
 //!  \param[in]     subIndex            subindex of register
 //!
 //!  \return        0 if success
 //!
 //!*******************************************************************************
-uint8_t IOLMasterPortMax14819::readISDU(vector<uint8_t> &oData, uint16_t index, uint8_t subIndex)
+uint8_t IOLMasterPortMax14819::readISDUCached(vector<uint8_t> &oData, uint16_t index, uint8_t subIndex)
 {
-    uint8_t sizeAnswer = 32;
     uint8_t retValue = SUCCESS;
-    uint8_t iService = 0;
-    uint8_t highIndex = (index & 0xFF00) >> 8;
-    uint8_t lowIndex = index & 0x00FF;
-    vector<uint8_t> isduDataFrame;
-    if (index < 256)
+
+    if (!paramCache_.isCacheable(index, subIndex))
     {
-        if (subIndex == 0) // subindex 0 is used to reference the entire data object
-        {
-            cout << "8 Bit" << endl;
-            iService = uint8_t((IOL::ISDU::READ_REQ_8BIT << 4) + 0x3u);
-            cout << "\nvar 1 iService: " << int(iService) << endl;
-            isduDataFrame.push_back(iService);
-            isduDataFrame.push_back(lowIndex);
-        }
-        else
+        return readISDU(oData, index, subIndex);
+    }
+    if (!paramCache_.isSerialVerified())
+    {
+        vector<uint8_t> serialNumber;
+        retValue = readISDU(serialNumber, IOL::INDEX::SERIAL_NUMBER, 0);
+        if (retValue != SUCCESS)
         {
-            cout << "8 Bit + Subindex" << endl;
-            iService = uint8_t((IOL::ISDU::READ_REQ_8BIT_SUB << 4) + 0x4u);
-            cout << "\nvar 2 iService: " << int(iService) << endl;
-            isduDataFrame.push_back(iService);
-            isduDataFrame.push_back(lowIndex);
-            isduDataFrame.push_back(subIndex);
+            return retValue;
         }
+        paramCache_.verifySerialNumber(serialNumber);
     }
-    else
+    if (paramCache_.lookup(index, subIndex, oData))
     {
-        cout << "16 Bit + Subindex" << endl;
-        iService = uint8_t((IOL::ISDU::READ_REQ_16BIT << 4) + 0x5u);
-        cout << "\nvar 3 iService: " << int(iService) << endl;
-        isduDataFrame.push_back(iService);
-        isduDataFrame.push_back(highIndex);
-        isduDataFrame.push_back(lowIndex);
-        isduDataFrame.push_back(subIndex);
+        return SUCCESS;
     }
-    // Calculate Checksum
-    uint8_t chkpdu = pDriver_->calculateCHKPDU(isduDataFrame);
-    isduDataFrame.push_back(chkpdu);
-    cout << "chkpdu: " << int(chkpdu) << endl;
-    int8_t byte2send = OnRequestData_ - isduDataFrame.size(); //-ProcessDataOut_;
-    if (byte2send < 0)
-        byte2send = 0;
-    cout << "byte2send: " << int(byte2send) << endl;
-    for (uint8_t i = 0; i < byte2send; i++)
+    oData.clear();
+    retValue = readISDU(oData, index, subIndex);
+    if (retValue == SUCCESS)
     {
-        isduDataFrame.push_back(0x00u);
-        cout << "bufferauffüllen: 0x00" << endl;
+        paramCache_.store(index, subIndex, oData);
     }
+    return retValue;
+}
 
-    vector<uint8_t> pdout;
-    pdout = get_PDclass()->get_procDataOut();
-    uint8_t *pdoutptr = &pdout[0];
-
-    //==== Send ISDU - Request to device -> ISDU Answer from device ====
-
-    uint8_t zaehlvar = 0;
-    uint8_t timeout = 0;
-    vector<uint8_t> vectortosend;
-    cout << "isduDataFramesize(): " << int(isduDataFrame.size()) << endl;
-
-    // Send request to device
-    while (((zaehlvar)*OnRequestData_) < (isduDataFrame.size())) // Send Request to device
+//!*******************************************************************************
+//!  function :    lookupCachedISDU
+//!*******************************************************************************
+//!  \brief        Looks the parameter up in the parameter cache without any
+//!                communication, so it can be called without the driver lock.
+//!                Only served while a device is connected and its serial
+//!                number has been verified, otherwise the cache could belong
+//!                to another device.
+//!
+//!  \type         local
+//!
+//!  \param[out]    &oData              reference of the parameter data
+//!  \param[in]     index	            index of register
+//!  \param[in]     subIndex            subindex of register
+//!
+//!  \return        true on a cache hit
+//!
+//!*******************************************************************************
+bool IOLMasterPortMax14819::lookupCachedISDU(vector<uint8_t> &oData, uint16_t index, uint8_t subIndex)
+{
+    if ((get_DeviceConnection() != 0) || !paramCache_.isSerialVerified())
     {
-        // cout<<"WhileSchleife"<<endl;
-        vectortosend.clear();
-        for (uint8_t i = 0; i < ProcessDataOut_; i++)
-        {
-            //  cout<<"PDOUT!!!!"<<endl;
-            vectortosend.push_back(uint8_t(0x00));
-        }
-        for (uint8_t i = 0; i < OnRequestData_; i++)
-        {
-            // cout<<"Forschleife"<<endl;
-            vectortosend.push_back(isduDataFrame[((zaehlvar * OnRequestData_) + i)]); // Send as much Data as the device can send
-            // cout<<"vectorzugriff erfolgreich"<<endl;
-        }
-        if (zaehlvar == 0)
-        {
-            //  cout<<"ifbedingung"<<endl;
-            // cout<<"vectortosend.size(): "<<int(vectortosend.size())<<endl;
-            retValue = uint8_t(retValue | pDriver_->writeISDU(IOL::MC::OD_WRITE, 0, mSequenceType_, port_, vectortosend, ProcessDataOut_, isduDataFrame));
-            pDriver_->wait_for(5);
-        }
-        else
-        {
-            // cout<<"elseBedingung"<<endl;
-            // cout<<"vectortosend.size(): "<<int(vectortosend.size())<<endl;
-            retValue = uint8_t(retValue | pDriver_->writeISDU(uint8_t(IOL::MC::OD_FLOWCTRL + zaehlvar), 0, mSequenceType_, port_, vectortosend, ProcessDataOut_, isduDataFrame));
-            pDriver_->wait_for(5);
-        }
-        vectortosend.clear();
-        if (zaehlvar == 15)
-        {
-            if (timeout >= 3)
-                return retValue = ERROR; // Timeout löst aus
-            timeout++;
-            zaehlvar = 0;
-        }
-        else
-        {
-            zaehlvar++;
-        }
+        return false;
     }
-    timeout = 0;
-    // cout<<"try to receive Data"<<endl;
-    // Receive data from device
-    do
-    {
-        //  cout<<"in der whileschleife"<<endl;
-        oData.clear();
-
-        if (ProcessDataOut_)
-        {
-            retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::OD_READ, pdout.size(), pdoutptr, sizeAnswer, mSequenceType_, port_));
-        }
-        else
-        {
-            retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::OD_READ, 0, nullptr, sizeAnswer, mSequenceType_, port_));
-        }
-        pDriver_->wait_for(5);
-
-        retValue = uint8_t(retValue | pDriver_->readISDU(oData, OnRequestData_, port_));
-
-        timeout++;
-        //  cout<<int(timeout)<<endl;
-        if (timeout >= 254)
-            return retValue = ERROR; // timeout, if device doesn't respond 0 or 1
-
-    } while (oData[0] == 1 || oData[0] == 0);
+    return paramCache_.lookup(index, subIndex, oData);
+}
 
-    sizeAnswer = uint8_t(oData[0] & 0xF);
+//!*******************************************************************************
+//!  function :    processISDUBatch
+//!*******************************************************************************
+//!  \brief        Executes a list of ISDU read/write requests back-to-back.
+//!                The caller has to hold the driver lock or the claim of the
+//!                port for the whole batch.
+//!                Every request gets its own status, a failing request does not
+//!                abort the batch.
+//!
+//!  \type         local
+//!
+//!  \param[in,out] &requests           list of requests, data and status are
+//!                                     filled in for every request
+//!
+//!  \return        0 if all requests succeeded
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::processISDUBatch(vector<IsduRequest> &requests)
+{
+    uint8_t retValue = SUCCESS;
 
-    int loops = sizeAnswer / OnRequestData_;
-    if (loops < 0)
-        loops = 0;
-    //  cout<<"loops: "<<int(loops)<<endl;
-    for (int i = 0; i < loops; i++)
+    for (auto &request : requests)
     {
-        if (ProcessDataOut_)
+        if (request.write)
         {
-            retValue = uint8_t(retValue | pDriver_->writeData((225 + i), pdout.size(), pdoutptr, sizeAnswer, mSequenceType_, port_));
+            request.status = writeISDU(uint8_t(request.data.size()), request.data, request.index, request.subIndex);
         }
         else
         {
-            retValue = uint8_t(retValue | pDriver_->writeData((225 + i), 0, nullptr, sizeAnswer, mSequenceType_, port_));
+            request.data.clear();
+            request.status = readISDUCached(request.data, request.index, request.subIndex);
         }
-        pDriver_->wait_for(15);
-        retValue = uint8_t(retValue | pDriver_->readISDU(oData, uint8_t(OnRequestData_), port_));
+        request.errorCode = (request.status == SUCCESS) ? 0 : isduErrorCode_;
+        retValue = uint8_t(retValue | request.status);
     }
-
-    // vector oData in Format: (iService+length) (Data in Bytes....) (Checksum)
-
-    oData.erase(oData.begin() + sizeAnswer - 1); // erase iService+length
-    oData.erase(oData.begin());                  // erase Checksum
-
-    // vector oData in Format: (Data in Bytes.....)
-
     return retValue;
-
-    //}
 }
 
 //!*******************************************************************************
@@ -731,167 +1444,183 @@ uint8_t IOLMasterPortMax14819::readISDU(vector<uint8_t> &oData, uint16_t index,
 //!
 //!  \type         local
 //!
-//!  \param[in]     uint8_t mc			master command
 //!  \param[in]     sizeData	        size in Byte of data
-//!  \param[in]     *data               pointer to transmit data
-//!  \param[in]     sizeAnswer	        size in byte of answer
-//!  \param[in]     mSeqType            m-sequence type depending
-//!  \param[in]     port		        port to send data
+//!  \param[in]     &oData              reference of the data to write
+//!  \param[in]     index	            index of register
+//!  \param[in]     subIndex            subindex of register
 //!
 //!  \return        0 if success
 //!
 //!*******************************************************************************
 uint8_t IOLMasterPortMax14819::writeISDU(uint8_t sizeData, vector<uint8_t> &oData, uint16_t index, uint8_t subIndex)
 {
-    uint8_t sizeAnswer = ProcessDataIn_; // CKS
-    uint8_t retValue = SUCCESS;
-    uint8_t iService = 0;
-    uint8_t highIndex = (index & 0xFF00) >> 8;
-    uint8_t lowIndex = index & 0x00FF;
-    vector<uint8_t> isduDataFrame;
-    if (index < 256)
+    if (sizeData > oData.size())
     {
-        if (subIndex == 0) // subindex 0 is used to reference the entire data object
-        {
-            // sizeAnswer=2;
-            // cout << "8 Bit" << endl;
-            iService = uint8_t((IOL::ISDU::WRITE_REQ_8BIT << 4) + sizeData + 0x3u);
-            // cout<<"\nvar 1 iService: "<<int(iService)<<endl;
-            isduDataFrame.push_back(iService);
-            isduDataFrame.push_back(lowIndex);
-        }
-        else
-        {
-            // sizeAnswer=4;
-            // cout << "8 Bit + Subindex" << endl;
-            iService = uint8_t((IOL::ISDU::WRITE_REQ_8BIT_SUB << 4) + sizeData + 0x4u);
-            // cout<<"\nvar 2 iService: "<<int(iService)<<endl;
-            isduDataFrame.push_back(iService);
-            isduDataFrame.push_back(lowIndex);
-            isduDataFrame.push_back(subIndex);
-        }
+        return ERROR;
     }
-    else
+    return writeISDU(oData.data(), sizeData, index, subIndex);
+}
+
+//!*******************************************************************************
+//!  function :    writeISDU
+//!*******************************************************************************
+//!  \brief        The AL_Write service is used to write On-request Data to a
+//!                Device connected to a specific port. Requests longer than 15
+//!                bytes are sent with extended length, up to the maximum ISDU
+//!                length of 238 bytes. The write response of the device is
+//!                evaluated.
+//!
+//!  \type         local
+//!
+//!  \param[in]     *pData              data to write
+//!  \param[in]     sizeData	        size in Byte of data
+//!  \param[in]     index	            index of register
+//!  \param[in]     subIndex            subindex of register
+//!
+//!  \return        0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::writeISDU(const uint8_t *pData, uint8_t sizeData, uint16_t index, uint8_t subIndex)
+{
+    uint8_t retValue = SUCCESS;
+    uint8_t isduDataFrame[IOL::ISDU::MAX_LENGTH];
+    uint8_t response[4];
+    uint8_t sizeResponse = 0;
+    uint8_t iService = 0;
+
+    isduErrorCode_ = 0;
+    paramCache_.invalidate(index, subIndex); // e.g. the application specific tag is writable
+    uint8_t sizeFrame = buildISDUFrame(isduDataFrame, sizeof(isduDataFrame), true, index, subIndex, pData, sizeData);
+    if (sizeFrame == 0)
     {
-        // cout << "16 Bit + Subindex" << endl;
-        iService = uint8_t((IOL::ISDU::WRITE_REQ_16BIT << 4) + sizeData + 0x5u);
-        // cout<<"\nvar 3 iService: "<<int(iService)<<endl;
-        isduDataFrame.push_back(iService);
-        isduDataFrame.push_back(highIndex);
-        isduDataFrame.push_back(lowIndex);
-        isduDataFrame.push_back(subIndex);
+        pDriver_->Serial_Write("writeISDU: data to long\n");
+        return ERROR;
     }
 
-    // get Data in the isduDataFrame
-    for (int i = 0; i < oData.size(); i++)
+    //==== Send ISDU - Request to device -> ISDU Answer from device ====
+    retValue = uint8_t(retValue | sendISDU(isduDataFrame, sizeFrame));
+    if (retValue != SUCCESS)
     {
-        isduDataFrame.push_back(oData[i]);
-        // cout<<"oData: "<<int(oData[i])<<endl;
+        return retValue;
     }
-    // Calculate Checksum
-    uint8_t chkpdu = pDriver_->calculateCHKPDU(isduDataFrame);
-    isduDataFrame.push_back(chkpdu);
-    // cout<<"chkpdu: "<<int(chkpdu)<<endl;
-    int8_t byte2send = OnRequestData_ - isduDataFrame.size(); //-ProcessDataOut_;
-    if (byte2send < 0)
-        byte2send = 0;
-    // cout<<"byte2send: "<<int(byte2send)<<endl;
-    for (uint8_t i = 0; i < byte2send; i++)
+    retValue = uint8_t(retValue | receiveISDU(response, sizeof(response), sizeResponse, iService));
+    if (retValue != SUCCESS)
     {
-        isduDataFrame.push_back(0x00u);
-        // cout<<"bufferauffüllen: 0x00"<<endl;
+        return retValue;
     }
-
-    vector<uint8_t> pdout;
-    pdout = get_PDclass()->get_procDataOut();
-    uint8_t *pdoutptr = &pdout[0];
-
-    //==== Send ISDU - Request to device -> ISDU Answer from device ====
-
-    uint8_t zaehlvar = 0;
-    uint8_t timeout = 0;
-    vector<uint8_t> vectortosend;
-    // cout<<"isduDataFramesize(): "<<int(isduDataFrame.size())<<endl;
-
-    // Send request to device
-    while (((zaehlvar)*OnRequestData_) < (isduDataFrame.size())) // Send Request to device
+    if ((iService >> 4) != IOL::ISDU::WRITE_RESP_POS)
     {
-        // cout<<"WhileSchleife"<<endl;
-        vectortosend.clear();
-        for (uint8_t i = 0; i < ProcessDataOut_; i++)
-        {
-            // cout<<"PDOUT!!!!"<<endl;
-            vectortosend.push_back(uint8_t(0x00));
-        }
-        for (uint8_t i = 0; i < OnRequestData_; i++)
-        {
-            // cout<<"Forschleife"<<endl;
-            vectortosend.push_back(isduDataFrame[((zaehlvar * OnRequestData_) + i)]); // Send as much Data as the device can send
-            // cout<<"vectorzugriff erfolgreich"<<endl;
-        }
-        if (zaehlvar == 0)
-        {
-            // cout<<"ifbedingung"<<endl;
-            // cout<<"vectortosend.size(): "<<int(vectortosend.size())<<endl;
-            retValue = uint8_t(retValue | pDriver_->writeISDU(IOL::MC::OD_WRITE, 0, mSequenceType_, port_, vectortosend, ProcessDataOut_, isduDataFrame));
-            pDriver_->wait_for(5);
-        }
-        else
-        {
-            // cout<<"elseBedingung"<<endl;
-            // cout<<"vectortosend.size(): "<<int(vectortosend.size())<<endl;
-            retValue = uint8_t(retValue | pDriver_->writeISDU(uint8_t(IOL::MC::OD_FLOWCTRL + zaehlvar), 0, mSequenceType_, port_, vectortosend, ProcessDataOut_, isduDataFrame));
-            pDriver_->wait_for(5);
-        }
-        vectortosend.clear();
-        if (zaehlvar == 15)
-        {
-            if (timeout >= 3)
-                return retValue = ERROR; // Timeout löst aus
-            timeout++;
-            zaehlvar = 0;
-        }
-        else
+        if (((iService >> 4) == IOL::ISDU::WRITE_RESP_NEG) && (sizeResponse >= 2))
         {
-            zaehlvar++;
+            isduErrorCode_ = uint16_t((response[0] << 8) | response[1]); // ErrorCode, AdditionalCode
         }
+        return ERROR;
     }
-    timeout = 0;
     return retValue;
 }
 
 //!*******************************************************************************
-//!  function :    readDirectParameterPage
+//!  function :    getIsduErrorCode
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Returns ErrorCode and AdditionalCode of the last negative ISDU
+//!                response (0 if the last request was successful)
 //!
 //!  \type         local
 //!
 //!  \param[in]	   void
 //!
-//!  \return       void
+//!  \return       (ErrorCode << 8) | AdditionalCode
+//!
+//!*******************************************************************************
+uint16_t IOLMasterPortMax14819::getIsduErrorCode()
+{
+    return isduErrorCode_;
+}
+
+//!*******************************************************************************
+//!  function :    readDirectParameterPage
+//!*******************************************************************************
+//!  \brief        Reads a single byte of the direct parameter page 1
+//!
+//!  \type         local
+//!
+//!  \param[in]	   address              address on the page (0x00 - 0x1F)
+//!  \param[out]   *pData               pointer to the read byte
+//!
+//!  \return       0 if success
 //!
 //!*******************************************************************************
 uint8_t IOLMasterPortMax14819::readDirectParameterPage(uint8_t address, uint8_t *pData)
 {
-    if (address > 31)
+    return readDirectParameterPage(address, 1, pData);
+}
+
+//!*******************************************************************************
+//!  function :    readDirectParameterPage
+//!*******************************************************************************
+//!  \brief        Reads a range of the direct parameter page 1. In STARTUP the
+//!                device only supports M-sequence TYPE_0 (one byte per
+//!                M-sequence), so the page is read with one M-sequence per
+//!                address, issued back-to-back: every answer is polled out of
+//!                the receive FIFO as soon as it has arrived instead of waiting
+//!                a fixed delay per byte. The bytes read are mirrored in
+//!                directParameterPage_.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   address              first address on the page
+//!  \param[in]	   count                number of bytes to read
+//!  \param[out]   *pData               buffer for count bytes
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readDirectParameterPage(uint8_t address, uint8_t count, uint8_t *pData)
+{
+    if ((address + count) > 32)
     {
         pDriver_->Serial_Write("readDirectParameterPage: address to big\n");
-        return 0;
+        return ERROR;
     }
     uint8_t retValue = SUCCESS;
 
-    // Send processdata request to device
-    retValue = uint8_t(retValue | pDriver_->writeData((IOL::MC::PAGE_READ + address), 0, nullptr, 1, IOL::M_TYPE_0, port_));
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t pageAddress = uint8_t(address + i);
+        // Send page request to device
+        retValue = uint8_t(retValue | pDriver_->writeData(uint8_t(IOL::MC::PAGE_READ + pageAddress), 0, nullptr, 1, IOL::M_TYPE_0, port_));
 
-    pDriver_->wait_for(10);
+        // Poll for the answer, timeout is the former fixed delay
+        pDriver_->waitForAnswer(port_, 1, 10);
 
-    // Receive answer
-    retValue = uint8_t(retValue | pDriver_->readData(pData, 1, port_));
+        // Receive answer
+        retValue = uint8_t(retValue | pDriver_->readData(&pData[i], 1, port_));
+        if (pageAddress < sizeof(directParameterPage_))
+        {
+            directParameterPage_[pageAddress] = pData[i];
+        }
+    }
 
     return retValue;
 }
 
+//!*******************************************************************************
+//!  function :    getDirectParameterPage
+//!*******************************************************************************
+//!  \brief        Returns the direct parameter page 1 as read during begin()
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       pointer to the 16 bytes of the page
+//!
+//!*******************************************************************************
+const uint8_t *IOLMasterPortMax14819::getDirectParameterPage()
+{
+    return directParameterPage_;
+}
+
 //!*******************************************************************************
 //!  function :    portHandler
 //!*******************************************************************************
@@ -952,121 +1681,245 @@ void IOLMasterPortMax14819::sendMCmd()
 //!  \return       communication speed
 //!
 //!*******************************************************************************
-uint32_t IOLMasterPortMax14819::readComSpeed()
-{
-    return comSpeed_;
-}
+uint32_t IOLMasterPortMax14819::readComSpeed()
+{
+    return comSpeed_;
+}
+
+//!*******************************************************************************
+//!  function :    readPage
+//!*******************************************************************************
+//!  \brief        Not implemented yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::readPage()
+{
+}
+
+//!*******************************************************************************
+//!  function :    writePage
+//!*******************************************************************************
+//!  \brief        Not implemented yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::writePage()
+{
+}
+
+//!*******************************************************************************
+//!  function :    readISDU
+//!*******************************************************************************
+//!  \brief        Not implemented yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+// void IOLMasterPortMax14819::readISDU() {
+//
+// }
+
+//!*******************************************************************************
+//!  function :    writeISDU
+//!*******************************************************************************
+//!  \brief        Not implemented yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+// void IOLMasterPortMax14819::writeISDU() {
+//
+// }
 
 //!*******************************************************************************
-//!  function :    readPage
+//!  function :    readDI
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the level of the DI line
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]	   &level               HIGH or LOW
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::readPage()
+uint8_t IOLMasterPortMax14819::readDI(uint8_t &level)
 {
+    level = pDriver_->readDI(port_);
+    return SUCCESS;
 }
 
 //!*******************************************************************************
-//!  function :    writePage
+//!  function :    readCQ
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Reads the level of the CQ line, only valid in SIO mode
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]	   &level               HIGH or LOW
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::writePage()
+uint8_t IOLMasterPortMax14819::readCQ(uint8_t &level)
 {
+    uint16_t mode = portMode_.read();
+    if ((mode != IOL::PORT_MODE::SIO_INPUT) && (mode != IOL::PORT_MODE::SIO_OUTPUT))
+    {
+        return ERROR;
+    }
+    level = pDriver_->readCQ(port_);
+    return SUCCESS;
 }
 
 //!*******************************************************************************
-//!  function :    readISDU
+//!  function :    writeCQ
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Drives the CQ line, only possible in SIO output mode
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]	   level                HIGH or LOW
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-// void IOLMasterPortMax14819::readISDU() {
-//
-// }
+uint8_t IOLMasterPortMax14819::writeCQ(uint8_t level)
+{
+    if (portMode_.read() != IOL::PORT_MODE::SIO_OUTPUT)
+    {
+        return ERROR;
+    }
+    return pDriver_->writeCQ(port_, uint8_t(level ? 1 : 0)); // HIGH : LOW
+}
 
 //!*******************************************************************************
-//!  function :    writeISDU
+//!  function :    setPortMode
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Switches the port between IO-Link, SIO input, SIO output and
+//!                inactive. In SIO mode the CQ and DI sampling channels are
+//!                enabled, the sampling itself is done by the caller (IRQ
+//!                handler resp. polling thread).
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]	   mode                 IOL::PORT_MODE
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-// void IOLMasterPortMax14819::writeISDU() {
-//
-// }
+uint8_t IOLMasterPortMax14819::setPortMode(uint16_t mode)
+{
+    uint8_t retValue = SUCCESS;
+
+    sioCQ_.disable();
+    sioDI_.disable();
+    if ((portMode_.read() == IOL::PORT_MODE::IOLINK) && (deviceConnection == 0) && (mode != IOL::PORT_MODE::IOLINK))
+    {
+        // Send device fallback command before leaving IO-Link
+        retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::DEV_FALLBACK, 0, nullptr, 1, IOL::M_TYPE_0, port_));
+    }
+    switch (mode)
+    {
+    case IOL::PORT_MODE::IOLINK:
+        portMode_.write(mode);
+        return begin();
+    case IOL::PORT_MODE::SIO_INPUT:
+    case IOL::PORT_MODE::SIO_OUTPUT:
+        retValue = uint8_t(retValue | pDriver_->configureSIO(port_, (mode == IOL::PORT_MODE::SIO_OUTPUT) ? 1 : 0));
+        break;
+    case IOL::PORT_MODE::INACTIVE:
+        retValue = uint8_t(retValue | pDriver_->reset(port_));
+        break;
+    default:
+        return ERROR;
+    }
+    // no IO-Link device on this port any more
+    deviceConnection = 1;
+    lastDevice_.valid = false;
+    ProcessDataIn_ = 0;
+    ProcessDataOut_ = 0;
+    OnRequestData_ = 0;
+    portMode_.write(mode);
+    if (mode != IOL::PORT_MODE::INACTIVE)
+    {
+        if (mode == IOL::PORT_MODE::SIO_INPUT)
+        {
+            sioCQ_.enable(); // in output mode CQ is driven by the master
+        }
+        sioDI_.enable();
+    }
+    return retValue;
+}
 
 //!*******************************************************************************
-//!  function :    readDI
+//!  function :    getPortMode
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Returns the actual port mode
 //!
 //!  \type         local
 //!
 //!  \param[in]	   void
 //!
-//!  \return       void
+//!  \return       IOL::PORT_MODE
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::readDI()
+uint16_t IOLMasterPortMax14819::getPortMode()
 {
+    return portMode_.read();
 }
 
 //!*******************************************************************************
-//!  function :    readCQ
+//!  function :    get_SioCQ
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        get the sampling channel of the CQ line
 //!
 //!  \type         local
 //!
 //!  \param[in]	   void
 //!
-//!  \return       void
+//!  \return       SioChannel adress
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::readCQ()
+SioChannel *IOLMasterPortMax14819::get_SioCQ()
 {
+    return &sioCQ_;
 }
 
 //!*******************************************************************************
-//!  function :    writeCQ
+//!  function :    get_SioDI
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        get the sampling channel of the DI line
 //!
 //!  \type         local
 //!
 //!  \param[in]	   void
 //!
-//!  \return       void
+//!  \return       SioChannel adress
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::writeCQ()
+SioChannel *IOLMasterPortMax14819::get_SioDI()
 {
+    return &sioDI_;
 }
 
 //!*******************************************************************************
@@ -1089,14 +1942,18 @@ void IOLMasterPortMax14819::isDeviceConnected()
     uint32_t newDeviceID = 0;
     // cout<<"BEFORE if-Schleife:"<<endl;
     // check if there has been a device connected
-    if (deviceConnection == 0)
+    if (portMode_.read() != IOL::PORT_MODE::IOLINK)
+    {
+        // SIO or inactive, no IO-Link device expected
+    }
+    else if (deviceConnection == 0)
     {
         // cout<<"Device connected"<<endl;
     }
     else
     {
         // cout<<"Checking DeviceConnection..."<<endl;
-        retVal = begin(); // initialize port
+        retVal = reconnect(); // fast path if the last known device reappears, otherwise full initialization
     }
     return;
 }
@@ -1141,6 +1998,24 @@ PDclass *IOLMasterPortMax14819::get_PDclass()
 {
     return &pdclass;
 }
+
+//!*******************************************************************************
+//!  function :    get_ParameterCache
+//!*******************************************************************************
+//!  \brief        get the parameter cache of the port, e.g. to register further
+//!                read-only indices
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       ParameterCache adress
+//!
+//!*******************************************************************************
+ParameterCache *IOLMasterPortMax14819::get_ParameterCache()
+{
+    return &paramCache_;
+}
 // uint8_t IOLMasterPortMax14819::readCondition()
 //{
 
@@ -1154,13 +2029,14 @@ PDclass *IOLMasterPortMax14819::get_PDclass()
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]	   historyDepth         number of PD in frames kept in the history
 //!
 //!  \return       void
 //!
 //!*******************************************************************************
 
-PDclass::PDclass()
+PDclass::PDclass(size_t historyDepth)
+    : history(historyDepth)
 {
 }
 
@@ -1196,8 +2072,48 @@ PDclass::~PDclass()
 
 void PDclass::write_pd_storage(vector<uint8_t> PData)
 {
-    procData = PData;
+    // first byte defines the length of the data
+    if (!PData.empty())
+    {
+        write_pd_storage(PDView(PData).subspan(1), true);
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    write_pd_storage
+//!*******************************************************************************
+//!  \brief        Publishes a received PD frame for the readers. Called by the
+//!                cycle thread, readers never block it.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   pData                PD bytes
+//!  \param[in]	   valid                false if the frame had an error
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
 
+void PDclass::write_pd_storage(PDView pData, bool valid)
+{
+    uint64_t timestamp = pdTimestamp();
+    size_t length = pData.size();
+    if (length > PD_MAX_LENGTH)
+    {
+        length = PD_MAX_LENGTH;
+        valid = false;
+    }
+    PDSample stored;
+    procData.update([&](PDSample &sample)
+                    {
+                        sample.sequence++;
+                        sample.timestamp = timestamp;
+                        sample.length = uint8_t(length);
+                        sample.valid = valid ? 1 : 0;
+                        memcpy(sample.data, pData.data(), length);
+                        stored = sample; });
+    history.push(stored);
     return;
 }
 
@@ -1210,17 +2126,178 @@ void PDclass::write_pd_storage(vector<uint8_t> PData)
 //!
 //!  \param[in]	   vector<uint8_t> PDout
 //!
+//!  \return       sequence number of the update
+//!
+//!*******************************************************************************
+
+uint64_t PDclass::write_procDataOut(const vector<uint8_t> &PDout)
+{
+    uint64_t timestamp = pdTimestamp();
+    uint8_t length = uint8_t(min(PDout.size(), size_t(PD_MAX_LENGTH)));
+    uint64_t sequence = 0;
+    procDataOut.update([&](PDSample &sample)
+                       {
+                           sample.sequence++;
+                           sample.timestamp = timestamp;
+                           sample.length = length;
+                           sample.valid = (PDout.size() <= PD_MAX_LENGTH) ? 1 : 0;
+                           memcpy(sample.data, PDout.data(), length);
+                           sequence = sample.sequence; });
+    return sequence;
+}
+
+//!*******************************************************************************
+//!  function :    write_procDataOut
+//!*******************************************************************************
+//!  \brief        Packs values into the PD out to be sent. Fields without a
+//!                value keep their bits. The packing works on a copy, so the
+//!                cycle thread never waits for it. Read-modify-write: the
+//!                caller serializes the writers of the PD out.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   plan                 PD out plan of the device (findOutPlan)
+//!  \param[in]	   values               plan.elements.size() raw values
+//!
+//!  \return       sequence number of the update, 0 if the PD out is shorter
+//!                than the plan (e.g. no device in operation)
+//!
+//!*******************************************************************************
+
+uint64_t PDclass::write_procDataOut(const DecodePlan &plan, const IolValue *values)
+{
+    PDSample sample = procDataOut.read();
+    if (!IoddService::encode(plan, values, sample.data, sample.length))
+    {
+        return 0;
+    }
+    sample.sequence++;
+    sample.timestamp = pdTimestamp();
+    procDataOut.write(sample);
+    return sample.sequence;
+}
+
+//!*******************************************************************************
+//!  function :    confirm_procDataOut
+//!*******************************************************************************
+//!  \brief        Called by the cycle thread after a PD out frame was sent. The
+//!                first transmission of a sequence is acknowledged and its
+//!                request to wire latency counted.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   sent                 PD out sample that was sent
+//!  \param[in]	   wireTimestamp        ns since epoch, when the frame was sent
+//!
 //!  \return       void
 //!
 //!*******************************************************************************
 
-void PDclass::write_procDataOut(vector<uint8_t> PDout)
+void PDclass::confirm_procDataOut(const PDSample &sent, uint64_t wireTimestamp)
 {
-    procDataOut.clear();
-    procDataOut = PDout;
+    if ((sent.sequence == 0) || (sent.sequence <= procDataOutAck.read().sequence))
+    {
+        return; // nothing written yet or already acknowledged
+    }
+    PDOutAck ack;
+    ack.sequence = sent.sequence;
+    ack.requestTimestamp = sent.timestamp;
+    ack.wireTimestamp = wireTimestamp;
+    procDataOutAck.write(ack);
+    outLatency.add((wireTimestamp > sent.timestamp) ? (wireTimestamp - sent.timestamp) : 0);
     return;
 }
 
+//!*******************************************************************************
+//!  function :    read_procDataOutAck
+//!*******************************************************************************
+//!  \brief        Last PD out sequence that reached the wire
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       PDOutAck
+//!
+//!*******************************************************************************
+
+PDOutAck PDclass::read_procDataOutAck() const
+{
+    return procDataOutAck.read();
+}
+
+//!*******************************************************************************
+//!  function :    get_outLatency
+//!*******************************************************************************
+//!  \brief        Histogram of the PD out request to wire latency
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       LatencyHistogram&
+//!
+//!*******************************************************************************
+
+LatencyHistogram &PDclass::get_outLatency()
+{
+    return outLatency;
+}
+
+//!*******************************************************************************
+//!  function :    read_pd
+//!*******************************************************************************
+//!  \brief        Consistent snapshot of the latest PD in frame, lock-free
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       PDSample
+//!
+//!*******************************************************************************
+
+PDSample PDclass::read_pd() const
+{
+    return procData.read();
+}
+
+//!*******************************************************************************
+//!  function :    read_procDataOut
+//!*******************************************************************************
+//!  \brief        Consistent snapshot of the PD out to be sent, lock-free
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       PDSample
+//!
+//!*******************************************************************************
+
+PDSample PDclass::read_procDataOut() const
+{
+    return procDataOut.read();
+}
+
+//!*******************************************************************************
+//!  function :    get_history
+//!*******************************************************************************
+//!  \brief        History of the received PD frames, readable from any thread
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       const PDHistory&
+//!
+//!*******************************************************************************
+
+const PDHistory &PDclass::get_history() const
+{
+    return history;
+}
+
 //!*******************************************************************************
 //!  function :    get_float
 //!*******************************************************************************
@@ -1239,13 +2316,14 @@ vector<float> PDclass::get_float(uint8_t length)
     vector<float> pd_float;
     uint32_t hilfs_value;
     float hilfs_float;
-    for (int i = 1; i < length; i = i + 4) // first byte defines the length of the data
+    PDSample sample = procData.read();
+    for (int i = 0; (i + 3 < length - 1) && (i + 3 < sample.length); i = i + 4) // length includes the length byte
     {
         // order of pData: [] = b0, b1, b2, b3
         // order of newvalue: [] = b3, b2, b1, b0
         // order of memcpy: [] = b0, b1, b2, b3
-        hilfs_value = ((procData[i + 3]) | (procData[i + 2] << 8) | (procData[i + 1] << 16) | (procData[i] << 24)); // change Data Type (uint8_t -> float) and put Data in right order
-        memcpy(&hilfs_float, &hilfs_value, sizeof(hilfs_float));                                                    // writing the Data as float in the struct
+        hilfs_value = ((sample.data[i + 3]) | (sample.data[i + 2] << 8) | (sample.data[i + 1] << 16) | (sample.data[i] << 24)); // change Data Type (uint8_t -> float) and put Data in right order
+        memcpy(&hilfs_float, &hilfs_value, sizeof(hilfs_float));                                                                // writing the Data as float in the struct
         pd_float.push_back(hilfs_float);
     }
     return pd_float;
@@ -1267,11 +2345,18 @@ vector<float> PDclass::get_float(uint8_t length)
 vector<uint8_t> PDclass::get_uint8_t(uint8_t length)
 
 {
-    vector<uint8_t> returnData = procData;
-
-    reverse(returnData.begin(), returnData.end());
-
-    returnData.erase(returnData.begin() + length);
+    PDSample sample = procData.read();
+    // PD in reversed byte order followed by the length byte, the element at
+    // position length left out
+    vector<uint8_t> returnData;
+    returnData.reserve(sample.length + 1u);
+    for (size_t i = 0; i <= sample.length; i++)
+    {
+        if (i != length)
+        {
+            returnData.push_back((i < sample.length) ? sample.data[sample.length - 1 - i] : sample.length);
+        }
+    }
 
     return returnData;
 }
@@ -1291,7 +2376,8 @@ vector<uint8_t> PDclass::get_uint8_t(uint8_t length)
 
 vector<uint8_t> PDclass::get_procDataOut()
 {
-    return procDataOut;
+    PDSample sample = procDataOut.read();
+    return vector<uint8_t>(sample.data, sample.data + sample.length);
 }
 
 //!*******************************************************************************
@@ -1339,8 +2425,27 @@ vector<uint8_t> PDclass::get_procDataOut()
 
 nlohmann::json PDclass::interpretProcessData(IoddService &instance)
 {
-    vector<uint8_t> rawProcessData = procData;
-    rawProcessData.erase(rawProcessData.begin()); // first byte defines the length of the data
+    return interpretProcessData(instance, procData.read());
+}
+
+//!*******************************************************************************
+//!  function :    interpretProcessData()
+//!*******************************************************************************
+//!  \brief        Interprets a given PD snapshot, so the caller can decode
+//!                exactly the sample it has checked before
+//!
+//!  \type         local
+//!
+//!  \param[in]	   instance             IoddService
+//!  \param[in]	   sample               PD snapshot from read_pd()
+//!
+//!  \return       nlohmann::json
+//!
+//!*******************************************************************************
+
+nlohmann::json PDclass::interpretProcessData(IoddService &instance, const PDSample &sample)
+{
+    PDView rawProcessData(sample.data, sample.length);
     // cout << "Vendor ID: " << VendorID << "  Device ID: " << DeviceID << " iolRev: " << int(iolRev) << "  ProcessDataSize: " << rawProcessData.size() << endl;
     std::tuple<nlohmann::json, nlohmann::json> transformedData = instance.interpretProcessData(rawProcessData, VendorID, DeviceID, iolRev);
     nlohmann::json measurement = std::get<0>(transformedData);
@@ -1352,6 +2457,83 @@ nlohmann::json PDclass::interpretProcessData(IoddService &instance)
     return measurement;
 }
 
+//!*******************************************************************************
+//!  function :    interpretHistory()
+//!*******************************************************************************
+//!  \brief        Interprets many PD samples (e.g. out of the history) with one
+//!                plan lookup, the samples are decoded in a single batch
+//!
+//!  \type         local
+//!
+//!  \param[in]	   instance             IoddService
+//!  \param[in]	   samples              PD samples
+//!
+//!  \return       nlohmann::json array, one measurement per sample
+//!
+//!*******************************************************************************
+
+nlohmann::json PDclass::interpretHistory(IoddService &instance, const vector<PDSample> &samples)
+{
+    nlohmann::json measurements = nlohmann::json::array();
+    shared_ptr<const DecodePlan> plan = instance.findPlan(VendorID, DeviceID, iolRev);
+    if (!plan)
+    {
+        for (const PDSample &sample : samples)
+        {
+            nlohmann::json measurement;
+            measurement["rawProcessData"] = PDView(sample.data, sample.length);
+            measurements.push_back(measurement);
+        }
+        return measurements;
+    }
+
+    const size_t count = plan->elements.size();
+    vector<IolValue> values(samples.size() * count);
+    IoddService::decodeBatch(*plan, samples, values.data());
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        measurements.push_back(IoddService::toJson(*plan, values.data() + i * count));
+    }
+    return measurements;
+}
+
+//!*******************************************************************************
+//!  function :    findPlan()
+//!*******************************************************************************
+//!  \brief        Decode plan of the connected device, for callers that decode
+//!                and serialize the PD themselves
+//!
+//!  \type         local
+//!
+//!  \param[in]	   instance             IoddService
+//!
+//!  \return       the plan, nullptr if the device is unknown
+//!
+//!*******************************************************************************
+
+shared_ptr<const DecodePlan> PDclass::findPlan(IoddService &instance) const
+{
+    return instance.findPlan(VendorID, DeviceID, iolRev);
+}
+
+//!*******************************************************************************
+//!  function :    findOutPlan()
+//!*******************************************************************************
+//!  \brief        PD out plan of the connected device, for write_procDataOut
+//!
+//!  \type         local
+//!
+//!  \param[in]	   instance             IoddService
+//!
+//!  \return       the plan, nullptr if the device is unknown
+//!
+//!*******************************************************************************
+
+shared_ptr<const DecodePlan> PDclass::findOutPlan(IoddService &instance) const
+{
+    return instance.findOutPlan(VendorID, DeviceID, iolRev);
+}
+
 //!*******************************************************************************
 //!  function :    set_iodd
 //!*******************************************************************************
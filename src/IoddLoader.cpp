@@ -0,0 +1,912 @@
+#include "IoddLoader.h"
+#include "DecodePlan.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <unordered_map>
+/*!
+ * @file IoddLoader.cpp
+ * @brief Reads the process data layouts out of IODD files and keeps them in a
+ *        memory-mapped binary cache
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+// The cache is only read by the machine that wrote it, so the structures are
+// stored in native byte order. Bump the version if one of them changes.
+constexpr char CACHE_MAGIC[8] = {'I', 'O', 'D', 'D', 'C', 'A', 'C', 'H'};
+constexpr uint32_t CACHE_VERSION = 3u;
+
+struct IoddLoader::CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t fingerprint; // of the IODD directory the cache was built from
+    uint32_t elementCount;
+    uint32_t stringsSize;
+    uint32_t readOnlyCount;
+    uint32_t reserved;
+};
+
+struct IoddLoader::CacheEntry
+{
+    uint16_t vendorId;
+    uint8_t direction;
+    uint8_t isDefault;
+    uint32_t deviceId;
+    uint32_t firstElement;
+    uint32_t elementCount;
+    uint32_t conditionOffset; // variable name in the string table
+    uint32_t conditionLength; // 0 if the layout has no condition
+    int64_t conditionValue;
+};
+
+struct IoddLoader::CacheElement
+{
+    double gradient;
+    double offset;
+    uint32_t keyOffset;
+    uint16_t keyLength;
+    uint16_t bitOffset;
+    uint16_t bitLength;
+    uint16_t subindex;
+    uint16_t unitCode;
+    uint8_t type;
+    uint8_t reserved;
+};
+
+struct IoddLoader::CacheReadOnly
+{
+    uint16_t vendorId;
+    uint16_t index;
+    uint32_t deviceId;
+};
+
+namespace
+{
+
+/** \brief Element of the parsed XML tree, namespace prefixes are removed. */
+struct XmlNode
+{
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::vector<XmlNode> children;
+
+    const std::string *attribute(const char *attributeName) const
+    {
+        for (const auto &attribute : attributes)
+        {
+            if (attribute.first == attributeName)
+            {
+                return &attribute.second;
+            }
+        }
+        return nullptr;
+    }
+
+    const XmlNode *child(const char *childName) const
+    {
+        for (const XmlNode &node : children)
+        {
+            if (node.name == childName)
+            {
+                return &node;
+            }
+        }
+        return nullptr;
+    }
+};
+
+std::string localName(const std::string &name)
+{
+    const std::size_t colon = name.find(':');
+    return (colon == std::string::npos) ? name : name.substr(colon + 1u);
+}
+
+std::string decodeEntities(const std::string &text)
+{
+    static const std::pair<const char *, char> entities[] = {{"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); i++)
+    {
+        bool replaced = false;
+        if (text[i] == '&')
+        {
+            for (const auto &entity : entities)
+            {
+                const std::size_t length = std::strlen(entity.first);
+                if (text.compare(i, length, entity.first) == 0)
+                {
+                    decoded.push_back(entity.second);
+                    i += length - 1u;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+        if (!replaced)
+        {
+            decoded.push_back(text[i]);
+        }
+    }
+    return decoded;
+}
+
+/**
+ * \brief Minimal non-validating XML parser, enough for IODD files.
+ *
+ * Text content is dropped, IODDs keep everything needed in attributes.
+ *
+ * \return false if the document isn't well-formed
+ */
+bool parseXml(const std::string &xml, XmlNode &root)
+{
+    std::vector<XmlNode *> open; // ancestors of the current position
+    bool haveRoot = false;
+    std::size_t pos = 0;
+
+    while ((pos = xml.find('<', pos)) != std::string::npos)
+    {
+        if (xml.compare(pos, 4, "<!--") == 0)
+        {
+            pos = xml.find("-->", pos + 4u);
+            if (pos == std::string::npos)
+            {
+                return false;
+            }
+            pos += 3u;
+            continue;
+        }
+        if (xml.compare(pos, 9, "<![CDATA[") == 0)
+        {
+            pos = xml.find("]]>", pos + 9u);
+            if (pos == std::string::npos)
+            {
+                return false;
+            }
+            pos += 3u;
+            continue;
+        }
+        if ((xml.compare(pos, 2, "<?") == 0) || (xml.compare(pos, 2, "<!") == 0) || (xml.compare(pos, 2, "</") == 0))
+        {
+            const bool endTag = (xml[pos + 1u] == '/');
+            pos = xml.find('>', pos);
+            if (pos == std::string::npos)
+            {
+                return false;
+            }
+            pos++;
+            if (endTag)
+            {
+                if (open.empty())
+                {
+                    return false;
+                }
+                open.pop_back();
+            }
+            continue;
+        }
+
+        // start tag
+        pos++;
+        const std::size_t nameEnd = xml.find_first_of(" \t\r\n/>", pos);
+        if (nameEnd == std::string::npos)
+        {
+            return false;
+        }
+        XmlNode node;
+        node.name = localName(xml.substr(pos, nameEnd - pos));
+        pos = nameEnd;
+        bool selfClosing = false;
+        while (true)
+        {
+            pos = xml.find_first_not_of(" \t\r\n", pos);
+            if (pos == std::string::npos)
+            {
+                return false;
+            }
+            if (xml[pos] == '>')
+            {
+                pos++;
+                break;
+            }
+            if (xml[pos] == '/')
+            {
+                selfClosing = true;
+                pos = xml.find('>', pos);
+                if (pos == std::string::npos)
+                {
+                    return false;
+                }
+                pos++;
+                break;
+            }
+            const std::size_t equals = xml.find('=', pos);
+            const std::size_t quote = (equals == std::string::npos) ? std::string::npos : xml.find_first_of("\"'", equals + 1u);
+            const std::size_t valueEnd = (quote == std::string::npos) ? std::string::npos : xml.find(xml[quote], quote + 1u);
+            if (valueEnd == std::string::npos)
+            {
+                return false;
+            }
+            std::string attributeName = xml.substr(pos, equals - pos);
+            attributeName.erase(attributeName.find_last_not_of(" \t\r\n") + 1u);
+            node.attributes.emplace_back(localName(attributeName), decodeEntities(xml.substr(quote + 1u, valueEnd - quote - 1u)));
+            pos = valueEnd + 1u;
+        }
+
+        XmlNode *inserted = nullptr;
+        if (open.empty())
+        {
+            if (haveRoot)
+            {
+                return false;
+            }
+            root = std::move(node);
+            haveRoot = true;
+            inserted = &root;
+        }
+        else
+        {
+            // only the innermost open element grows, the pointers to its ancestors stay valid
+            open.back()->children.push_back(std::move(node));
+            inserted = &open.back()->children.back();
+        }
+        if (!selfClosing)
+        {
+            open.push_back(inserted);
+        }
+    }
+    return haveRoot && open.empty();
+}
+
+const XmlNode *findDescendant(const XmlNode &node, const char *name)
+{
+    for (const XmlNode &child : node.children)
+    {
+        if (child.name == name)
+        {
+            return &child;
+        }
+        if (const XmlNode *found = findDescendant(child, name))
+        {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t toUInt(const std::string *text, uint64_t defaultValue = 0)
+{
+    return text ? std::strtoull(text->c_str(), nullptr, 10) : defaultValue;
+}
+
+bool toInt(const std::string *text, int64_t &value)
+{
+    if (!text || text->empty())
+    {
+        return false;
+    }
+    char *end = nullptr;
+    value = std::strtoll(text->c_str(), &end, 10);
+    return *end == '\0';
+}
+
+double toDouble(const std::string *text, double defaultValue)
+{
+    return text ? std::strtod(text->c_str(), nullptr) : defaultValue;
+}
+
+std::string textId(const XmlNode &node)
+{
+    const XmlNode *name = node.child("Name");
+    const std::string *id = name ? name->attribute("textId") : nullptr;
+    return id ? *id : std::string();
+}
+
+/** \brief Follows a DatatypeRef, returns the datatype node itself otherwise. */
+const XmlNode *resolveDatatype(const XmlNode *node, const std::unordered_map<std::string, const XmlNode *> &datatypes)
+{
+    if (node && (node->name == "DatatypeRef"))
+    {
+        const std::string *id = node->attribute("datatypeId");
+        auto it = id ? datatypes.find(*id) : datatypes.end();
+        return (it != datatypes.end()) ? it->second : nullptr;
+    }
+    return node;
+}
+
+const XmlNode *datatypeOf(const XmlNode &node, const char *inlineName, const std::unordered_map<std::string, const XmlNode *> &datatypes)
+{
+    const XmlNode *datatype = node.child(inlineName);
+    if (!datatype)
+    {
+        datatype = node.child("DatatypeRef");
+    }
+    return resolveDatatype(datatype, datatypes);
+}
+
+/** \brief Length of a datatype in bits, StringT and OctetStringT have a fixedLength in octets. */
+uint16_t bitLengthOf(const XmlNode *datatype, uint64_t fallback = 0)
+{
+    if (datatype && datatype->attribute("fixedLength"))
+    {
+        return static_cast<uint16_t>(8u * toUInt(datatype->attribute("fixedLength")));
+    }
+    return static_cast<uint16_t>(toUInt(datatype ? datatype->attribute("bitLength") : nullptr, fallback));
+}
+
+uint64_t fnv1a(uint64_t hash, const void *data, std::size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/** \brief IODD files of a directory, sorted by name. */
+std::vector<std::string> listIoddFiles(const std::string &directory)
+{
+    std::vector<std::string> files;
+    DIR *dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return files;
+    }
+    while (const dirent *entry = readdir(dir))
+    {
+        const std::string name = entry->d_name;
+        if ((name.size() > 4u) && (strcasecmp(name.c_str() + name.size() - 4u, ".xml") == 0))
+        {
+            files.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/** \brief Changes whenever an IODD file is added, removed or modified. */
+uint64_t fingerprint(const std::vector<std::string> &files)
+{
+    uint64_t hash = fnv1a(0xCBF29CE484222325ull, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    for (const std::string &file : files)
+    {
+        struct stat info = {};
+        stat(file.c_str(), &info);
+        const int64_t attributes[] = {static_cast<int64_t>(info.st_size), static_cast<int64_t>(info.st_mtim.tv_sec), static_cast<int64_t>(info.st_mtim.tv_nsec)};
+        hash = fnv1a(hash, file.data(), file.size() + 1u);
+        hash = fnv1a(hash, attributes, sizeof(attributes));
+    }
+    return hash;
+}
+
+} // namespace
+
+/**
+ * \brief Extracts the ProcessDataIn/Out records of an IODD.
+ *
+ * Every ProcessData variant of the ProcessDataCollection becomes one layout per
+ * direction. If a variant has a Condition, the one matching the default value of
+ * the condition variable is marked as default. Keys are the textIds of the
+ * record items, scaling is taken from the ProcessDataRefCollection. The
+ * indices of the read-only variables are collected for the parameter cache.
+ *
+ * \param xml content of the IODD file
+ * \param layouts output, the layouts are appended
+ * \param readOnly output, the read-only variables are appended
+ * \return false if the file isn't an IODD with process data
+ */
+bool parseIodd(const std::string &xml, std::vector<IoddLayout> &layouts, std::vector<IoddReadOnly> &readOnly)
+{
+    XmlNode root;
+    if (!parseXml(xml, root) || (root.name != "IODevice"))
+    {
+        return false;
+    }
+    const XmlNode *identity = findDescendant(root, "DeviceIdentity");
+    const XmlNode *processDataCollection = findDescendant(root, "ProcessDataCollection");
+    if (!identity || !processDataCollection)
+    {
+        return false;
+    }
+    const uint16_t vendorId = static_cast<uint16_t>(toUInt(identity->attribute("vendorId")));
+    const uint32_t deviceId = static_cast<uint32_t>(toUInt(identity->attribute("deviceId")));
+
+    std::unordered_map<std::string, const XmlNode *> datatypes;
+    if (const XmlNode *collection = findDescendant(root, "DatatypeCollection"))
+    {
+        for (const XmlNode &datatype : collection->children)
+        {
+            if (const std::string *id = datatype.attribute("id"))
+            {
+                datatypes[*id] = &datatype;
+            }
+        }
+    }
+
+    std::unordered_map<std::string, int64_t> defaultValues;
+    if (const XmlNode *collection = findDescendant(root, "VariableCollection"))
+    {
+        for (const XmlNode &variable : collection->children)
+        {
+            int64_t value = 0;
+            const std::string *id = variable.attribute("id");
+            if (id && toInt(variable.attribute("defaultValue"), value))
+            {
+                defaultValues[*id] = value;
+            }
+            const std::string *accessRights = variable.attribute("accessRights");
+            if ((variable.name == "Variable") && accessRights && (*accessRights == "ro") && variable.attribute("index"))
+            {
+                readOnly.push_back({vendorId, static_cast<uint16_t>(toUInt(variable.attribute("index"))), deviceId});
+            }
+        }
+    }
+
+    // scaling per ProcessDataIn/Out id and subindex
+    std::unordered_map<std::string, std::unordered_map<uint16_t, ProcessDataInfo_t>> infos;
+    if (const XmlNode *collection = findDescendant(root, "ProcessDataRefCollection"))
+    {
+        for (const XmlNode &ref : collection->children)
+        {
+            const std::string *id = ref.attribute("processDataId");
+            if (!id)
+            {
+                continue;
+            }
+            for (const XmlNode &item : ref.children)
+            {
+                if (item.name != "ProcessDataRecordItemInfo")
+                {
+                    continue;
+                }
+                ProcessDataInfo_t info;
+                info.gradient = toDouble(item.attribute("gradient"), 1.0);
+                info.offset = toDouble(item.attribute("offset"), 0.0);
+                info.unitCode = static_cast<uint16_t>(toUInt(item.attribute("unitCode")));
+                if (const std::string *format = item.attribute("displayFormat"))
+                {
+                    info.displayFormat = *format;
+                }
+                infos[*id][static_cast<uint16_t>(toUInt(item.attribute("subindex")))] = info;
+            }
+        }
+    }
+
+    const std::size_t first = layouts.size();
+    for (const XmlNode &processData : processDataCollection->children)
+    {
+        if (processData.name != "ProcessData")
+        {
+            continue;
+        }
+        std::string conditionVariable;
+        int64_t conditionValue = 0;
+        if (const XmlNode *condition = processData.child("Condition"))
+        {
+            const std::string *variable = condition->attribute("variableId");
+            if (variable && toInt(condition->attribute("value"), conditionValue))
+            {
+                conditionVariable = *variable;
+            }
+        }
+
+        for (const XmlNode &direction : processData.children)
+        {
+            if ((direction.name != "ProcessDataIn") && (direction.name != "ProcessDataOut"))
+            {
+                continue;
+            }
+            IoddLayout layout;
+            layout.vendorId = vendorId;
+            layout.deviceId = deviceId;
+            layout.direction = (direction.name == "ProcessDataIn") ? PDDirection::In : PDDirection::Out;
+            layout.conditionVariable = conditionVariable;
+            layout.conditionValue = conditionValue;
+            if (!conditionVariable.empty())
+            {
+                auto it = defaultValues.find(conditionVariable);
+                layout.isDefault = (it != defaultValues.end()) && (it->second == conditionValue);
+            }
+
+            const std::string *id = direction.attribute("id");
+            auto info = id ? infos.find(*id) : infos.end();
+            auto addElement = [&](ProcessDataElement &element) {
+                if (info != infos.end())
+                {
+                    auto itemInfo = info->second.find(element.subindex);
+                    if (itemInfo != info->second.end())
+                    {
+                        element.processDataInfo = itemInfo->second;
+                    }
+                }
+                layout.elements.push_back(std::move(element));
+            };
+
+            const XmlNode *datatype = datatypeOf(direction, "Datatype", datatypes);
+            const std::string *type = datatype ? datatype->attribute("type") : nullptr;
+            if (!type)
+            {
+                continue;
+            }
+            if (*type == "RecordT")
+            {
+                for (const XmlNode &item : datatype->children)
+                {
+                    if (item.name != "RecordItem")
+                    {
+                        continue;
+                    }
+                    const XmlNode *itemType = datatypeOf(item, "SimpleDatatype", datatypes);
+                    const std::string *itemTypeName = itemType ? itemType->attribute("type") : nullptr;
+                    ProcessDataElement element;
+                    element.subindex = static_cast<uint16_t>(toUInt(item.attribute("subindex")));
+                    element.bitOffset = static_cast<uint16_t>(toUInt(item.attribute("bitOffset")));
+                    element.bitLength = bitLengthOf(itemType);
+                    element.type = itemTypeName ? iolTypeFromString(*itemTypeName) : IolType::Invalid;
+                    element.key = textId(item);
+                    if (element.key.empty())
+                    {
+                        element.key = "Subindex" + std::to_string(element.subindex);
+                    }
+                    addElement(element);
+                }
+            }
+            else
+            {
+                ProcessDataElement element;
+                element.bitLength = bitLengthOf(datatype, toUInt(direction.attribute("bitLength")));
+                element.type = iolTypeFromString(*type);
+                element.key = textId(direction);
+                if (element.key.empty() && id)
+                {
+                    element.key = *id;
+                }
+                addElement(element);
+            }
+            layouts.push_back(std::move(layout));
+        }
+    }
+
+    // a variable without (matching) default value, use the first variant
+    for (PDDirection direction : {PDDirection::In, PDDirection::Out})
+    {
+        auto begin = layouts.begin() + static_cast<std::ptrdiff_t>(first);
+        auto isDirection = [direction](const IoddLayout &layout) { return layout.direction == direction; };
+        auto isDefault = [direction](const IoddLayout &layout) { return (layout.direction == direction) && layout.isDefault; };
+        auto firstLayout = std::find_if(begin, layouts.end(), isDirection);
+        if ((firstLayout != layouts.end()) && (std::find_if(begin, layouts.end(), isDefault) == layouts.end()))
+        {
+            firstLayout->isDefault = true;
+        }
+    }
+    return layouts.size() > first;
+}
+
+IoddLoader::~IoddLoader()
+{
+    unmap();
+}
+
+/**
+ * \brief Loads the layouts of all IODD files (*.xml) of a directory.
+ *
+ * If several files describe the same device, the last one by file name wins,
+ * IODD file names end with their release date.
+ *
+ * \param directory directory with the IODD files
+ * \param cacheFile cache file, rebuilt if the directory changed
+ * \return false if no layouts are available
+ */
+bool IoddLoader::load(const std::string &directory, const std::string &cacheFile)
+{
+    unmap();
+    const std::vector<std::string> files = listIoddFiles(directory);
+    if (files.empty())
+    {
+        return false;
+    }
+    const uint64_t directoryFingerprint = fingerprint(files);
+    if (map(cacheFile, directoryFingerprint))
+    {
+        return entryCount_ != 0;
+    }
+
+    std::vector<IoddLayout> layouts;
+    std::vector<IoddReadOnly> readOnly;
+    for (const std::string &file : files)
+    {
+        std::ifstream input(file, std::ios::binary);
+        std::stringstream content;
+        content << input.rdbuf();
+        std::vector<IoddLayout> fileLayouts;
+        std::vector<IoddReadOnly> fileReadOnly;
+        if (!input || !parseIodd(content.str(), fileLayouts, fileReadOnly))
+        {
+            std::cout << "IODD: no process data in " << file << std::endl;
+            continue;
+        }
+        const uint16_t vendorId = fileLayouts.front().vendorId;
+        const uint32_t deviceId = fileLayouts.front().deviceId;
+        layouts.erase(std::remove_if(layouts.begin(), layouts.end(),
+                                     [vendorId, deviceId](const IoddLayout &layout) {
+                                         return (layout.vendorId == vendorId) && (layout.deviceId == deviceId);
+                                     }),
+                      layouts.end());
+        readOnly.erase(std::remove_if(readOnly.begin(), readOnly.end(),
+                                      [vendorId, deviceId](const IoddReadOnly &variable) {
+                                          return (variable.vendorId == vendorId) && (variable.deviceId == deviceId);
+                                      }),
+                       readOnly.end());
+        std::move(fileLayouts.begin(), fileLayouts.end(), std::back_inserter(layouts));
+        readOnly.insert(readOnly.end(), fileReadOnly.begin(), fileReadOnly.end());
+    }
+
+    std::vector<uint8_t> image = buildCache(directoryFingerprint, std::move(layouts), std::move(readOnly));
+    const std::string tempFile = cacheFile + ".tmp";
+    std::ofstream output(tempFile, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+    output.close();
+    if (output && (std::rename(tempFile.c_str(), cacheFile.c_str()) == 0) && map(cacheFile, directoryFingerprint))
+    {
+        return entryCount_ != 0;
+    }
+
+    std::cout << "IODD: can't write " << cacheFile << ", keeping the layouts in memory" << std::endl;
+    std::remove(tempFile.c_str());
+    ownedImage_ = std::move(image);
+    attach(ownedImage_.data(), ownedImage_.size(), directoryFingerprint);
+    return entryCount_ != 0;
+}
+
+/**
+ * \brief Serializes layouts: header, entries, elements, read-only variables,
+ * string table.
+ */
+std::vector<uint8_t> IoddLoader::buildCache(uint64_t fingerprint, std::vector<IoddLayout> layouts, std::vector<IoddReadOnly> readOnly)
+{
+    // keeps every section 8-byte aligned inside the mapping
+    static_assert(sizeof(CacheHeader) == 40, "cache layout changed");
+    static_assert(sizeof(CacheEntry) == 32, "cache layout changed");
+    static_assert(sizeof(CacheElement) == 32, "cache layout changed");
+    static_assert(sizeof(CacheReadOnly) == 8, "cache layout changed");
+
+    std::stable_sort(layouts.begin(), layouts.end(), [](const IoddLayout &a, const IoddLayout &b) {
+        return std::make_tuple(a.vendorId, a.deviceId, a.direction, !a.isDefault) < std::make_tuple(b.vendorId, b.deviceId, b.direction, !b.isDefault);
+    });
+
+    std::vector<CacheEntry> entries;
+    std::vector<CacheElement> elements;
+    std::string strings;
+    for (const IoddLayout &layout : layouts)
+    {
+        CacheEntry entry = {};
+        entry.vendorId = layout.vendorId;
+        entry.direction = static_cast<uint8_t>(layout.direction);
+        entry.isDefault = layout.isDefault ? 1u : 0u;
+        entry.deviceId = layout.deviceId;
+        entry.firstElement = static_cast<uint32_t>(elements.size());
+        entry.elementCount = static_cast<uint32_t>(layout.elements.size());
+        entry.conditionOffset = static_cast<uint32_t>(strings.size());
+        entry.conditionLength = static_cast<uint32_t>(layout.conditionVariable.size());
+        entry.conditionValue = layout.conditionValue;
+        strings += layout.conditionVariable;
+        entries.push_back(entry);
+
+        for (const ProcessDataElement &element : layout.elements)
+        {
+            CacheElement cached = {};
+            cached.gradient = element.processDataInfo.gradient;
+            cached.offset = element.processDataInfo.offset;
+            cached.keyOffset = static_cast<uint32_t>(strings.size());
+            cached.keyLength = static_cast<uint16_t>(element.key.size());
+            cached.bitOffset = element.bitOffset;
+            cached.bitLength = element.bitLength;
+            cached.subindex = element.subindex;
+            cached.unitCode = element.processDataInfo.unitCode;
+            cached.type = static_cast<uint8_t>(element.type);
+            strings += element.key;
+            elements.push_back(cached);
+        }
+    }
+
+    std::vector<CacheReadOnly> variables;
+    variables.reserve(readOnly.size());
+    for (const IoddReadOnly &variable : readOnly)
+    {
+        variables.push_back({variable.vendorId, variable.index, variable.deviceId});
+    }
+    std::sort(variables.begin(), variables.end(), [](const CacheReadOnly &a, const CacheReadOnly &b) {
+        return std::make_tuple(a.vendorId, a.deviceId, a.index) < std::make_tuple(b.vendorId, b.deviceId, b.index);
+    });
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = CACHE_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.fingerprint = fingerprint;
+    header.elementCount = static_cast<uint32_t>(elements.size());
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+    header.readOnlyCount = static_cast<uint32_t>(variables.size());
+
+    std::vector<uint8_t> image(sizeof(header) + entries.size() * sizeof(CacheEntry) + elements.size() * sizeof(CacheElement) + variables.size() * sizeof(CacheReadOnly) + strings.size());
+    uint8_t *p = image.data();
+    std::memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    std::memcpy(p, entries.data(), entries.size() * sizeof(CacheEntry));
+    p += entries.size() * sizeof(CacheEntry);
+    std::memcpy(p, elements.data(), elements.size() * sizeof(CacheElement));
+    p += elements.size() * sizeof(CacheElement);
+    std::memcpy(p, variables.data(), variables.size() * sizeof(CacheReadOnly));
+    p += variables.size() * sizeof(CacheReadOnly);
+    std::memcpy(p, strings.data(), strings.size());
+    return image;
+}
+
+bool IoddLoader::map(const std::string &cacheFile, uint64_t fingerprint)
+{
+    const int fd = open(cacheFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info = {};
+    void *mapping = MAP_FAILED;
+    if ((fstat(fd, &info) == 0) && (info.st_size > 0))
+    {
+        mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    if (!attach(static_cast<const uint8_t *>(mapping), static_cast<std::size_t>(info.st_size), fingerprint))
+    {
+        munmap(mapping, static_cast<std::size_t>(info.st_size));
+        return false;
+    }
+    mapped_ = true;
+    return true;
+}
+
+/**
+ * \brief Checks a cache image and sets up the pointers into it.
+ *
+ * \return false if the image is outdated or damaged
+ */
+bool IoddLoader::attach(const uint8_t *image, std::size_t size, uint64_t fingerprint)
+{
+    CacheHeader header;
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, image, sizeof(header));
+    const std::size_t expectedSize = sizeof(header) + std::size_t(header.entryCount) * sizeof(CacheEntry) + std::size_t(header.elementCount) * sizeof(CacheElement) +
+                                     std::size_t(header.readOnlyCount) * sizeof(CacheReadOnly) + header.stringsSize;
+    if ((std::memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0) || (header.version != CACHE_VERSION) || (header.fingerprint != fingerprint) || (size != expectedSize))
+    {
+        return false;
+    }
+    image_ = image;
+    imageSize_ = size;
+    entries_ = reinterpret_cast<const CacheEntry *>(image + sizeof(header));
+    entryCount_ = header.entryCount;
+    elements_ = reinterpret_cast<const CacheElement *>(entries_ + entryCount_);
+    elementCount_ = header.elementCount;
+    readOnly_ = reinterpret_cast<const CacheReadOnly *>(elements_ + elementCount_);
+    readOnlyCount_ = header.readOnlyCount;
+    strings_ = reinterpret_cast<const char *>(readOnly_ + readOnlyCount_);
+    stringsSize_ = header.stringsSize;
+    return true;
+}
+
+void IoddLoader::unmap()
+{
+    if (mapped_)
+    {
+        munmap(const_cast<uint8_t *>(image_), imageSize_);
+    }
+    ownedImage_.clear();
+    image_ = nullptr;
+    imageSize_ = 0;
+    mapped_ = false;
+    entries_ = nullptr;
+    entryCount_ = 0;
+    elements_ = nullptr;
+    elementCount_ = 0;
+    readOnly_ = nullptr;
+    readOnlyCount_ = 0;
+    strings_ = nullptr;
+    stringsSize_ = 0;
+}
+
+/**
+ * \brief Copies the layout of a device out of the cache.
+ *
+ * \param conditionValue value of the condition variable, DEFAULT_CONDITION for
+ * the layout selected by its default value
+ * \return false if the device or the variant is unknown
+ */
+bool IoddLoader::find(uint16_t VendorID, uint32_t DeviceID, PDDirection direction, std::vector<ProcessDataElement> &elements, int64_t conditionValue) const
+{
+    auto key = [](const CacheEntry &entry) { return std::make_tuple(entry.vendorId, entry.deviceId, entry.direction); };
+    const auto wanted = std::make_tuple(VendorID, DeviceID, static_cast<uint8_t>(direction));
+    const CacheEntry *end = entries_ + entryCount_;
+    const CacheEntry *entry = std::lower_bound(entries_, end, wanted, [&key](const CacheEntry &e, const decltype(wanted) &value) { return key(e) < value; });
+
+    for (; (entry != end) && (key(*entry) == wanted); entry++)
+    {
+        const bool match = (conditionValue == DEFAULT_CONDITION) ? (entry->isDefault != 0) : ((entry->conditionLength != 0) && (entry->conditionValue == conditionValue));
+        if (!match)
+        {
+            continue;
+        }
+        if ((std::size_t(entry->firstElement) + entry->elementCount) > elementCount_)
+        {
+            return false;
+        }
+        elements.clear();
+        elements.reserve(entry->elementCount);
+        for (uint32_t i = 0; i < entry->elementCount; i++)
+        {
+            const CacheElement &cached = elements_[entry->firstElement + i];
+            if ((std::size_t(cached.keyOffset) + cached.keyLength) > stringsSize_)
+            {
+                return false;
+            }
+            ProcessDataElement element;
+            element.key.assign(strings_ + cached.keyOffset, cached.keyLength);
+            element.processDataInfo.gradient = cached.gradient;
+            element.processDataInfo.offset = cached.offset;
+            element.processDataInfo.unitCode = cached.unitCode;
+            element.type = (cached.type < static_cast<uint8_t>(IolType::Count)) ? static_cast<IolType>(cached.type) : IolType::Invalid;
+            element.bitOffset = cached.bitOffset;
+            element.bitLength = cached.bitLength;
+            element.subindex = cached.subindex;
+            elements.push_back(std::move(element));
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * \brief Indices of the read-only variables of a device, see parseIodd().
+ *
+ * \param indices output, replaced by the indices of the device
+ * \return false if the IODD of the device declares no read-only variable
+ */
+bool IoddLoader::findReadOnly(uint16_t VendorID, uint32_t DeviceID, std::vector<uint16_t> &indices) const
+{
+    auto key = [](const CacheReadOnly &variable) { return std::make_tuple(variable.vendorId, variable.deviceId); };
+    const auto wanted = std::make_tuple(VendorID, DeviceID);
+    const CacheReadOnly *end = readOnly_ + readOnlyCount_;
+    const CacheReadOnly *variable = std::lower_bound(readOnly_, end, wanted, [&key](const CacheReadOnly &v, const decltype(wanted) &value) { return key(v) < value; });
+
+    indices.clear();
+    for (; (variable != end) && (key(*variable) == wanted); variable++)
+    {
+        indices.push_back(variable->index);
+    }
+    return !indices.empty();
+}
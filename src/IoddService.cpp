@@ -1,4 +1,12 @@
 #include "IoddService.h"
+#include "BitExtract.h"
+#include "GeneratedDecoder.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#ifdef IODD_GENERATED
+#include "IoddGenerated.h"
+#endif
 /*!
  * @file IoddSetvice.cpp
  * @brief IoddService class used for processdata conversion
@@ -8,221 +16,553 @@
  * @since 11.08.2022
  */
 
-void IoddService::setBitLength(ProcessDataElement *element)
+constexpr uint16_t VENDOR_ID_BALLUFF = 888u;
+
+IolValue IoddService::extractInvalid(const uint8_t *, const PlanElement &)
+{
+    return IolValue();
+}
+
+IolValue IoddService::extractBoolean(const uint8_t *end, const PlanElement &element)
+{
+    // the most significant bit of the element
+    IolValue value;
+    value.type = IolType::BooleanT;
+    value.boolean = bitextract::extractBit(end, element.bitOffset + element.bitLength - 1u);
+    return value;
+}
+
+IolValue IoddService::extractUInteger(const uint8_t *end, const PlanElement &element)
 {
-    if (element->bitLength > 128 || element->bitLength == 0)
+    IolValue value;
+    if ((64 >= element.bitLength) && (2 <= element.bitLength))
     {
-        if (element->type == "BooleanT")
-        {
-            element->bitLength = 1;
-        }
-        if (element->type == "UIntegerT")
-        {
-            element->bitLength = 64;
-        }
-        if (element->type == "Float32T")
+        value.type = IolType::UIntegerT;
+        value.uinteger = bitextract::extractFromRight(end, element.bitOffset, element.bitLength);
+    }
+    return value;
+}
+
+IolValue IoddService::extractFloat32(const uint8_t *end, const PlanElement &element)
+{
+    IolValue value;
+    if (element.bitLength == 32u)
+    {
+        const uint32_t bits = static_cast<uint32_t>(bitextract::extractFromRight(end, element.bitOffset, 32u));
+        value.type = IolType::Float32T;
+        std::memcpy(&value.float32, &bits, sizeof(value.float32));
+    }
+    return value;
+}
+
+IolValue IoddService::extractInteger(const uint8_t *end, const PlanElement &element)
+{
+    IolValue value;
+    if ((64 >= element.bitLength) && (2 <= element.bitLength))
+    {
+        value.type = IolType::IntegerT;
+        value.integer = bitextract::signExtend(bitextract::extractFromRight(end, element.bitOffset, element.bitLength), element.bitLength);
+    }
+    return value;
+}
+
+IolValue IoddService::extractString(const uint8_t *end, const PlanElement &element)
+{
+    // fixed length, shorter strings are terminated by 0x00
+    IolValue value = extractOctetString(end, element);
+    if (value.type == IolType::OctetStringT)
+    {
+        const void *terminator = std::memchr(value.bytes.data, 0, value.bytes.length);
+        if (terminator != nullptr)
         {
-            element->bitLength = 32;
+            value.bytes.length = static_cast<uint16_t>(static_cast<const uint8_t *>(terminator) - value.bytes.data);
         }
+        value.type = IolType::StringT;
     }
+    return value;
 }
+
+IolValue IoddService::extractOctetString(const uint8_t *end, const PlanElement &element)
+{
+    IolValue value;
+    if (!(element.bitOffset & 7u) && !(element.bitLength & 7u))
+    {
+        value.type = IolType::OctetStringT;
+        value.bytes.data = end - (element.bitOffset + element.bitLength) / 8u;
+        value.bytes.length = element.bitLength / 8u;
+    }
+    return value;
+}
+
+IolValue IoddService::extractTime(const uint8_t *end, const PlanElement &element)
+{
+    IolValue value;
+    if (element.bitLength == 64u)
+    {
+        value.type = IolType::TimeT;
+        value.integer = iolTimeToNs(bitextract::extractFromRight(end, element.bitOffset, 64u));
+    }
+    return value;
+}
+
+IolValue IoddService::extractTimeSpan(const uint8_t *end, const PlanElement &element)
+{
+    IolValue value;
+    if (element.bitLength == 64u)
+    {
+        value.type = IolType::TimeSpanT;
+        value.integer = iolTimeSpanToNs(bitextract::extractFromRight(end, element.bitOffset, 64u));
+    }
+    return value;
+}
+
+// indexed by IolType
+const IoddService::Extractor IoddService::extractors_[static_cast<std::size_t>(IolType::Count)] = {
+    &IoddService::extractInvalid,     // Invalid
+    &IoddService::extractBoolean,     // BooleanT
+    &IoddService::extractUInteger,    // UIntegerT
+    &IoddService::extractFloat32,     // Float32T
+    &IoddService::extractInteger,     // IntegerT
+    &IoddService::extractString,      // StringT
+    &IoddService::extractOctetString, // OctetStringT
+    &IoddService::extractTime,        // TimeT
+    &IoddService::extractTimeSpan,    // TimeSpanT
+};
+
 /**
- * \brief Turns 8 bits into a byte.
- *
- * If the bits are shifted, this will read the remaining bits from the byte
- * before pData.
+ * \brief Extracts one element, dispatched by its datatype.
  *
- * Exactly 8 bits are extracted.  If less are required, the caller must
- * mask the return value.
- *
- * \param pData pointer to the byte containing the right-most (least significant) bit.
- * \param bitShiftRight number of bits needed to align the data
- * \return the extracted byte
+ * \param element plan element to extract
+ * \param end pointer behind the last process data byte, bitextract::PADDING
+ * readable bytes have to precede the data
+ * \param dataLength number of process data bytes
+ * \return the raw (unscaled) value
  */
-uint8_t IoddService::getByteFromRight(const uint8_t *const pData, const std::size_t bitShiftRight)
+IolValue IoddService::getProcessDataVar(const PlanElement &element, const uint8_t *end, std::size_t dataLength)
 {
-    uint8_t byte = 0;
-
-    if (pData)
+    // Sanity check
+    if ((element.bitLength == 0) || ((element.bitOffset + element.bitLength) > dataLength * 8u) || (element.type >= IolType::Count))
     {
-        if (0 == bitShiftRight)
-        {
-            byte = *pData;
-        }
-        else
-        {
-            // Bits are not byte-aligned
-            byte = ((static_cast<uint8_t>(*(pData - 1u)) << 8u) | *pData) >> bitShiftRight; // NOLINT(hicpp-signed-bitwise)
-        }
+        return IolValue();
     }
+    return extractors_[static_cast<std::size_t>(element.type)](end, element);
+}
 
-    return byte;
+/**
+ * \brief Extracts all elements of one record, which has padding in front.
+ */
+void IoddService::decodeRecord(const DecodePlan &plan, const uint8_t *end, std::size_t dataLength, IolValue *values)
+{
+    const std::size_t count = plan.elements.size();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        values[i] = getProcessDataVar(plan.elements[i], end, dataLength);
+    }
 }
+
 /**
- * \brief Converts a sequence of bits to an unsigned 64-bit integer.
- *
- * The sequence *MUST* start in the first byte!
+ * \brief Extracts all elements of a plan without building any JSON.
  *
- * \warning
- * * There is no validation.
- * * Do not pass NULL as pData.
- * * Do not pass bitLength with 64 or higher.
- * * Do not pass bitOffset with 8 or higher.
- *
- * \param pData pointer to the byte which contains the most significant bit
- * of the integer to extract.
- * \param bitLength the number of bits to extract (1..64)
- * \param bitOffset the offset of the first bit from the left (0..7)
+ * \param plan decode plan of the device
+ * \param data process data, first byte is the most significant one
+ * \param dataLength number of process data bytes
+ * \param values output, plan.elements.size() entries
  */
-uint64_t IoddService::getUInt64(const uint8_t *const pData, const uint16_t bitLength, const uint16_t bitOffset)
+void IoddService::decode(const DecodePlan &plan, const uint8_t *data, std::size_t dataLength, IolValue *values)
 {
-    uint64_t returnVal = 0;
+    if (data == nullptr)
+    {
+        dataLength = 0;
+    }
+    // specialized decoder generated for the device, declines too short data
+    if ((plan.decode != nullptr) && plan.decode(data, dataLength, values))
+    {
+        return;
+    }
+    const bitextract::PaddedRecord record(data, dataLength);
+    decodeRecord(plan, record.end(), dataLength, values);
+    if (plan.views)
+    {
+        // point into the caller's data instead of the copy
+        const uint8_t *copy = record.end() - dataLength;
+        for (std::size_t i = 0; i < plan.elements.size(); i++)
+        {
+            if ((values[i].type == IolType::StringT) || (values[i].type == IolType::OctetStringT))
+            {
+                values[i].bytes.data = data + (values[i].bytes.data - copy);
+            }
+        }
+    }
+}
+
+void IoddService::insertInvalid(uint8_t *, const PlanElement &, const IolValue &)
+{
+}
+
+void IoddService::insertBoolean(uint8_t *end, const PlanElement &element, const IolValue &value)
+{
+    // the bit the decoder reads
+    bitextract::insertBit(end, element.bitOffset + element.bitLength - 1u, value.boolean);
+}
+
+void IoddService::insertUInteger(uint8_t *end, const PlanElement &element, const IolValue &value)
+{
+    if ((64 >= element.bitLength) && (2 <= element.bitLength))
+    {
+        bitextract::insertFromRight(end, element.bitOffset, element.bitLength, value.uinteger);
+    }
+}
 
-    // Number of bits (0..7) that the source field is offset from the
-    // right, relative to the next byte boundary.
-    // The extracted bits will need to be shifted this many bits to the
-    // right to align with the destination bytes.
-    const std::size_t bitOffsetRight = (8u - ((static_cast<uint32_t>(bitOffset + bitLength)) & 7u)) & 7u;
-    unsigned int bitsRemaining = bitLength;
-    int bitsOld;
-    do
+void IoddService::insertFloat32(uint8_t *end, const PlanElement &element, const IolValue &value)
+{
+    if (element.bitLength == 32u)
     {
-        returnVal |= (static_cast<uint64_t>(getByteFromRight(pData + ((bitOffset + bitsRemaining - 1u) >> 3u), bitOffsetRight)) & (bitsRemaining >= 8u ? 0xFFu : (0xFFu >> (8u - bitsRemaining))))
-                     << (bitLength - bitsRemaining);
+        bitextract::insertFromRight(end, element.bitOffset, 32u, iodd_generated::float32Bits(value.float32));
+    }
+}
 
-        bitsOld = static_cast<int>(bitsRemaining);
-        bitsRemaining -= 8;
+void IoddService::insertInteger(uint8_t *end, const PlanElement &element, const IolValue &value)
+{
+    if ((64 >= element.bitLength) && (2 <= element.bitLength))
+    {
+        bitextract::insertFromRight(end, element.bitOffset, element.bitLength, static_cast<uint64_t>(value.integer));
+    }
+}
 
-    } while (8 < bitsOld); // No more bits remaining
+void IoddService::insertOctets(uint8_t *end, const PlanElement &element, const IolValue &value)
+{
+    // StringT and OctetStringT, shorter values are filled with 0x00
+    if (!(element.bitOffset & 7u) && !(element.bitLength & 7u))
+    {
+        iodd_generated::copyOctets(end - (element.bitOffset + element.bitLength) / 8u, element.bitLength / 8u, value);
+    }
+}
 
-    return returnVal;
+void IoddService::insertTime(uint8_t *end, const PlanElement &element, const IolValue &value)
+{
+    if (element.bitLength == 64u)
+    {
+        bitextract::insertFromRight(end, element.bitOffset, 64u, nsToIolTime(value.integer));
+    }
 }
-IolDataReturn_t IoddService::getProcessDataVar(const ProcessDataElement &dataItem, const uint8_t *data, std::size_t dataLength)
+
+void IoddService::insertTimeSpan(uint8_t *end, const PlanElement &element, const IolValue &value)
 {
-    const auto *const pProcessData = reinterpret_cast<const uint8_t *const>(data);
-    uint16_t bitOffset = dataLength * 8 - dataItem.bitOffset - dataItem.bitLength;
-    // Sanity check
-    if (data == nullptr || dataItem.bitLength == 0)
+    if (element.bitLength == 64u)
     {
-        return "Invalid";
+        bitextract::insertFromRight(end, element.bitOffset, 64u, nsToIolTimeSpan(value.integer));
     }
+}
+
+// indexed by IolType
+const IoddService::Inserter IoddService::inserters_[static_cast<std::size_t>(IolType::Count)] = {
+    &IoddService::insertInvalid,  // Invalid
+    &IoddService::insertBoolean,  // BooleanT
+    &IoddService::insertUInteger, // UIntegerT
+    &IoddService::insertFloat32,  // Float32T
+    &IoddService::insertInteger,  // IntegerT
+    &IoddService::insertOctets,   // StringT
+    &IoddService::insertOctets,   // OctetStringT
+    &IoddService::insertTime,     // TimeT
+    &IoddService::insertTimeSpan, // TimeSpanT
+};
 
-    if (dataItem.type == "BooleanT")
+/**
+ * \brief Writes values into process data, the counterpart of decode().
+ *
+ * Only the elements with a value of their type are written, Invalid values
+ * keep the bits of the element. So a few fields of the PD can be changed.
+ *
+ * \param plan decode plan of the PD out of the device
+ * \param values plan.elements.size() raw (unscaled) values
+ * \param data process data, first byte is the most significant one
+ * \param dataLength number of process data bytes
+ * \return false if data is too short for the plan, nothing is written then
+ */
+bool IoddService::encode(const DecodePlan &plan, const IolValue *values, uint8_t *data, std::size_t dataLength)
+{
+    if (data == nullptr)
+    {
+        dataLength = 0;
+    }
+    if (plan.encode != nullptr)
     {
-        return static_cast<bool>(pProcessData[bitOffset >> 3u] & (1u << (7u - (bitOffset & 7u))));
+        return plan.encode(values, data, dataLength);
     }
-    if (dataItem.type == "UIntegerT")
+    const std::size_t count = plan.elements.size();
+    for (std::size_t i = 0; i < count; i++)
     {
-        if ((64 >= dataItem.bitLength) && (2 <= dataItem.bitLength))
+        const PlanElement &element = plan.elements[i];
+        if ((values[i].type == element.type) && ((element.bitOffset + element.bitLength) > dataLength * 8u))
         {
-            return getUInt64(pProcessData + (bitOffset >> 3u), dataItem.bitLength, bitOffset & 7u);
+            return false;
         }
-        return "Invalid";
     }
-    if (dataItem.type == "Float32T")
+    uint8_t *const end = data + dataLength;
+    for (std::size_t i = 0; i < count; i++)
     {
-        // This type is always byte-aligned, even inside a RecordT.
-        if (!(dataItem.bitOffset & 7u))
+        const PlanElement &element = plan.elements[i];
+        if ((values[i].type == element.type) && (element.type < IolType::Count))
         {
-            // Get pointer to first byte
-            const uint8_t *const p = pProcessData + (bitOffset >> 3u);
-
-            // Convert byte order and align to 4-byte boundary.
-            // An uint32_t is used because it is the same size.
-            const uint32_t tempIntVal = static_cast<uint32_t>((p[0] << 24u)) | static_cast<uint32_t>((p[1] << 16u)) | static_cast<uint32_t>((p[2] << 8u)) | static_cast<uint32_t>(p[3]);
-
-            // Force the bytes from tempIntVal to be treated as a float.
-            // This avoids an attempt to convert the value.  The next line
-            // suppresses the cppcheck error message.
-            // cppcheck-suppress invalidPointerCast
-            return *reinterpret_cast<const float *>(&tempIntVal);
+            inserters_[static_cast<std::size_t>(element.type)](end, element, values[i]);
         }
-        return "Invalid";
     }
-    return "Invalid";
+    return true;
 }
 
-std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(const std::vector<ProcessDataElement> iodd, const uint8_t *data, std::size_t dataLength, uint16_t conditionVariable)
+/**
+ * \brief Extracts all elements of many samples, e.g. out of the PD history.
+ *
+ * If all samples have the same length (the normal case for a history), the
+ * elements are decoded one by one over all samples. The type dispatch happens
+ * once per element, the inner loops only shift and mask. The samples are
+ * decoded in place, the members in front of PDSample::data serve as padding
+ * for the loads.
+ *
+ * \param plan decode plan of the device
+ * \param samples samples to decode
+ * \param values output, samples.size() * plan.elements.size() entries,
+ * sample by sample
+ */
+void IoddService::decodeBatch(const DecodePlan &plan, Span<const PDSample> samples, IolValue *values)
 {
+    static_assert(offsetof(PDSample, data) >= bitextract::PADDING, "PDSample::data needs padding in front");
+    const std::size_t count = plan.elements.size();
+    if (samples.empty())
+    {
+        return;
+    }
+    const std::size_t length = samples[0].length;
+    bool sameLength = (length <= PD_MAX_LENGTH);
+    for (const PDSample &sample : samples)
+    {
+        sameLength = sameLength && (sample.length == length);
+    }
 
-    // Initialize json
-    nlohmann::json values(nlohmann::detail::value_t::object);
-    nlohmann::json units(nlohmann::detail::value_t::object);
-
-    for (ProcessDataElement element : iodd)
+    if (!sameLength || (plan.decode != nullptr))
     {
-        std::string key = element.key;
-        IolDataReturn_t variable = getProcessDataVar(element, data, dataLength);
-        ProcessDataInfo_t *processDataInfo = &element.processDataInfo;
-        // Boolean
-        if (std::holds_alternative<bool>(variable))
-        {
-            values[key] = std::get<bool>(variable);
-            // Uint
-        }
-        else if (std::holds_alternative<uint64_t>(variable))
+        for (const PDSample &sample : samples)
         {
-            if (processDataInfo)
+            const std::size_t sampleLength = (sample.length <= PD_MAX_LENGTH) ? sample.length : 0u;
+            if ((plan.decode == nullptr) || !plan.decode(sample.data, sampleLength, values))
             {
-
-                values[key] = processDataInfo->gradient * std::get<uint64_t>(variable) + processDataInfo->offset;
+                decodeRecord(plan, sample.data + sampleLength, sampleLength, values);
             }
-            else
-            {
-                values[key] = std::get<uint64_t>(variable);
-            }
-            // Int
+            values += count;
         }
-        else if (std::holds_alternative<int64_t>(variable))
+        return;
+    }
+
+    // blocks keep the written values in the cache while the columns are filled
+    constexpr std::size_t BLOCK_SAMPLES = 32u;
+    for (std::size_t first = 0; first < samples.size(); first += BLOCK_SAMPLES)
+    {
+        const Span<const PDSample> block = samples.subspan(first, std::min(BLOCK_SAMPLES, samples.size() - first));
+        IolValue *blockValues = values + first * count;
+        for (std::size_t i = 0; i < count; i++)
         {
-            if (processDataInfo)
+            const PlanElement &element = plan.elements[i];
+            auto column = [&block, blockValues, i, count, length, &element](auto extract) {
+                IolValue *value = blockValues + i;
+                for (const PDSample &sample : block)
+                {
+                    *value = extract(sample.data + length, element);
+                    value += count;
+                }
+            };
+            if ((element.bitLength == 0) || ((element.bitOffset + element.bitLength) > length * 8u))
             {
-                values[key] = processDataInfo->gradient * std::get<int64_t>(variable) + processDataInfo->offset;
+                column(extractInvalid);
+                continue;
             }
-            else
+            switch (element.type)
             {
-                values[key] = std::get<int64_t>(variable);
+            case IolType::BooleanT:
+                column(extractBoolean);
+                break;
+            case IolType::UIntegerT:
+                column(extractUInteger);
+                break;
+            case IolType::Float32T:
+                column(extractFloat32);
+                break;
+            case IolType::IntegerT:
+                column(extractInteger);
+                break;
+            case IolType::StringT:
+                column(extractString);
+                break;
+            case IolType::OctetStringT:
+                column(extractOctetString);
+                break;
+            case IolType::TimeT:
+                column(extractTime);
+                break;
+            case IolType::TimeSpanT:
+                column(extractTimeSpan);
+                break;
+            default:
+                column(extractInvalid);
+                break;
             }
-            // Float
         }
-        else if (std::holds_alternative<float>(variable))
-        {
-            if (processDataInfo)
-            {
+    }
+}
 
-                values[key] = processDataInfo->gradient * std::get<float>(variable) + processDataInfo->offset;
-            }
-            else
+/**
+ * \brief Scales decoded values and names them by their keys.
+ *
+ * \param plan decode plan the values were decoded with
+ * \param values plan.elements.size() values
+ * \return JSON object, "Invalid" for values that couldn't be decoded. Numbers
+ * are scaled, OctetStringT is an array of bytes, TimeT (ns since epoch) and
+ * TimeSpanT (ns) are integers.
+ */
+nlohmann::json IoddService::toJson(const DecodePlan &plan, const IolValue *values)
+{
+    nlohmann::json result(nlohmann::detail::value_t::object);
+    const std::size_t count = plan.elements.size();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const PlanElement &element = plan.elements[i];
+        const IolValue &variable = values[i];
+        nlohmann::json &value = result[plan.keys[element.keyIndex]];
+        switch (variable.type)
+        {
+        case IolType::BooleanT:
+            value = variable.boolean;
+            break;
+        case IolType::UIntegerT:
+            value = element.gradient * variable.uinteger + element.offset;
+            break;
+        case IolType::IntegerT:
+            value = element.gradient * variable.integer + element.offset;
+            break;
+        case IolType::Float32T:
+            value = element.gradient * variable.float32 + element.offset;
+            break;
+        case IolType::StringT:
+            value = std::string(variable.string());
+            break;
+        case IolType::OctetStringT:
+            value = nlohmann::json::array();
+            for (uint8_t octet : variable.octets())
             {
-                values[key] = std::get<float>(variable);
+                value.push_back(octet);
             }
-            // String
-        }
-        else if (std::holds_alternative<std::string>(variable))
-        {
-            values[key] = std::get<std::string>(variable);
-            // OctetString
-        }
-        else if (std::holds_alternative<std::list<char>>(variable))
-        {
-            values[key] = std::get<std::list<char>>(variable);
-            // TimeSpanT
-        }
-        else if (std::holds_alternative<long double>(variable))
-        {
-            values[key] = std::get<long double>(variable);
-            // TimeT
+            break;
+        case IolType::TimeT:
+        case IolType::TimeSpanT:
+            value = variable.integer;
+            break;
+        default:
+            value = "Invalid";
+            break;
         }
     }
-    return std::make_tuple(values, units);
+    return result;
 }
 
-std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(std::vector<uint8_t> rawProcessData, uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID)
+/**
+ * \brief Looks up the decode plan of a device.
+ *
+ * \return the plan, nullptr if the device is unknown
+ */
+std::shared_ptr<const DecodePlan> IoddService::findPlan(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const
 {
-    uint16_t condition = 0;
+    return findPlan(*registry_, PDDirection::In, VendorID, DeviceID, RevisionID);
+}
 
+/**
+ * \brief Looks up the plan of the PD out of a device, for encode().
+ *
+ * \return the plan, nullptr if the device is unknown
+ */
+std::shared_ptr<const DecodePlan> IoddService::findOutPlan(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const
+{
+    return findPlan(*outRegistry_, PDDirection::Out, VendorID, DeviceID, RevisionID);
+}
+
+/**
+ * \brief Looks up a plan, compiles it from the installed IODDs on the first use.
+ *
+ * Builtin layouts take precedence over installed IODDs.
+ */
+std::shared_ptr<const DecodePlan> IoddService::findPlan(DecodePlanRegistry &registry, PDDirection direction, uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID) const
+{
+    std::shared_ptr<const DecodePlan> plan = registry.find(VendorID, DeviceID, RevisionID);
     std::vector<ProcessDataElement> elements;
+    if (!plan && loader_ && loader_->find(VendorID, DeviceID, direction, elements))
+    {
+        registry.add(VendorID, DeviceID, DecodePlanRegistry::ANY_REVISION, elements);
+        plan = registry.find(VendorID, DeviceID, RevisionID);
+    }
+    return plan;
+}
+
+/**
+ * \brief Makes the IODD files of a directory available for decoding.
+ *
+ * Has to be called before the process data is processed.
+ *
+ * \param directory directory with the IODD files (*.xml)
+ * \param cacheFile binary cache, rebuilt if the directory changed
+ * \return false if no IODD could be loaded
+ */
+bool IoddService::loadIodds(const std::string &directory, const std::string &cacheFile)
+{
+    auto loader = std::make_shared<IoddLoader>();
+    const bool loaded = loader->load(directory, cacheFile);
+    loader_ = loaded ? loader : nullptr;
+    return loaded;
+}
+
+/**
+ * \brief Indices of the variables the installed IODD of a device declares
+ * read-only, they can be served from the parameter cache.
+ *
+ * \param indices output, the indices of the device
+ * \return false if no IODD of the device is installed or it has none
+ */
+bool IoddService::findReadOnly(uint16_t VendorID, uint32_t DeviceID, std::vector<uint16_t> &indices) const
+{
+    indices.clear();
+    return loader_ && loader_->findReadOnly(VendorID, DeviceID, indices);
+}
 
+/**
+ * \brief Decodes process data by walking a compiled plan.
+ *
+ * \param plan decode plan of the device
+ * \param data process data, first byte is the most significant one
+ * \param dataLength number of process data bytes
+ * \return the values and the units (not filled yet) as JSON objects
+ */
+std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(const DecodePlan &plan, const uint8_t *data, std::size_t dataLength)
+{
+    nlohmann::json units(nlohmann::detail::value_t::object);
+
+    const std::size_t count = plan.elements.size();
+    IolValue stackVariables[64];
+    std::vector<IolValue> heapVariables;
+    IolValue *variables = stackVariables;
+    if (count > (sizeof(stackVariables) / sizeof(stackVariables[0])))
+    {
+        heapVariables.resize(count);
+        variables = heapVariables.data();
+    }
+    decode(plan, data, dataLength, variables);
+    nlohmann::json values = toJson(plan, variables);
+    return std::make_tuple(values, units);
+}
+
+/**
+ * \brief Process data layouts of the supported Balluff devices.
+ *
+ * Also the input of the code generator (tools/IoddCodegen.cpp).
+ */
+std::vector<IoddLayout> IoddService::builtinLayouts()
+{
     std::vector<ProcessDataElement> SmartlightElements = {};
     ProcessDataElement TI_PD_Blinking_Segment1;
     ProcessDataElement TI_PD_Color_Segment1;
@@ -234,38 +574,38 @@ std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(std
     ProcessDataElement TI_PD_SyncStart;
     TI_PD_Blinking_Segment1.key = "TI_PD_Blinking_Segment1";
     TI_PD_Blinking_Segment1.subindex = 1;
-    TI_PD_Blinking_Segment1.type = "BooleanT";
+    TI_PD_Blinking_Segment1.type = IolType::BooleanT;
     TI_PD_Blinking_Segment1.bitOffset = 11;
     TI_PD_Color_Segment1.key = "TI_PD_Color_Segment1";
     TI_PD_Color_Segment1.subindex = 2;
-    TI_PD_Color_Segment1.type = "UIntegerT";
+    TI_PD_Color_Segment1.type = IolType::UIntegerT;
     TI_PD_Color_Segment1.bitLength = 3;
     TI_PD_Color_Segment1.bitOffset = 8;
     TI_PD_Blinking_Segment2.key = "TI_PD_Blinking_Segment2";
     TI_PD_Blinking_Segment2.subindex = 3;
-    TI_PD_Blinking_Segment2.type = "BooleanT";
+    TI_PD_Blinking_Segment2.type = IolType::BooleanT;
     TI_PD_Blinking_Segment2.bitOffset = 15;
     TI_PD_Color_Segment2.key = "TI_PD_Color_Segment2";
     TI_PD_Color_Segment2.subindex = 4;
-    TI_PD_Color_Segment2.type = "UIntegerT";
+    TI_PD_Color_Segment2.type = IolType::UIntegerT;
     TI_PD_Color_Segment2.bitLength = 3;
     TI_PD_Color_Segment2.bitOffset = 12;
     TI_PD_Blinking_Segment3.key = "TI_PD_Blinking_Segment3";
     TI_PD_Blinking_Segment3.subindex = 5;
-    TI_PD_Blinking_Segment3.type = "BooleanT";
+    TI_PD_Blinking_Segment3.type = IolType::BooleanT;
     TI_PD_Blinking_Segment3.bitOffset = 3;
     TI_PD_Color_Segment3.key = "TI_PD_Color_Segment3";
     TI_PD_Color_Segment3.subindex = 6;
-    TI_PD_Color_Segment3.type = "UIntegerT";
+    TI_PD_Color_Segment3.type = IolType::UIntegerT;
     TI_PD_Color_Segment3.bitLength = 3;
     TI_PD_Color_Segment3.bitOffset = 0;
     TI_PD_SyncImp.key = "TI_PD_SyncImp";
     TI_PD_SyncImp.subindex = 8;
-    TI_PD_SyncImp.type = "BooleanT";
+    TI_PD_SyncImp.type = IolType::BooleanT;
     TI_PD_SyncImp.bitOffset = 6;
     TI_PD_SyncStart.key = "TI_PD_SyncStart";
     TI_PD_SyncStart.subindex = 9;
-    TI_PD_SyncStart.type = "BooleanT";
+    TI_PD_SyncStart.type = IolType::BooleanT;
     TI_PD_SyncStart.bitOffset = 5;
 
     SmartlightElements.push_back(TI_PD_Blinking_Segment1);
@@ -282,7 +622,7 @@ std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(std
     ProcessDataElement TI_PD_Level;
     TI_PD_Level.key = "TI_PD_Level";
     TI_PD_Level.subindex = 1;
-    TI_PD_Level.type = "UIntegerT";
+    TI_PD_Level.type = IolType::UIntegerT;
     TI_PD_Level.bitLength = 3;
     TI_PD_Level.bitOffset = 2;
 
@@ -293,28 +633,28 @@ std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(std
     ProcessDataElement TI_TargetPosition;
     TI_TargetPosition.key = "TI_TargetPosition";
     TI_TargetPosition.subindex = 1;
-    TI_TargetPosition.type = "UIntegerT";
+    TI_TargetPosition.type = IolType::UIntegerT;
     TI_TargetPosition.bitLength = 3;
     TI_TargetPosition.bitOffset = 4;
     ProcessDataElement TI_OutOfRangeBit;
     TI_OutOfRangeBit.key = "TI_OutOfRangeBit";
     TI_OutOfRangeBit.subindex = 2;
-    TI_OutOfRangeBit.type = "BooleanT";
+    TI_OutOfRangeBit.type = IolType::BooleanT;
     TI_OutOfRangeBit.bitOffset = 3;
     ProcessDataElement TI_BinaryChannel3;
     TI_BinaryChannel3.key = "TI_BinaryChannel3";
     TI_BinaryChannel3.subindex = 3;
-    TI_BinaryChannel3.type = "BooleanT";
+    TI_BinaryChannel3.type = IolType::BooleanT;
     TI_BinaryChannel3.bitOffset = 2;
     ProcessDataElement TI_BinaryChannel2;
     TI_BinaryChannel2.key = "TI_BinaryChannel2";
     TI_BinaryChannel2.subindex = 4;
-    TI_BinaryChannel2.type = "BooleanT";
+    TI_BinaryChannel2.type = IolType::BooleanT;
     TI_BinaryChannel2.bitOffset = 1;
     ProcessDataElement TI_BinaryChannel1;
     TI_BinaryChannel1.key = "TI_BinaryChannel1";
     TI_BinaryChannel1.subindex = 5;
-    TI_BinaryChannel1.type = "BooleanT";
+    TI_BinaryChannel1.type = IolType::BooleanT;
     TI_BinaryChannel1.bitOffset = 0;
 
     BawElements.push_back(TI_TargetPosition);
@@ -328,47 +668,47 @@ std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(std
     ProcessDataElement TN_PDI_SSC1;
     TN_PDI_SSC1.key = "TN_PDI_SSC1";
     TN_PDI_SSC1.subindex = 1;
-    TN_PDI_SSC1.type = "BooleanT";
+    TN_PDI_SSC1.type = IolType::BooleanT;
     TN_PDI_SSC1.bitOffset = 0;
     ProcessDataElement TN_PDI_OUT_OF_RANGE;
     TN_PDI_OUT_OF_RANGE.key = "TN_PDI_OUT_OF_RANGE";
     TN_PDI_OUT_OF_RANGE.subindex = 2;
-    TN_PDI_OUT_OF_RANGE.type = "BooleanT";
+    TN_PDI_OUT_OF_RANGE.type = IolType::BooleanT;
     TN_PDI_OUT_OF_RANGE.bitOffset = 1;
     ProcessDataElement TN_PDI_SPEED_TOO_LOW;
     TN_PDI_SPEED_TOO_LOW.key = "TN_PDI_SPEED_TOO_LOW";
     TN_PDI_SPEED_TOO_LOW.subindex = 3;
-    TN_PDI_SPEED_TOO_LOW.type = "BooleanT";
+    TN_PDI_SPEED_TOO_LOW.type = IolType::BooleanT;
     TN_PDI_SPEED_TOO_LOW.bitOffset = 2;
     ProcessDataElement TN_PDI_SPEED_TOO_HIGH;
     TN_PDI_SPEED_TOO_HIGH.key = "TN_PDI_SPEED_TOO_HIGH";
     TN_PDI_SPEED_TOO_HIGH.subindex = 4;
-    TN_PDI_SPEED_TOO_HIGH.type = "BooleanT";
+    TN_PDI_SPEED_TOO_HIGH.type = IolType::BooleanT;
     TN_PDI_SPEED_TOO_HIGH.bitOffset = 3;
     ProcessDataElement TN_PDI_TEACH_ACTIVE;
     TN_PDI_TEACH_ACTIVE.key = "TN_PDI_TEACH_ACTIVE";
     TN_PDI_TEACH_ACTIVE.subindex = 5;
-    TN_PDI_TEACH_ACTIVE.type = "BooleanT";
+    TN_PDI_TEACH_ACTIVE.type = IolType::BooleanT;
     TN_PDI_TEACH_ACTIVE.bitOffset = 4;
     ProcessDataElement TN_PDI_TEACH_SUCCESS;
     TN_PDI_TEACH_SUCCESS.key = "TN_PDI_TEACH_SUCCESS";
     TN_PDI_TEACH_SUCCESS.subindex = 6;
-    TN_PDI_TEACH_SUCCESS.type = "BooleanT";
+    TN_PDI_TEACH_SUCCESS.type = IolType::BooleanT;
     TN_PDI_TEACH_SUCCESS.bitOffset = 5;
     ProcessDataElement TN_PDI_TEACH_ERROR;
     TN_PDI_TEACH_ERROR.key = "TN_PDI_TEACH_ERROR";
     TN_PDI_TEACH_ERROR.subindex = 7;
-    TN_PDI_TEACH_ERROR.type = "BooleanT";
+    TN_PDI_TEACH_ERROR.type = IolType::BooleanT;
     TN_PDI_TEACH_ERROR.bitOffset = 6;
     ProcessDataElement TN_PDI_COUNT_LIMIT;
     TN_PDI_COUNT_LIMIT.key = "TN_PDI_COUNT_LIMIT";
     TN_PDI_COUNT_LIMIT.subindex = 8;
-    TN_PDI_COUNT_LIMIT.type = "BooleanT";
+    TN_PDI_COUNT_LIMIT.type = IolType::BooleanT;
     TN_PDI_COUNT_LIMIT.bitOffset = 7;
     ProcessDataElement TN_PDI_COUNT;
     TN_PDI_COUNT.key = "TN_PDI_COUNT";
     TN_PDI_COUNT.subindex = 9;
-    TN_PDI_COUNT.type = "UIntegerT";
+    TN_PDI_COUNT.type = IolType::UIntegerT;
     TN_PDI_COUNT.bitOffset = 8;
     TN_PDI_COUNT.bitLength = 16;
 
@@ -387,264 +727,298 @@ std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(std
     ProcessDataElement TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X;
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X.key = "TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X";
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X.subindex = 1;
-    TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X.type = "Float32T";
+    TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X.type = IolType::Float32T;
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X.bitOffset = 128;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_X);
     ProcessDataElement TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y;
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y.key = "TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y";
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y.subindex = 2;
-    TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y.type = "Float32T";
+    TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y.type = IolType::Float32T;
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y.bitOffset = 96;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Y);
     ProcessDataElement TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z;
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z.key = "TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z";
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z.subindex = 3;
-    TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z.type = "Float32T";
+    TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z.type = IolType::Float32T;
     TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z.bitOffset = 64;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_Vibration_Veloc_RMS_v_RMS_Z);
     ProcessDataElement TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp;
     TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp.key = "TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp";
     TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp.subindex = 4;
-    TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp.type = "Float32T";
+    TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp.type = IolType::Float32T;
     TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp.bitOffset = 32;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_Contact_Temp_Contact_Temp);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status.subindex = 5;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status.bitOffset = 31;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_X_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status.subindex = 6;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status.bitOffset = 30;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_X_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status.subindex = 7;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status.bitOffset = 29;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Y_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status.subindex = 8;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status.bitOffset = 28;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Y_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status.subindex = 9;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status.bitOffset = 27;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_Z_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status.subindex = 10;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status.bitOffset = 26;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_Z_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status.subindex = 11;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status.bitOffset = 25;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_a_RMS_M_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status.subindex = 12;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status.bitOffset = 24;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_a_RMS_M_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status.subindex = 13;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status.bitOffset = 23;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_X_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status.subindex = 14;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status.bitOffset = 22;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_X_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status.subindex = 15;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status.bitOffset = 21;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Y_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status.subindex = 16;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status.bitOffset = 20;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Y_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status.subindex = 17;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status.bitOffset = 19;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_Z_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status.subindex = 18;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status.bitOffset = 18;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_Z_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status.key = "TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status";
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status.subindex = 19;
-    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status.bitOffset = 17;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_PreAlarm_v_RMS_M_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status.key = "TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status";
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status.subindex = 20;
-    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status.bitOffset = 16;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_MainAlarm_v_RMS_M_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Reserved;
     TI_PD_In_Vibration_Veloc_SB_Reserved.key = "TI_PD_In_Vibration_Veloc_SB_Reserved";
     TI_PD_In_Vibration_Veloc_SB_Reserved.subindex = 21;
-    TI_PD_In_Vibration_Veloc_SB_Reserved.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Reserved.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Reserved.bitOffset = 15;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Reserved);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A.key = "TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A";
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A.subindex = 22;
-    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A.bitOffset = 14;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_A);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B.key = "TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B";
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B.subindex = 23;
-    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B.bitOffset = 13;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_B);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C.key = "TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C";
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C.subindex = 24;
-    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C.bitOffset = 12;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_C);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D.key = "TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D";
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D.subindex = 25;
-    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D.bitOffset = 11;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Vibration_Severity_Zone_D);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Reserved1;
     TI_PD_In_Vibration_Veloc_SB_Reserved1.key = "TI_PD_In_Vibration_Veloc_SB_Reserved1";
     TI_PD_In_Vibration_Veloc_SB_Reserved1.subindex = 26;
-    TI_PD_In_Vibration_Veloc_SB_Reserved1.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Reserved1.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Reserved1.bitOffset = 10;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Reserved1);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Reserved2;
     TI_PD_In_Vibration_Veloc_SB_Reserved2.key = "TI_PD_In_Vibration_Veloc_SB_Reserved2";
     TI_PD_In_Vibration_Veloc_SB_Reserved2.subindex = 27;
-    TI_PD_In_Vibration_Veloc_SB_Reserved2.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Reserved2.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Reserved2.bitOffset = 9;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Reserved2);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Reserved3;
     TI_PD_In_Vibration_Veloc_SB_Reserved3.key = "TI_PD_In_Vibration_Veloc_SB_Reserved3";
     TI_PD_In_Vibration_Veloc_SB_Reserved3.subindex = 28;
-    TI_PD_In_Vibration_Veloc_SB_Reserved3.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Reserved3.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Reserved3.bitOffset = 8;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Reserved3);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status;
     TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status.key = "TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status";
     TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status.subindex = 29;
-    TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status.bitOffset = 7;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Lower_Alarm_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status;
     TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status.key = "TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status";
     TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status.subindex = 30;
-    TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status.bitOffset = 6;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Contact_Temp_Upper_Alarm_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Reserved4;
     TI_PD_In_Vibration_Veloc_SB_Reserved4.key = "TI_PD_In_Vibration_Veloc_SB_Reserved4";
     TI_PD_In_Vibration_Veloc_SB_Reserved4.subindex = 31;
-    TI_PD_In_Vibration_Veloc_SB_Reserved4.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Reserved4.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Reserved4.bitOffset = 5;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Reserved4);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Reserved5;
     TI_PD_In_Vibration_Veloc_SB_Reserved5.key = "TI_PD_In_Vibration_Veloc_SB_Reserved5";
     TI_PD_In_Vibration_Veloc_SB_Reserved5.subindex = 32;
-    TI_PD_In_Vibration_Veloc_SB_Reserved5.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Reserved5.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Reserved5.bitOffset = 4;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Reserved5);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status;
     TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status.key = "TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status";
     TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status.subindex = 33;
-    TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status.bitOffset = 3;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_AmbPressure_Lower_Alarm_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status;
     TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status.key = "TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status";
     TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status.subindex = 35;
-    TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status.bitOffset = 2;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_AmbPressure_Upper_Alarm_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status;
     TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status.key = "TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status";
     TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status.subindex = 37;
-    TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status.bitOffset = 1;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Humidty_Lower_Alarm_Status);
     ProcessDataElement TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status;
     TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status.key = "TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status";
     TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status.subindex = 39;
-    TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status.type = "BooleanT";
+    TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status.type = IolType::BooleanT;
     TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status.bitOffset = 0;
     BcmElements.push_back(TI_PD_In_Vibration_Veloc_SB_Humidity_Upper_Alarm_Status);
 
-    if (DeviceID == 330242)
-    {
-        for (size_t i = 0; i < SmartlightElements_1.size(); i++)
-        {
-            setBitLength(&SmartlightElements_1[i]);
-            elements.push_back(SmartlightElements_1[i]);
-        }
-    }
+    std::vector<IoddLayout> layouts;
+    auto addLayout = [&layouts](uint32_t DeviceID, PDDirection direction, std::vector<ProcessDataElement> elements) {
+        IoddLayout layout;
+        layout.vendorId = VENDOR_ID_BALLUFF;
+        layout.deviceId = DeviceID;
+        layout.direction = direction;
+        layout.elements = std::move(elements);
+        layouts.push_back(std::move(layout));
+    };
+    // Smartlight: level in, segment colors/blinking out
+    addLayout(330242, PDDirection::In, SmartlightElements_1);
+    addLayout(330242, PDDirection::Out, SmartlightElements);
+    // BCM, the elements are listed from the last to the first one
+    addLayout(917762, PDDirection::In, std::vector<ProcessDataElement>(BcmElements.rbegin(), BcmElements.rend()));
+    addLayout(131330, PDDirection::In, BawElements);
+    addLayout(132099, PDDirection::In, BesElements);
+    return layouts;
+}
 
-    if (DeviceID == 917762)
+/**
+ * \brief Compiles the builtin layouts into plans.
+ *
+ * Called once by the constructor, the decoder only uses the compiled plans.
+ * Decoders generated at build time replace the plans of their devices.
+ */
+void IoddService::registerBuiltinPlans()
+{
+    for (const IoddLayout &layout : builtinLayouts())
     {
-        for (size_t i = 0; i < BcmElements.size(); i++)
-        {
-            setBitLength(&BcmElements[BcmElements.size() - 1 - i]);
-            elements.push_back(BcmElements[BcmElements.size() - 1 - i]);
-        }
+        DecodePlanRegistry &registry = (layout.direction == PDDirection::In) ? *registry_ : *outRegistry_;
+        registry.add(layout.vendorId, layout.deviceId, DecodePlanRegistry::ANY_REVISION, layout.elements);
     }
-
-    if (DeviceID == 131330)
+#ifdef IODD_GENERATED
+    for (std::size_t i = 0; i < iodd_generated::layoutCount; i++)
     {
-        for (size_t i = 0; i < BawElements.size(); i++)
+        const GeneratedLayout &layout = iodd_generated::layouts[i];
+        std::vector<ProcessDataElement> elements(layout.elementCount);
+        for (std::size_t j = 0; j < layout.elementCount; j++)
         {
-            setBitLength(&BawElements[i]);
-            elements.push_back(BawElements[i]);
+            const GeneratedElement &generated = layout.elements[j];
+            elements[j].key = generated.key;
+            elements[j].type = generated.type;
+            elements[j].bitOffset = generated.bitOffset;
+            elements[j].bitLength = generated.bitLength;
+            elements[j].subindex = generated.subindex;
+            elements[j].processDataInfo.gradient = generated.gradient;
+            elements[j].processDataInfo.offset = generated.offset;
         }
+        DecodePlanRegistry &registry = (layout.direction == PDDirection::In) ? *registry_ : *outRegistry_;
+        registry.add(layout.vendorId, layout.deviceId, DecodePlanRegistry::ANY_REVISION, elements, layout.decode, layout.encode);
     }
+#endif
+}
 
-    if (DeviceID == 132099)
-    {
-        for (size_t i = 0; i < BesElements.size(); i++)
-        {
-            setBitLength(&BesElements[i]);
-            elements.push_back(BesElements[i]);
-        }
-    }
+IoddService::IoddService()
+    : registry_(std::make_shared<DecodePlanRegistry>()),
+      outRegistry_(std::make_shared<DecodePlanRegistry>())
+{
+    registerBuiltinPlans();
+}
 
-    try
-    {
-        const std::tuple<nlohmann::json, nlohmann::json> transformedData = interpretProcessData(elements, rawProcessData.data(), rawProcessData.size(), condition);
-        return transformedData;
-    }
-    catch (int e)
+/**
+ * \brief Registers the process data layout of a device (e.g. read from its IODD).
+ *
+ * \param RevisionID IO-Link revision, DecodePlanRegistry::ANY_REVISION for all
+ */
+void IoddService::registerPlan(uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID, const std::vector<ProcessDataElement> &elements)
+{
+    registry_->add(VendorID, DeviceID, RevisionID, elements);
+}
+
+std::tuple<nlohmann::json, nlohmann::json> IoddService::interpretProcessData(PDView rawProcessData, uint16_t VendorID, uint32_t DeviceID, uint8_t RevisionID)
+{
+    std::shared_ptr<const DecodePlan> plan = findPlan(*registry_, PDDirection::In, VendorID, DeviceID, RevisionID);
+    if (!plan)
     {
-        const std::tuple<nlohmann::json, nlohmann::json> emptyJson;
-        return emptyJson;
+        // unknown device, the caller publishes the raw data
+        return std::make_tuple(nlohmann::json(nlohmann::detail::value_t::object), nlohmann::json(nlohmann::detail::value_t::object));
     }
-}
\ No newline at end of file
+    return interpretProcessData(*plan, rawProcessData.data(), rawProcessData.size());
+}
@@ -0,0 +1,160 @@
+#include "JsonTemplate.h"
+#include <charconv>
+#include <cmath>
+#include <map>
+#include <nlohmann/json.hpp>
+/*!
+ * @file JsonTemplate.cpp
+ * @brief JSON payload of a decode plan, serialized from a precomputed template
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+/**
+ * \brief Precomputes the members of the payload.
+ *
+ * nlohmann keeps the members of an object sorted by key and a later
+ * assignment to a key replaces the earlier one, the template does the same.
+ *
+ * \param plan decode plan the values passed to serialize() are decoded with
+ * \param timestampKey member holding the timestamp
+ */
+JsonTemplate::JsonTemplate(std::shared_ptr<const DecodePlan> plan, const std::string &timestampKey)
+    : plan_(std::move(plan))
+{
+    std::map<std::string, std::size_t> members;
+    for (std::size_t i = 0; i < plan_->elements.size(); i++)
+    {
+        members[plan_->keys[plan_->elements[i].keyIndex]] = i;
+    }
+    members[timestampKey] = TIMESTAMP;
+
+    fields_.reserve(members.size());
+    for (const auto &member : members)
+    {
+        Field field;
+        field.prefix = fields_.empty() ? "{" : ",";
+        field.prefix += nlohmann::json(member.first).dump();
+        field.prefix += ':';
+        field.element = member.second;
+        fields_.push_back(std::move(field));
+    }
+}
+
+/**
+ * \brief Writes the payload, byte-identical to
+ * toJson(plan, values) with timestampKey set to timestamp, dump()ed.
+ *
+ * \param values plan()->elements.size() values
+ * \param timestamp value of the timestamp member
+ * \param out cleared and filled with the payload
+ */
+void JsonTemplate::serialize(const IolValue *values, const std::string &timestamp, std::string &out) const
+{
+    out.clear();
+    for (const Field &field : fields_)
+    {
+        out += field.prefix;
+        if (field.element == TIMESTAMP)
+        {
+            appendString(timestamp, out);
+            continue;
+        }
+        const PlanElement &element = plan_->elements[field.element];
+        const IolValue &variable = values[field.element];
+        switch (variable.type)
+        {
+        case IolType::BooleanT:
+            out += variable.boolean ? "true" : "false";
+            break;
+        case IolType::UIntegerT:
+            appendNumber(element.gradient * variable.uinteger + element.offset, out);
+            break;
+        case IolType::Float32T:
+            appendNumber(element.gradient * variable.float32 + element.offset, out);
+            break;
+        case IolType::IntegerT:
+            appendNumber(element.gradient * variable.integer + element.offset, out);
+            break;
+        case IolType::StringT:
+            appendString(variable.string(), out);
+            break;
+        case IolType::OctetStringT:
+            appendOctets(variable.octets(), out);
+            break;
+        case IolType::TimeT:
+        case IolType::TimeSpanT:
+            appendInteger(variable.integer, out);
+            break;
+        default:
+            out += "\"Invalid\"";
+            break;
+        }
+    }
+    out += '}';
+}
+
+/**
+ * \brief Appends a number as nlohmann dumps a number_float_t: shortest
+ * round-trip representation, null if not finite.
+ *
+ * std::to_chars can't be used, libstdc++ 10 lacks the floating point overloads
+ * and its output differs from dump() (no ".0" for integral values).
+ */
+void JsonTemplate::appendNumber(double value, std::string &out)
+{
+    if (!std::isfinite(value))
+    {
+        out += "null";
+        return;
+    }
+    char buffer[64];
+    char *end = nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+/** \brief Appends an integer as nlohmann dumps a number_integer_t. */
+void JsonTemplate::appendInteger(int64_t value, std::string &out)
+{
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+/** \brief Appends bytes as array of numbers. */
+void JsonTemplate::appendOctets(PDView octets, std::string &out)
+{
+    out += '[';
+    for (std::size_t i = 0; i < octets.size(); i++)
+    {
+        if (i != 0u)
+        {
+            out += ',';
+        }
+        appendInteger(octets[i], out);
+    }
+    out += ']';
+}
+
+/**
+ * \brief Appends a quoted string, escaped as by dump().
+ *
+ * Printable ASCII (the timestamps) is copied, everything else is left to
+ * nlohmann. Invalid UTF-8 from a device is replaced instead of throwing.
+ */
+void JsonTemplate::appendString(std::string_view value, std::string &out)
+{
+    for (const char c : value)
+    {
+        if ((c < 0x20) || (c > 0x7e) || (c == '"') || (c == '\\'))
+        {
+            out += nlohmann::json(std::string(value)).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            return;
+        }
+    }
+    out += '"';
+    out += value;
+    out += '"';
+}
@@ -0,0 +1,267 @@
+/*!
+ * @file LatencyHistogram.cpp
+ * @brief Lock-free histogram of durations with logarithmic (power of two)
+ *        buckets, filled by one thread and read by any other.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "LatencyHistogram.h"
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    LatencyHistogram
+//!*******************************************************************************
+//!  \brief        Constructor for LatencyHistogram, starts empty
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+//!*******************************************************************************
+//!  function :    LatencyHistogram
+//!*******************************************************************************
+//!  \brief        Copy constructor, only while the histogram isn't filled
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                histogram to copy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+LatencyHistogram::LatencyHistogram(const LatencyHistogram &other)
+{
+    copyFrom(other);
+}
+
+//!*******************************************************************************
+//!  function :    operator=
+//!*******************************************************************************
+//!  \brief        Copy assignment, only while the histogram isn't filled
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                histogram to copy
+//!
+//!  \return       reference to this histogram
+//!
+//!*******************************************************************************
+LatencyHistogram &LatencyHistogram::operator=(const LatencyHistogram &other)
+{
+    if (this != &other)
+    {
+        copyFrom(other);
+    }
+    return *this;
+}
+
+//!*******************************************************************************
+//!  function :    ~LatencyHistogram
+//!*******************************************************************************
+//!  \brief        Destructor for LatencyHistogram
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+//!*******************************************************************************
+//!  function :    copyFrom
+//!*******************************************************************************
+//!  \brief        Copies all counters of another histogram
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                histogram to copy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void LatencyHistogram::copyFrom(const LatencyHistogram &other)
+{
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        buckets_[i].store(other.buckets_[i].load(memory_order_relaxed), memory_order_relaxed);
+    }
+    count_.store(other.count_.load(memory_order_relaxed), memory_order_relaxed);
+    sum_.store(other.sum_.load(memory_order_relaxed), memory_order_relaxed);
+    min_.store(other.min_.load(memory_order_relaxed), memory_order_relaxed);
+    max_.store(other.max_.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    add
+//!*******************************************************************************
+//!  \brief        Counts one duration
+//!
+//!  \type         local
+//!
+//!  \param[in]    duration_ns          duration in ns
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void LatencyHistogram::add(uint64_t duration_ns)
+{
+    uint64_t us = duration_ns / 1000u;
+    size_t bucket = 0;
+    while ((us != 0) && (bucket < LATENCY_BUCKETS - 1))
+    {
+        us >>= 1;
+        bucket++;
+    }
+    buckets_[bucket].fetch_add(1, memory_order_relaxed);
+    sum_.fetch_add(duration_ns, memory_order_relaxed);
+    uint64_t current = min_.load(memory_order_relaxed);
+    while ((duration_ns < current) && !min_.compare_exchange_weak(current, duration_ns, memory_order_relaxed))
+    {
+    }
+    current = max_.load(memory_order_relaxed);
+    while ((duration_ns > current) && !max_.compare_exchange_weak(current, duration_ns, memory_order_relaxed))
+    {
+    }
+    count_.fetch_add(1, memory_order_release);
+}
+
+//!*******************************************************************************
+//!  function :    reset
+//!*******************************************************************************
+//!  \brief        Clears all counters
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void LatencyHistogram::reset()
+{
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        buckets_[i].store(0, memory_order_relaxed);
+    }
+    sum_.store(0, memory_order_relaxed);
+    min_.store(UINT64_MAX, memory_order_relaxed);
+    max_.store(0, memory_order_relaxed);
+    count_.store(0, memory_order_release);
+}
+
+//!*******************************************************************************
+//!  function :    count
+//!*******************************************************************************
+//!  \brief        Returns the number of counted durations
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       count
+//!
+//!*******************************************************************************
+uint64_t LatencyHistogram::count() const
+{
+    return count_.load(memory_order_acquire);
+}
+
+//!*******************************************************************************
+//!  function :    percentile
+//!*******************************************************************************
+//!  \brief        Upper bound of the bucket containing the percentile
+//!
+//!  \type         local
+//!
+//!  \param[in]    percent              e.g. 99.0
+//!
+//!  \return       duration in us, 0 if empty
+//!
+//!*******************************************************************************
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    uint64_t total = 0;
+    uint64_t counts[LATENCY_BUCKETS];
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        counts[i] = buckets_[i].load(memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = uint64_t(double(total) * percent / 100.0);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen > rank)
+        {
+            return uint64_t(1) << i;
+        }
+    }
+    return uint64_t(1) << (LATENCY_BUCKETS - 1);
+}
+
+//!*******************************************************************************
+//!  function :    toJson
+//!*******************************************************************************
+//!  \brief        Statistics and the non-empty buckets as JSON. The bucket key
+//!                is its upper bound in us.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       nlohmann::json
+//!
+//!*******************************************************************************
+nlohmann::json LatencyHistogram::toJson() const
+{
+    nlohmann::json jsonobject;
+    uint64_t total = count();
+    jsonobject["Count"] = total;
+    jsonobject["Min"] = (total > 0) ? min_.load(memory_order_relaxed) / 1000u : 0; // us
+    jsonobject["Max"] = max_.load(memory_order_relaxed) / 1000u;
+    jsonobject["Mean"] = (total > 0) ? (sum_.load(memory_order_relaxed) / total) / 1000u : 0;
+    jsonobject["P50"] = percentile(50.0);
+    jsonobject["P99"] = percentile(99.0);
+    jsonobject["Buckets"] = nlohmann::json::object();
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        uint64_t bucketCount = buckets_[i].load(memory_order_relaxed);
+        if (bucketCount > 0)
+        {
+            jsonobject["Buckets"][to_string(uint64_t(1) << i)] = bucketCount;
+        }
+    }
+    return jsonobject;
+}
@@ -25,6 +25,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <stdio.h>
+#include <chrono>
 
 //!**** Macros ******************************************************************
 constexpr uint8_t read = 0b00000001;
@@ -59,6 +60,7 @@ Max14819::Max14819()
     comSpeedRegA = 0;
     comSpeedRegB = 0;
     Hardware = nullptr;
+    busMutex_ = nullptr;
 }
 
 //!******************************************************************************
@@ -83,6 +85,7 @@ Max14819::Max14819(DriverSelect driver, HardwareRaspberry *hardware)
     comSpeedRegA = 0;
     comSpeedRegB = 0;
     Hardware = hardware;
+    busMutex_ = nullptr;
 }
 //!******************************************************************************
 //!  function :    	~max14819() destructor
@@ -99,6 +102,51 @@ Max14819::Max14819(DriverSelect driver, HardwareRaspberry *hardware)
 Max14819::~Max14819()
 {
 }
+
+//!******************************************************************************
+//!  function :    	setBusMutex
+//!******************************************************************************
+//! \brief        	Sets the mutex of the chip. It is locked for every SPI
+//!                 transaction, so the sleeps of begin() and wakeUpRequest()
+//!                 don't block the other port of the chip. Users that need
+//!                 several transactions in a row lock it around them.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     busMutex        recursive mutex of the chip, nullptr: none
+//!
+//!  \return        void
+//!
+//!******************************************************************************
+void Max14819::setBusMutex(recursive_mutex *busMutex)
+{
+    busMutex_ = busMutex;
+}
+
+//!******************************************************************************
+//!  function :    	transfer
+//!******************************************************************************
+//! \brief        	One SPI transaction (command and data byte) with the
+//!                 chip mutex held
+//!
+//!  \type         	local
+//!
+//!  \param[in]     channel         SPI channel of the chip
+//!  \param[in,out] buf             2 bytes, the answer is written back
+//!
+//!  \return        void
+//!
+//!******************************************************************************
+void Max14819::transfer(uint8_t channel, uint8_t *buf)
+{
+    if (busMutex_ == nullptr)
+    {
+        Hardware->SPI_Write(channel, buf, 2);
+        return;
+    }
+    lock_guard<recursive_mutex> lock(*busMutex_);
+    Hardware->SPI_Write(channel, buf, 2);
+}
 //!******************************************************************************
 //!  function :    	begin
 //!******************************************************************************
@@ -491,12 +539,12 @@ uint8_t Max14819::wakeUpRequest(PortSelect port, uint32_t *comSpeed_ret)
             comReqRunning &= EstCom;
             timeOutCounter++;
             Hardware->wait_for(1);
-            if (timeOutCounter > INIT_WURQ_TIMEOUT)
-            {
-                Hardware->Serial_Write("WAKEUP-Timeout-Error\n");
-                // retValue = uint8_t(retValue | writeRegister(RxFIFORst, 1));
-            }
-        } while (comReqRunning || (timeOutCounter < INIT_WURQ_TIMEOUT));
+        } while (comReqRunning && (timeOutCounter < INIT_WURQ_TIMEOUT));
+        if (comReqRunning)
+        {
+            Hardware->Serial_Write("WAKEUP-Timeout-Error\n");
+            // retValue = uint8_t(retValue | writeRegister(RxFIFORst, 1));
+        }
 
         Hardware->wait_for(10);
         // Clear buffer
@@ -533,7 +581,7 @@ uint8_t Max14819::wakeUpRequest(PortSelect port, uint32_t *comSpeed_ret)
             comReqRunning &= EstCom;
             timeOutCounter++;
             Hardware->wait_for(2);
-        } while (comReqRunning || (timeOutCounter < INIT_WURQ_TIMEOUT));
+        } while (comReqRunning && (timeOutCounter < INIT_WURQ_TIMEOUT));
 
         Hardware->wait_for(10);
         // Clear buffer
@@ -633,7 +681,7 @@ uint8_t Max14819::readRegister(uint8_t reg)
     buf[1] = 0x00;
 
     // Send the device the register you want to read:
-    Hardware->SPI_Write(channel, buf, 2);
+    transfer(channel, buf);
 
     // Return Registervalue
     return buf[1];
@@ -689,7 +737,7 @@ uint8_t Max14819::writeRegister(uint8_t reg, uint8_t data)
     // Send SPI telegram
     buf[0] = reg;
     buf[1] = data;
-    Hardware->SPI_Write(channel, buf, 2);
+    transfer(channel, buf);
 
     // Return Error state
     return retValue;
@@ -713,10 +761,33 @@ uint8_t Max14819::writeRegister(uint8_t reg, uint8_t data)
 //!
 //!******************************************************************************
 uint8_t Max14819::writeISDU(uint8_t mc, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port, vector<uint8_t> &isduDataFrame, uint8_t ProcessDataOut, vector<uint8_t> completeframe)
+{
+    return writeISDU(mc, sizeAnswer, mSeqType, port, isduDataFrame.data(), uint8_t(isduDataFrame.size()));
+}
+
+//!******************************************************************************
+//!  function :    	writeISDU
+//!******************************************************************************
+//!  \brief         Sends one ISDU segment (PDout followed by the OD bytes) to
+//!                 the device
+//!
+//!  \type          local
+//!
+//!  \param[in]     uint8_t mc			master command
+//!  \param[in]     sizeAnswer	        size in byte of answer
+//!  \param[in]     mSeqType            m-sequence type depending
+//!  \param[in]     port		        port to send data
+//!  \param[in]     *pData              pointer to the segment (PDout + OD)
+//!  \param[in]     sizeData	        size in Byte of the segment
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::writeISDU(uint8_t mc, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port, uint8_t *pData, uint8_t sizeData)
 {
     uint8_t retValue = SUCCESS;
     uint8_t bufferRegister;
-    uint8_t sizeDataSend = isduDataFrame.size() + 2; // +2 for MC and CKT
+    uint8_t sizeDataSend = uint8_t(sizeData + 2); // +2 for MC and CKT
     if ((sizeDataSend) > MAX_MSG_LENGTH)
     { // include 1 byte master command and 1 byte for checksum
         return ERROR;
@@ -736,20 +807,13 @@ uint8_t Max14819::writeISDU(uint8_t mc, uint8_t sizeAnswer, uint8_t mSeqType, Po
         break;
     }
     // Write message to max14819 FIFO
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeAnswer + 1)); // number of bytes for answer +1 CKS
-    cout << "buffer: " << int(sizeAnswer + 1) << endl;
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeDataSend /*+2*/)); // number of bytes to send including master command and checksum (+2)
-    cout << "buffer: " << int(sizeDataSend) << endl;
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, mc)); // begin of message, master command
-    cout << "buffer: " << int(mc) << endl;
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, calculateCKT(mc, mSeqType, isduDataFrame)));
-    cout << "buffer: " << int(calculateCKT(mc, mSeqType, isduDataFrame)) << endl;
-    cout << "Send: ";
-    for (auto const &value : isduDataFrame)
+    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeAnswer + 1));                              // number of bytes for answer +1 CKS
+    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeDataSend));                                // number of bytes to send including master command and checksum (+2)
+    retValue = uint8_t(retValue | writeRegister(bufferRegister, mc));                                          // begin of message, master command
+    retValue = uint8_t(retValue | writeRegister(bufferRegister, calculateCKT(mc, pData, sizeData, mSeqType))); // second byte of message, checksum (CKT)
+    for (uint8_t i = 0; i < sizeData; i++)
     {
-        cout << int(value) << ", ";
-        retValue = uint8_t(retValue | writeRegister(bufferRegister, value));
-        cout << "buffervalue: " << int(value) << endl;
+        retValue = uint8_t(retValue | writeRegister(bufferRegister, pData[i]));
     }
     switch (port)
     {
@@ -818,6 +882,91 @@ uint8_t Max14819::readISDU(vector<uint8_t> &oData, uint8_t sizeData, PortSelect
     // Return Error state
     return retValue;
 }
+//!******************************************************************************
+//!  function :    	readISDU
+//!******************************************************************************
+//!  \brief        	Reads the OD bytes of one ISDU segment out of the FIFO into
+//!                 a caller supplied buffer. Remaining bytes of the message
+//!                 (process data) are read out to leave the FIFO empty.
+//!
+//!  \type         	local
+//!
+//!  \param[out]    *pData              pointer to the segment buffer
+//!  \param[in]     sizeData            number of OD bytes
+//!  \param[in]     port                driver PORTA or PORTB
+//!
+//!  \return       	0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::readISDU(uint8_t *pData, uint8_t sizeData, PortSelect port)
+{
+    uint8_t bufferRegister;
+    uint8_t retValue = SUCCESS;
+    // Use corresponding transmit FIFO address
+    switch (port)
+    {
+    case PORTA:
+        bufferRegister = TxRxDataA;
+        break;
+    case PORTB:
+        bufferRegister = TxRxDataB;
+        break;
+    default:
+        return ERROR;
+    }
+    uint8_t length = readRegister(bufferRegister);
+    if (length < sizeData)
+    {
+        retValue = ERROR;
+    }
+    // Read data from FIFO
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint8_t value = readRegister(bufferRegister);
+        if (i < sizeData)
+        {
+            pData[i] = value;
+        }
+    }
+    for (uint8_t i = length; i < sizeData; i++)
+    {
+        pData[i] = 0;
+    }
+    // Return Error state
+    return retValue;
+}
+
+//!******************************************************************************
+//!  function :    	waitForAnswer
+//!******************************************************************************
+//!  \brief        	Polls the receive FIFO level until the answer of the device
+//!                 has arrived (length byte + data, see buffer clear in
+//!                 wakeUpRequest) or the timeout is reached. Replaces fixed
+//!                 delays between request and read out.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port                driver PORTA or PORTB
+//!  \param[in]     sizeAnswer          expected number of data bytes
+//!  \param[in]     timeout_ms          maximum time to wait
+//!
+//!  \return       	0 if the answer has arrived, 1 on timeout
+//!
+//!******************************************************************************
+uint8_t Max14819::waitForAnswer(PortSelect port, uint8_t sizeAnswer, uint32_t timeout_ms)
+{
+    uint8_t levelRegister = (port == PORTA) ? RxFIFOLvlA : RxFIFOLvlB;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    do
+    {
+        if (readRegister(levelRegister) > sizeAnswer)
+        {
+            return SUCCESS;
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+    return ERROR;
+}
+
 //!******************************************************************************
 //!  function :    	readPD
 //!******************************************************************************
@@ -833,9 +982,66 @@ uint8_t Max14819::readISDU(vector<uint8_t> &oData, uint8_t sizeData, PortSelect
 //!
 //!******************************************************************************
 uint8_t Max14819::readPD(vector<uint8_t> &pData, uint8_t sizeData, PortSelect port, uint8_t sizeOD)
+{
+    int16_t cks;
+    return readPD(pData, sizeData, port, sizeOD, nullptr, cks);
+}
+
+//!******************************************************************************
+//!  function :    	readPD
+//!******************************************************************************
+//!  \brief        	readMessage from device, additionally returns the OD bytes
+//!                 and the CKS byte (Event flag, PD status) if the driver
+//!                 delivers it behind the message
+//!
+//!  \type         	local
+//!
+//!  \param[in]     *pData              pointer to data
+//!  \param[in]     sizeData            size of data
+//!  \param[in]     port                driver PORTA or PORTB
+//!  \param[in]     sizeOD              number of OD bytes in front of the PD
+//!  \param[out]    *pOD                buffer for the OD bytes, may be nullptr
+//!  \param[out]    &cks                CKS byte of the message, -1 if not available
+//!
+//!  \return       	0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::readPD(vector<uint8_t> &pData, uint8_t sizeData, PortSelect port, uint8_t sizeOD, uint8_t *pOD, int16_t &cks)
+{
+    uint8_t buffer[MAX_MSG_LENGTH];
+    uint8_t length = 0;
+    uint8_t retValue = readPD(buffer, length, sizeData, port, sizeOD, pOD, cks);
+    // first byte defines the length of the data
+    pData.push_back(length);
+    pData.insert(pData.end(), buffer, buffer + length);
+    return retValue;
+}
+
+//!******************************************************************************
+//!  function :    	readPD
+//!******************************************************************************
+//!  \brief        	readMessage from device directly into a buffer of the
+//!                 caller, the PD bytes without any length prefix
+//!
+//!  \type         	local
+//!
+//!  \param[out]    *pData              buffer for the PD, MAX_MSG_LENGTH bytes
+//!  \param[out]    &length             number of PD bytes written to pData
+//!  \param[in]     sizeData            size of data
+//!  \param[in]     port                driver PORTA or PORTB
+//!  \param[in]     sizeOD              number of OD bytes in front of the PD
+//!  \param[out]    *pOD                buffer for the OD bytes, may be nullptr
+//!  \param[out]    &cks                CKS byte of the message, -1 if not available
+//!
+//!  \return       	0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::readPD(uint8_t *pData, uint8_t &length, uint8_t sizeData, PortSelect port, uint8_t sizeOD, uint8_t *pOD, int16_t &cks)
 {
     uint8_t bufferRegister;
     uint8_t retValue = SUCCESS;
+    cks = -1;
+    length = 0;
     // Use corresponding transmit FIFO address
     switch (port)
     {
@@ -850,26 +1056,38 @@ uint8_t Max14819::readPD(vector<uint8_t> &pData, uint8_t sizeData, PortSelect po
         bufferRegister = 0;
         break;
     }
-    int length = readRegister(bufferRegister);
+    int fifoLength = readRegister(bufferRegister);
     // cout<<"length"<<length<<endl;
     //  Control if the answer has the expected length (first byte in the FIFO is the message length)
-    if (sizeData != length)
+    //  One byte more means the CKS byte has been stored behind the message
+    bool withCKS = (fifoLength == sizeData + 1);
+    if ((sizeData != fifoLength) && !withCKS)
     {
         // cout << "Length: " << length << " Expected length: " << int(sizeData) << endl;
         retValue = ERROR;
         // Return Error state
         //        return retValue;
     }
-    pData.push_back(length - sizeOD);
+    int sizeMessage = withCKS ? sizeData : fifoLength;
     // Read data from FIFO
-    for (uint8_t i = 0; i < length; i++)
+    for (int i = 0; i < fifoLength; i++)
     {
-        if (i >= sizeOD)
+        uint8_t value = readRegister(bufferRegister);
+        if (i >= sizeMessage)
+        {
+            cks = value;
+        }
+        else if (i >= sizeOD)
         {
-            pData.push_back(readRegister(bufferRegister));
+            if (length < MAX_MSG_LENGTH)
+            {
+                pData[length++] = value;
+            }
+        }
+        else if (pOD != nullptr)
+        {
+            pOD[i] = value; // OD data of the message
         }
-        else
-            readRegister(bufferRegister); // read out ODData which transfer also PDData unnecessarily
     }
     // Return Error state
     return retValue;
@@ -1563,43 +1781,70 @@ uint8_t Max14819::readCQ(PortSelect port)
 uint8_t Max14819::writeCQ(PortSelect port, uint8_t value)
 {
     uint8_t retValue = SUCCESS;
+    uint8_t ioRegister;
 
     switch (port)
     {
     case PORTA:
-        // Set Port A CQ level
-        switch (value)
-        {
-        case HIGH:
-            retValue = uint8_t(retValue | writeRegister(IOStCfgA, TxEn | Tx));
-            retValue = uint8_t(retValue | writeRegister(LCnfgA, LRT0 | LBL0 | LBL1 | LClimDis));
-            break;
-        case LOW:
-            retValue = uint8_t(retValue | writeRegister(IOStCfgA, TxEn));
-            retValue = uint8_t(retValue | writeRegister(LCnfgA, LRT0 | LBL0 | LBL1 | LClimDis | LEn));
-            break;
-        default:
-            retValue = ERROR;
-            break;
-        } // switch(value)
+        ioRegister = IOStCfgA;
         break;
     case PORTB:
-        // Set Port B CQ level
-        switch (value)
-        {
-        case HIGH:
-            retValue = uint8_t(retValue | writeRegister(IOStCfgB, TxEn | Tx));
-            retValue = uint8_t(retValue | writeRegister(LCnfgB, LRT0 | LBL0 | LBL1 | LClimDis));
-            break;
-        case LOW:
-            retValue = uint8_t(retValue | writeRegister(IOStCfgB, TxEn));
-            retValue = uint8_t(retValue | writeRegister(LCnfgB, LRT0 | LBL0 | LBL1 | LClimDis | LEn));
-            break;
-        default:
-            retValue = ERROR;
-            break;
-        }
+        ioRegister = IOStCfgB;
+        break;
+    default:
+        return ERROR;
+    }
+    // keep the DI configuration (lower 4 bits) and the L+ supply of the sensor
+    uint8_t shadowReg = readRegister(ioRegister) & 0x0F;
+    switch (value)
+    {
+    case HIGH:
+        retValue = uint8_t(retValue | writeRegister(ioRegister, shadowReg | TxEn | Tx));
+        break;
+    case LOW:
+        retValue = uint8_t(retValue | writeRegister(ioRegister, shadowReg | TxEn));
+        break;
+    default:
+        retValue = ERROR;
+        break;
+    }
+    return retValue;
+}
+//!******************************************************************************
+//!  function :     configureSIO
+//!******************************************************************************
+//!  \brief         Switches the CQ line of a port to standard IO (SIO) mode.
+//!                 The framer is disabled, the CQ driver is enabled for an
+//!                 output resp. disabled for an input. L+ stays switched on.
+//!
+//!  \param[in]     port            PORTA or PORTB
+//!  \param[in]     output          1: CQ is an output, 0: CQ is an input
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::configureSIO(PortSelect port, uint8_t output)
+{
+    uint8_t retValue = SUCCESS;
+    uint8_t channelRegister;
+    uint8_t ioRegister;
+
+    switch (port)
+    {
+    case PORTA:
+        channelRegister = ChanStatA;
+        ioRegister = IOStCfgA;
+        break;
+    case PORTB:
+        channelRegister = ChanStatB;
+        ioRegister = IOStCfgB;
+        break;
+    default:
+        return ERROR;
     }
+    retValue = uint8_t(retValue | writeRegister(channelRegister, 0)); // Disable framer, no IO-Link communication
+    uint8_t shadowReg = readRegister(ioRegister) & 0x0F;             // keep DI configuration
+    retValue = uint8_t(retValue | writeRegister(ioRegister, output ? uint8_t(shadowReg | TxEn) : shadowReg));
     return retValue;
 }
 //!******************************************************************************
@@ -0,0 +1,310 @@
+/*!
+ * @file PDHistory.cpp
+ * @brief Preallocated ring buffer of the last received PD frames of a port,
+ *        queried lock-free by time range or sequence number.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "PDHistory.h"
+#include <algorithm>
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    PDHistory
+//!*******************************************************************************
+//!  \brief        Constructor, allocates all slots up front so the cycle never
+//!                allocates
+//!
+//!  \type         local
+//!
+//!  \param[in]    depth                number of samples kept (at least 2)
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+PDHistory::PDHistory(size_t depth)
+    : slots_(depth < 2 ? 2 : depth),
+      newest_(0)
+{
+}
+
+//!*******************************************************************************
+//!  function :    PDHistory
+//!*******************************************************************************
+//!  \brief        Copy constructor, only while the history isn't in use
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                history to copy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+PDHistory::PDHistory(const PDHistory &other)
+    : slots_(other.slots_),
+      newest_(other.newest_.load(memory_order_acquire))
+{
+}
+
+//!*******************************************************************************
+//!  function :    operator=
+//!*******************************************************************************
+//!  \brief        Copy assignment, only while the history isn't in use
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                history to copy
+//!
+//!  \return       reference to this history
+//!
+//!*******************************************************************************
+PDHistory &PDHistory::operator=(const PDHistory &other)
+{
+    if (this != &other)
+    {
+        slots_ = other.slots_;
+        newest_.store(other.newest_.load(memory_order_acquire), memory_order_release);
+    }
+    return *this;
+}
+
+//!*******************************************************************************
+//!  function :    ~PDHistory
+//!*******************************************************************************
+//!  \brief        Destructor for PDHistory
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+PDHistory::~PDHistory()
+{
+}
+
+//!*******************************************************************************
+//!  function :    push
+//!*******************************************************************************
+//!  \brief        Stores a sample, overwriting the oldest one. The sequence
+//!                numbers of the pushed samples have to increase by one.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               received PD frame
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PDHistory::push(const PDSample &sample)
+{
+    if (sample.sequence == 0)
+    {
+        return;
+    }
+    slots_[sample.sequence % slots_.size()].write(sample);
+    newest_.store(sample.sequence, memory_order_release);
+}
+
+//!*******************************************************************************
+//!  function :    depth
+//!*******************************************************************************
+//!  \brief        Returns the number of samples the history can hold
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       depth
+//!
+//!*******************************************************************************
+size_t PDHistory::depth() const
+{
+    return slots_.size();
+}
+
+//!*******************************************************************************
+//!  function :    newestSequence
+//!*******************************************************************************
+//!  \brief        Returns the sequence number of the newest sample, 0 if empty
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       sequence number
+//!
+//!*******************************************************************************
+uint64_t PDHistory::newestSequence() const
+{
+    return newest_.load(memory_order_acquire);
+}
+
+//!*******************************************************************************
+//!  function :    readSlot
+//!*******************************************************************************
+//!  \brief        Reads the sample with the given sequence number
+//!
+//!  \type         local
+//!
+//!  \param[in]    sequence             sequence number of the sample
+//!  \param[out]   sample               sample read
+//!
+//!  \return       false if the sample was already overwritten or not written yet
+//!
+//!*******************************************************************************
+bool PDHistory::readSlot(uint64_t sequence, PDSample &sample) const
+{
+    sample = slots_[sequence % slots_.size()].read();
+    return sample.sequence == sequence;
+}
+
+//!*******************************************************************************
+//!  function :    oldestSequence
+//!*******************************************************************************
+//!  \brief        Returns the sequence number of the oldest sample still held
+//!
+//!  \type         local
+//!
+//!  \param[in]    newest               sequence number of the newest sample
+//!
+//!  \return       sequence number
+//!
+//!*******************************************************************************
+uint64_t PDHistory::oldestSequence(uint64_t newest) const
+{
+    return (newest >= slots_.size()) ? (newest - slots_.size() + 1) : 1;
+}
+
+//!*******************************************************************************
+//!  function :    findTime
+//!*******************************************************************************
+//!  \brief        Binary search for the first sample at or after the timestamp.
+//!                A slot overwritten during the search counts as too old.
+//!
+//!  \type         local
+//!
+//!  \param[in]    timestamp            ns since epoch
+//!  \param[in]    oldest               first sequence number to search
+//!  \param[in]    newest               last sequence number to search
+//!
+//!  \return       sequence number, newest + 1 if there is no such sample
+//!
+//!*******************************************************************************
+uint64_t PDHistory::findTime(uint64_t timestamp, uint64_t oldest, uint64_t newest) const
+{
+    uint64_t low = oldest;
+    uint64_t high = newest + 1;
+    PDSample sample;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (!readSlot(middle, sample) || (sample.timestamp < timestamp))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+//!*******************************************************************************
+//!  function :    querySequence
+//!*******************************************************************************
+//!  \brief        Copies the samples starting at a sequence number. Samples
+//!                overwritten while reading are skipped.
+//!
+//!  \type         local
+//!
+//!  \param[in]    fromSequence         first sequence number wanted
+//!  \param[in]    step                 downsampling, every step-th sample
+//!  \param[in]    maxCount             maximum number of samples returned
+//!  \param[out]   samples              samples, oldest first
+//!
+//!  \return       number of samples appended
+//!
+//!*******************************************************************************
+size_t PDHistory::querySequence(uint64_t fromSequence, size_t step, size_t maxCount, vector<PDSample> &samples) const
+{
+    uint64_t newest = newestSequence();
+    uint64_t sequence = max(fromSequence, oldestSequence(newest));
+    size_t count = 0;
+    PDSample sample;
+    if (step == 0)
+    {
+        step = 1;
+    }
+    for (; (sequence <= newest) && (count < maxCount); sequence += step)
+    {
+        if (readSlot(sequence, sample))
+        {
+            samples.push_back(sample);
+            count++;
+        }
+    }
+    return count;
+}
+
+//!*******************************************************************************
+//!  function :    queryTime
+//!*******************************************************************************
+//!  \brief        Copies the samples acquired within a time range
+//!
+//!  \type         local
+//!
+//!  \param[in]    fromTimestamp        start of the range, ns since epoch
+//!  \param[in]    toTimestamp          end of the range (included), ns since epoch
+//!  \param[in]    step                 downsampling, every step-th sample
+//!  \param[in]    maxCount             maximum number of samples returned
+//!  \param[out]   samples              samples, oldest first
+//!
+//!  \return       number of samples appended
+//!
+//!*******************************************************************************
+size_t PDHistory::queryTime(uint64_t fromTimestamp, uint64_t toTimestamp, size_t step, size_t maxCount, vector<PDSample> &samples) const
+{
+    uint64_t newest = newestSequence();
+    if (newest == 0)
+    {
+        return 0;
+    }
+    uint64_t sequence = findTime(fromTimestamp, oldestSequence(newest), newest);
+    size_t count = 0;
+    PDSample sample;
+    if (step == 0)
+    {
+        step = 1;
+    }
+    for (; (sequence <= newest) && (count < maxCount); sequence += step)
+    {
+        if (readSlot(sequence, sample))
+        {
+            if (sample.timestamp > toTimestamp)
+            {
+                break;
+            }
+            samples.push_back(sample);
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,728 @@
+#include "PDOutValues.h"
+#include <cmath>
+#include <cstring>
+#include <string_view>
+/*!
+ * @file PDOutValues.cpp
+ * @brief PD out values named by field, parsed from JSON or a binary payload
+ *        and packed by IoddService::encode()
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+namespace
+{
+
+/** \brief Scalar or head of a container, read from any of the inputs. */
+struct Item
+{
+    enum class Kind : uint8_t
+    {
+        Null,
+        Boolean,
+        Unsigned,
+        Negative,
+        Float,
+        Text,
+        Bytes,
+        Array,
+        Map,
+    };
+
+    Kind kind = Kind::Null;
+    bool boolean = false;
+    uint64_t uinteger = 0;          // Unsigned, number of items of Array and Map
+    int64_t integer = 0;            // Negative, always < 0
+    double number = 0.0;            // Float
+    const uint8_t *data = nullptr;  // Text, Bytes
+    std::size_t length = 0;
+};
+
+/** \brief Sequential reads of big-endian integers out of a buffer. */
+class Input
+{
+public:
+    Input(const uint8_t *data, std::size_t length) : position_(data), end_(data + length) {}
+
+    bool atEnd() const { return position_ == end_; }
+
+protected:
+    bool byte(uint8_t &value)
+    {
+        if (position_ == end_)
+        {
+            return false;
+        }
+        value = *position_++;
+        return true;
+    }
+
+    bool bigEndian(unsigned bytes, uint64_t &value)
+    {
+        if (static_cast<std::size_t>(end_ - position_) < bytes)
+        {
+            return false;
+        }
+        value = 0;
+        while (bytes-- > 0u)
+        {
+            value = (value << 8u) | *position_++;
+        }
+        return true;
+    }
+
+    bool block(uint64_t length, Item &item)
+    {
+        if (static_cast<uint64_t>(end_ - position_) < length)
+        {
+            return false;
+        }
+        item.data = position_;
+        item.length = static_cast<std::size_t>(length);
+        position_ += length;
+        return true;
+    }
+
+    static double float32(uint64_t bits)
+    {
+        const uint32_t bits32 = static_cast<uint32_t>(bits);
+        float value;
+        std::memcpy(&value, &bits32, sizeof(value));
+        return value;
+    }
+
+    static double float64(uint64_t bits)
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static void setInteger(int64_t value, Item &item)
+    {
+        if (value < 0)
+        {
+            item.kind = Item::Kind::Negative;
+            item.integer = value;
+        }
+        else
+        {
+            item.kind = Item::Kind::Unsigned;
+            item.uinteger = static_cast<uint64_t>(value);
+        }
+    }
+
+private:
+    const uint8_t *position_;
+    const uint8_t *end_;
+};
+
+/** \brief RFC 8949 items with definite lengths, tags aren't supported. */
+class CborReader : public Input
+{
+public:
+    using Input::Input;
+
+    bool next(Item &item)
+    {
+        item = Item();
+        uint8_t initial;
+        if (!byte(initial))
+        {
+            return false;
+        }
+        const unsigned major = initial >> 5u;
+        const unsigned info = initial & 0x1Fu;
+        uint64_t argument = info;
+        if ((info >= 24u) && ((info > 27u) || !bigEndian(1u << (info - 24u), argument)))
+        {
+            return false; // indefinite length or truncated
+        }
+        switch (major)
+        {
+        case 0u:
+            item.kind = Item::Kind::Unsigned;
+            item.uinteger = argument;
+            return true;
+        case 1u:
+            if (argument > static_cast<uint64_t>(INT64_MAX))
+            {
+                return false;
+            }
+            item.kind = Item::Kind::Negative;
+            item.integer = -1 - static_cast<int64_t>(argument);
+            return true;
+        case 2u:
+            item.kind = Item::Kind::Bytes;
+            return block(argument, item);
+        case 3u:
+            item.kind = Item::Kind::Text;
+            return block(argument, item);
+        case 4u:
+            item.kind = Item::Kind::Array;
+            item.uinteger = argument;
+            return true;
+        case 5u:
+            item.kind = Item::Kind::Map;
+            item.uinteger = argument;
+            return true;
+        case 7u:
+            return simple(info, argument, item);
+        default:
+            return false;
+        }
+    }
+
+private:
+    static bool simple(unsigned info, uint64_t argument, Item &item)
+    {
+        switch (info)
+        {
+        case 20u:
+        case 21u:
+            item.kind = Item::Kind::Boolean;
+            item.boolean = (info == 21u);
+            return true;
+        case 22u: // null
+        case 23u: // undefined
+            return true;
+        case 25u:
+            item.kind = Item::Kind::Float;
+            item.number = half(static_cast<uint16_t>(argument));
+            return true;
+        case 26u:
+            item.kind = Item::Kind::Float;
+            item.number = float32(argument);
+            return true;
+        case 27u:
+            item.kind = Item::Kind::Float;
+            item.number = float64(argument);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static double half(uint16_t bits)
+    {
+        const int exponent = (bits >> 10u) & 0x1F;
+        const int mantissa = bits & 0x3FF;
+        double value;
+        if (exponent == 0)
+        {
+            value = std::ldexp(mantissa, -24);
+        }
+        else if (exponent == 0x1F)
+        {
+            value = (mantissa != 0) ? NAN : INFINITY;
+        }
+        else
+        {
+            value = std::ldexp(mantissa + 1024, exponent - 25);
+        }
+        return (bits & 0x8000u) ? -value : value;
+    }
+};
+
+/** \brief MessagePack items, extension types aren't supported. */
+class MsgPackReader : public Input
+{
+public:
+    using Input::Input;
+
+    bool next(Item &item)
+    {
+        item = Item();
+        uint8_t format;
+        if (!byte(format))
+        {
+            return false;
+        }
+        uint64_t value = 0;
+        if (format <= 0x7Fu)
+        {
+            item.kind = Item::Kind::Unsigned;
+            item.uinteger = format;
+            return true;
+        }
+        if (format >= 0xE0u)
+        {
+            setInteger(static_cast<int8_t>(format), item);
+            return true;
+        }
+        if (format <= 0x8Fu)
+        {
+            item.kind = Item::Kind::Map;
+            item.uinteger = format & 0x0Fu;
+            return true;
+        }
+        if (format <= 0x9Fu)
+        {
+            item.kind = Item::Kind::Array;
+            item.uinteger = format & 0x0Fu;
+            return true;
+        }
+        if (format <= 0xBFu)
+        {
+            item.kind = Item::Kind::Text;
+            return block(format & 0x1Fu, item);
+        }
+        switch (format)
+        {
+        case 0xC0u:
+            return true;
+        case 0xC2u:
+        case 0xC3u:
+            item.kind = Item::Kind::Boolean;
+            item.boolean = (format == 0xC3u);
+            return true;
+        case 0xC4u: // bin 8, 16, 32
+        case 0xC5u:
+        case 0xC6u:
+            item.kind = Item::Kind::Bytes;
+            return bigEndian(1u << (format - 0xC4u), value) && block(value, item);
+        case 0xCAu:
+        case 0xCBu:
+            item.kind = Item::Kind::Float;
+            if (!bigEndian((format == 0xCAu) ? 4u : 8u, value))
+            {
+                return false;
+            }
+            item.number = (format == 0xCAu) ? float32(value) : float64(value);
+            return true;
+        case 0xCCu: // uint 8, 16, 32, 64
+        case 0xCDu:
+        case 0xCEu:
+        case 0xCFu:
+            item.kind = Item::Kind::Unsigned;
+            return bigEndian(1u << (format - 0xCCu), item.uinteger);
+        case 0xD0u: // int 8, 16, 32, 64
+        case 0xD1u:
+        case 0xD2u:
+        case 0xD3u:
+        {
+            const unsigned bytes = 1u << (format - 0xD0u);
+            if (!bigEndian(bytes, value))
+            {
+                return false;
+            }
+            const unsigned shift = 64u - 8u * bytes;
+            setInteger(static_cast<int64_t>(value << shift) >> shift, item);
+            return true;
+        }
+        case 0xD9u: // str 8, 16, 32
+        case 0xDAu:
+        case 0xDBu:
+            item.kind = Item::Kind::Text;
+            return bigEndian(1u << (format - 0xD9u), value) && block(value, item);
+        case 0xDCu: // array 16, 32
+        case 0xDDu:
+            item.kind = Item::Kind::Array;
+            return bigEndian(2u << (format - 0xDCu), item.uinteger);
+        case 0xDEu: // map 16, 32
+        case 0xDFu:
+            item.kind = Item::Kind::Map;
+            return bigEndian(2u << (format - 0xDEu), item.uinteger);
+        default:
+            return false;
+        }
+    }
+};
+
+/** \brief Same conditions as the extractors of IoddService. */
+bool writable(const PlanElement &element)
+{
+    switch (element.type)
+    {
+    case IolType::BooleanT:
+        return element.bitLength != 0u;
+    case IolType::UIntegerT:
+    case IolType::IntegerT:
+        return (element.bitLength >= 2u) && (element.bitLength <= 64u);
+    case IolType::Float32T:
+        return element.bitLength == 32u;
+    case IolType::TimeT:
+    case IolType::TimeSpanT:
+        return element.bitLength == 64u;
+    case IolType::StringT:
+    case IolType::OctetStringT:
+        return (element.bitLength != 0u) && !(element.bitOffset & 7u) && !(element.bitLength & 7u);
+    default:
+        return false;
+    }
+}
+
+/**
+ * \brief Raw value of a UIntegerT, IntegerT or Float32T. Scaled values are
+ * converted back and rounded, the range of the element is checked.
+ */
+const char *toNumber(const PlanElement &element, const Item &item, IolValue &value)
+{
+    const unsigned bits = element.bitLength;
+    const bool integer = (item.kind == Item::Kind::Unsigned) || (item.kind == Item::Kind::Negative);
+    if (integer && !element.scaled && (element.type == IolType::UIntegerT))
+    {
+        if ((item.kind == Item::Kind::Negative) || ((bits < 64u) && (item.uinteger >> bits)))
+        {
+            return "out of range";
+        }
+        value.uinteger = item.uinteger;
+        return nullptr;
+    }
+    if (integer && !element.scaled && (element.type == IolType::IntegerT))
+    {
+        const int64_t maximum = static_cast<int64_t>((uint64_t(1) << (bits - 1u)) - 1u);
+        if ((item.kind == Item::Kind::Unsigned) ? (item.uinteger > static_cast<uint64_t>(maximum)) : (item.integer < -maximum - 1))
+        {
+            return "out of range";
+        }
+        value.integer = (item.kind == Item::Kind::Unsigned) ? static_cast<int64_t>(item.uinteger) : item.integer;
+        return nullptr;
+    }
+
+    double number;
+    switch (item.kind)
+    {
+    case Item::Kind::Unsigned:
+        number = static_cast<double>(item.uinteger);
+        break;
+    case Item::Kind::Negative:
+        number = static_cast<double>(item.integer);
+        break;
+    case Item::Kind::Float:
+        number = item.number;
+        break;
+    default:
+        return "expected a number";
+    }
+    if (element.scaled)
+    {
+        number = (number - element.offset) / element.gradient;
+    }
+    if (element.type == IolType::Float32T)
+    {
+        value.float32 = static_cast<float>(number);
+        return nullptr;
+    }
+    number = std::round(number);
+    if (element.type == IolType::UIntegerT)
+    {
+        if (!(number >= 0.0) || !(number < std::ldexp(1.0, static_cast<int>(bits))))
+        {
+            return "out of range";
+        }
+        value.uinteger = static_cast<uint64_t>(number);
+        return nullptr;
+    }
+    const double limit = std::ldexp(1.0, static_cast<int>(bits) - 1);
+    if (!(number >= -limit) || !(number < limit))
+    {
+        return "out of range";
+    }
+    value.integer = static_cast<int64_t>(number);
+    return nullptr;
+}
+
+/**
+ * \brief Raw value of an element.
+ *
+ * \return nullptr if converted, the problem otherwise. A null item leaves
+ * the value Invalid.
+ */
+const char *toValue(const PlanElement &element, const Item &item, IolValue &value)
+{
+    value = IolValue();
+    if (item.kind == Item::Kind::Null)
+    {
+        return nullptr;
+    }
+    if (!writable(element))
+    {
+        return "can't be written";
+    }
+    const char *problem = nullptr;
+    switch (element.type)
+    {
+    case IolType::BooleanT:
+        if ((item.kind == Item::Kind::Boolean) || ((item.kind == Item::Kind::Unsigned) && (item.uinteger <= 1u)))
+        {
+            value.boolean = (item.kind == Item::Kind::Boolean) ? item.boolean : (item.uinteger != 0u);
+        }
+        else
+        {
+            problem = "expected a boolean";
+        }
+        break;
+    case IolType::UIntegerT:
+    case IolType::IntegerT:
+    case IolType::Float32T:
+        problem = toNumber(element, item, value);
+        break;
+    case IolType::StringT:
+    case IolType::OctetStringT:
+        if (item.kind != ((element.type == IolType::StringT) ? Item::Kind::Text : Item::Kind::Bytes))
+        {
+            problem = (element.type == IolType::StringT) ? "expected a string" : "expected bytes";
+        }
+        else if (item.length > element.bitLength / 8u)
+        {
+            problem = "too long";
+        }
+        else
+        {
+            value.bytes.data = item.data;
+            value.bytes.length = static_cast<uint16_t>(item.length);
+        }
+        break;
+    case IolType::TimeT:
+    case IolType::TimeSpanT:
+        if ((item.kind == Item::Kind::Negative) || ((item.kind == Item::Kind::Unsigned) && (item.uinteger <= static_cast<uint64_t>(INT64_MAX))))
+        {
+            value.integer = (item.kind == Item::Kind::Negative) ? item.integer : static_cast<int64_t>(item.uinteger);
+        }
+        else
+        {
+            problem = "expected an integer (ns)";
+        }
+        break;
+    default:
+        problem = "can't be written";
+        break;
+    }
+    if (problem == nullptr)
+    {
+        value.type = element.type;
+    }
+    return problem;
+}
+
+bool fail(std::string &error, const std::string &message)
+{
+    error = message;
+    return false;
+}
+
+bool setField(const DecodePlan &plan, std::size_t index, const Item &item, IolValue *values, std::string &error)
+{
+    const PlanElement &element = plan.elements[index];
+    const char *problem = toValue(element, item, values[index]);
+    if (problem != nullptr)
+    {
+        return fail(error, "field " + plan.keys[element.keyIndex] + ": " + problem);
+    }
+    return true;
+}
+
+template <class Reader>
+bool readBinary(Reader &reader, const DecodePlan &plan, IolValue *values, std::string &error)
+{
+    Item item;
+    if (!reader.next(item))
+    {
+        return fail(error, "truncated");
+    }
+    if (item.kind == Item::Kind::Array)
+    {
+        Item planId;
+        Item timestamp;
+        if ((item.uinteger != 3u) || !reader.next(planId) || (planId.kind != Item::Kind::Unsigned) ||
+            !reader.next(timestamp) || (timestamp.kind != Item::Kind::Unsigned) || !reader.next(item))
+        {
+            return fail(error, "expected [planId, timestamp, values]");
+        }
+        if ((planId.uinteger != 0u) && (planId.uinteger != plan.id))
+        {
+            return fail(error, "written for plan " + std::to_string(planId.uinteger) + ", the device has plan " + std::to_string(plan.id));
+        }
+    }
+    if (item.kind != Item::Kind::Map)
+    {
+        return fail(error, "expected a map of the values");
+    }
+    for (uint64_t remaining = item.uinteger; remaining > 0u; remaining--)
+    {
+        Item key;
+        Item value;
+        if (!reader.next(key) || !reader.next(value))
+        {
+            return fail(error, "truncated");
+        }
+        if ((value.kind == Item::Kind::Array) || (value.kind == Item::Kind::Map))
+        {
+            return fail(error, "values have to be scalars");
+        }
+        if (key.kind == Item::Kind::Unsigned)
+        {
+            if (key.uinteger >= plan.elements.size())
+            {
+                return fail(error, "unknown field id " + std::to_string(key.uinteger));
+            }
+            if (!setField(plan, static_cast<std::size_t>(key.uinteger), value, values, error))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (key.kind != Item::Kind::Text)
+        {
+            return fail(error, "keys have to be field ids or names");
+        }
+        const std::string_view name(reinterpret_cast<const char *>(key.data), key.length);
+        bool found = false;
+        for (std::size_t i = 0; i < plan.elements.size(); i++)
+        {
+            if ((plan.keys[plan.elements[i].keyIndex] == name) && !setField(plan, i, value, values, error))
+            {
+                return false;
+            }
+            found = found || (plan.keys[plan.elements[i].keyIndex] == name);
+        }
+        if (!found)
+        {
+            return fail(error, "unknown field " + std::string(name));
+        }
+    }
+    if (!reader.atEnd())
+    {
+        return fail(error, "data after the values");
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * \brief Reads the values out of a JSON object.
+ *
+ * \param plan PD out plan of the device
+ * \param object keys and values, has to outlive the values
+ * \param error problem, if false is returned
+ * \return false if a key is unknown or a value can't be written
+ */
+bool PDOutValues::fromJson(const DecodePlan &plan, const nlohmann::json &object, std::string &error)
+{
+    if (!reset(plan, error))
+    {
+        return false;
+    }
+    if (!object.is_object())
+    {
+        return fail(error, "expected an object of keys and values");
+    }
+    for (auto member = object.begin(); member != object.end(); ++member)
+    {
+        const nlohmann::json &value = member.value();
+        Item item;
+        switch (value.type())
+        {
+        case nlohmann::json::value_t::boolean:
+            item.kind = Item::Kind::Boolean;
+            item.boolean = value.get<bool>();
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            item.kind = Item::Kind::Unsigned;
+            item.uinteger = value.get<uint64_t>();
+            break;
+        case nlohmann::json::value_t::number_integer:
+            item.kind = (value.get<int64_t>() < 0) ? Item::Kind::Negative : Item::Kind::Unsigned;
+            item.integer = value.get<int64_t>();
+            item.uinteger = static_cast<uint64_t>(item.integer);
+            break;
+        case nlohmann::json::value_t::number_float:
+            item.kind = Item::Kind::Float;
+            item.number = value.get<double>();
+            break;
+        case nlohmann::json::value_t::string:
+        {
+            const std::string &text = value.get_ref<const std::string &>();
+            item.kind = Item::Kind::Text;
+            item.data = reinterpret_cast<const uint8_t *>(text.data());
+            item.length = text.size();
+            break;
+        }
+        case nlohmann::json::value_t::array:
+            // OctetStringT, the bytes are kept in octets_
+            item.kind = Item::Kind::Bytes;
+            item.data = octets_ + octetsUsed_;
+            for (const nlohmann::json &octet : value)
+            {
+                if (!octet.is_number_unsigned() || (octet.get<uint64_t>() > 0xFFu) || (octetsUsed_ == sizeof(octets_)))
+                {
+                    return fail(error, "field " + member.key() + ": expected up to " + std::to_string(sizeof(octets_)) + " bytes");
+                }
+                octets_[octetsUsed_++] = static_cast<uint8_t>(octet.get<uint64_t>());
+            }
+            item.length = value.size();
+            break;
+        case nlohmann::json::value_t::null:
+            break;
+        default:
+            return fail(error, "field " + member.key() + ": values have to be scalars or arrays of bytes");
+        }
+
+        bool found = false;
+        for (std::size_t i = 0; i < plan.elements.size(); i++)
+        {
+            if (plan.keys[plan.elements[i].keyIndex] != member.key())
+            {
+                continue;
+            }
+            found = true;
+            if (!setField(plan, i, item, values_, error))
+            {
+                return false;
+            }
+        }
+        if (!found)
+        {
+            return fail(error, "unknown field " + member.key());
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Reads the values out of a CBOR or MessagePack message.
+ *
+ * \param encoding Cbor or MsgPack
+ * \param plan PD out plan of the device
+ * \param data message, has to outlive the values
+ * \param length size of the message in bytes
+ * \param error problem, if false is returned
+ * \return false if the message is malformed, a field is unknown or a value
+ * can't be written
+ */
+bool PDOutValues::fromBinary(PayloadEncoding encoding, const DecodePlan &plan, const uint8_t *data, std::size_t length, std::string &error)
+{
+    if (!reset(plan, error))
+    {
+        return false;
+    }
+    if (encoding == PayloadEncoding::MsgPack)
+    {
+        MsgPackReader reader(data, length);
+        return readBinary(reader, plan, values_, error);
+    }
+    if (encoding == PayloadEncoding::Cbor)
+    {
+        CborReader reader(data, length);
+        return readBinary(reader, plan, values_, error);
+    }
+    return fail(error, "expected CBOR or MessagePack");
+}
+
+bool PDOutValues::reset(const DecodePlan &plan, std::string &error)
+{
+    if (plan.elements.size() > MAX_ELEMENTS)
+    {
+        return fail(error, "the plan has more than " + std::to_string(MAX_ELEMENTS) + " elements");
+    }
+    for (std::size_t i = 0; i < plan.elements.size(); i++)
+    {
+        values_[i] = IolValue();
+    }
+    octetsUsed_ = 0;
+    return true;
+}
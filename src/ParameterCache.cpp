@@ -0,0 +1,378 @@
+/*!
+ * @file ParameterCache.cpp
+ * @brief Per-port cache for static ISDU parameters (identification data and
+ *        other read-only indices), bound to the identity of the connected device.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "ParameterCache.h"
+#include "IOLink.h"
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    ParameterCache
+//!*******************************************************************************
+//!  \brief        Constructor for ParameterCache. The read-only identification
+//!                parameters (index 0x10 - 0x17) are registered as cacheable by
+//!                default, the application specific tag 0x18 is writable.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+ParameterCache::ParameterCache()
+    : VendorID_(0),
+      DeviceID_(0),
+      serialVerified_(false)
+{
+    seedReadOnly();
+}
+
+//!*******************************************************************************
+//!  function :    ParameterCache
+//!*******************************************************************************
+//!  \brief        Copy constructor, the mutex itself is not copied
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                cache to copy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+ParameterCache::ParameterCache(const ParameterCache &other)
+{
+    lock_guard<mutex> lock(other.cacheMutex_);
+    entries_ = other.entries_;
+    readOnly_ = other.readOnly_;
+    VendorID_ = other.VendorID_;
+    DeviceID_ = other.DeviceID_;
+    serialNumber_ = other.serialNumber_;
+    serialVerified_ = other.serialVerified_;
+}
+
+//!*******************************************************************************
+//!  function :    operator=
+//!*******************************************************************************
+//!  \brief        Copy assignment, the mutex itself is not copied
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                cache to copy
+//!
+//!  \return       reference to this cache
+//!
+//!*******************************************************************************
+ParameterCache &ParameterCache::operator=(const ParameterCache &other)
+{
+    if (this != &other)
+    {
+        lock(cacheMutex_, other.cacheMutex_);
+        lock_guard<mutex> lockThis(cacheMutex_, adopt_lock);
+        lock_guard<mutex> lockOther(other.cacheMutex_, adopt_lock);
+        entries_ = other.entries_;
+        readOnly_ = other.readOnly_;
+        VendorID_ = other.VendorID_;
+        DeviceID_ = other.DeviceID_;
+        serialNumber_ = other.serialNumber_;
+        serialVerified_ = other.serialVerified_;
+    }
+    return *this;
+}
+
+//!*******************************************************************************
+//!  function :    ~ParameterCache
+//!*******************************************************************************
+//!  \brief        Destructor for ParameterCache
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+ParameterCache::~ParameterCache()
+{
+}
+
+//!*******************************************************************************
+//!  function :    key
+//!*******************************************************************************
+//!  \brief        Builds the map key out of index and subindex
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                ISDU index
+//!  \param[in]    subIndex             ISDU subindex
+//!
+//!  \return       key for entries_ and readOnly_
+//!
+//!*******************************************************************************
+uint32_t ParameterCache::key(uint16_t index, uint8_t subIndex)
+{
+    return (uint32_t(index) << 8) | subIndex;
+}
+
+//!*******************************************************************************
+//!  function :    seedReadOnly
+//!*******************************************************************************
+//!  \brief        Resets the cacheable indices to the read-only identification
+//!                parameters 0x10 - 0x17, the caller holds cacheMutex_ (or is
+//!                the constructor)
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void ParameterCache::seedReadOnly()
+{
+    readOnly_.clear();
+    for (uint16_t index = IOL::INDEX::VENDOR_NAME; index <= IOL::INDEX::FIRMWARE_REV; index++)
+    {
+        readOnly_.insert(key(index, 0));
+    }
+}
+
+//!*******************************************************************************
+//!  function :    setDevice
+//!*******************************************************************************
+//!  \brief        Has to be called every time a device was detected on the port.
+//!                A different VendorID/DeviceID drops all entries and the
+//!                read-only indices added from its IODD. In any case the
+//!                serial number has to be verified again before the next hit,
+//!                because an identical device type could have been swapped in.
+//!
+//!  \type         local
+//!
+//!  \param[in]    VendorID             VendorID of the detected device
+//!  \param[in]    DeviceID             DeviceID of the detected device
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void ParameterCache::setDevice(uint16_t VendorID, uint32_t DeviceID)
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    if ((VendorID != VendorID_) || (DeviceID != DeviceID_))
+    {
+        entries_.clear();
+        serialNumber_.clear();
+        seedReadOnly(); // the IODD indices of the last device type don't apply
+        VendorID_ = VendorID;
+        DeviceID_ = DeviceID;
+    }
+    serialVerified_ = false;
+}
+
+//!*******************************************************************************
+//!  function :    verifySerialNumber
+//!*******************************************************************************
+//!  \brief        Compares the serial number read from the device with the one
+//!                the cache content belongs to. On a mismatch all entries are
+//!                dropped. Afterwards the cache serves hits again.
+//!
+//!  \type         local
+//!
+//!  \param[in]    serialNumber         serial number read from the device (0x15)
+//!
+//!  \return       true if the cached entries are still valid
+//!
+//!*******************************************************************************
+bool ParameterCache::verifySerialNumber(const vector<uint8_t> &serialNumber)
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    bool valid = (serialNumber == serialNumber_);
+    if (!valid)
+    {
+        entries_.clear();
+        serialNumber_ = serialNumber;
+    }
+    entries_[key(IOL::INDEX::SERIAL_NUMBER, 0)] = serialNumber;
+    serialVerified_ = true;
+    return valid;
+}
+
+//!*******************************************************************************
+//!  function :    isSerialVerified
+//!*******************************************************************************
+//!  \brief        Returns if the serial number has been checked since the last
+//!                device detection
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       true if verified
+//!
+//!*******************************************************************************
+bool ParameterCache::isSerialVerified() const
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    return serialVerified_;
+}
+
+//!*******************************************************************************
+//!  function :    addReadOnly
+//!*******************************************************************************
+//!  \brief        Registers an additional read-only index (e.g. declared as
+//!                such in the IODD) as cacheable
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                ISDU index
+//!  \param[in]    subIndex             ISDU subindex
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void ParameterCache::addReadOnly(uint16_t index, uint8_t subIndex)
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    readOnly_.insert(key(index, subIndex));
+}
+
+//!*******************************************************************************
+//!  function :    isCacheable
+//!*******************************************************************************
+//!  \brief        Returns if the given index/subindex is served by the cache
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                ISDU index
+//!  \param[in]    subIndex             ISDU subindex
+//!
+//!  \return       true if cacheable
+//!
+//!*******************************************************************************
+bool ParameterCache::isCacheable(uint16_t index, uint8_t subIndex) const
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    return readOnly_.count(key(index, subIndex)) != 0;
+}
+
+//!*******************************************************************************
+//!  function :    lookup
+//!*******************************************************************************
+//!  \brief        Looks up a cached parameter. Only returns a hit if the serial
+//!                number of the connected device has been verified.
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                ISDU index
+//!  \param[in]    subIndex             ISDU subindex
+//!  \param[out]   oData                cached parameter data
+//!
+//!  \return       true on a cache hit
+//!
+//!*******************************************************************************
+bool ParameterCache::lookup(uint16_t index, uint8_t subIndex, vector<uint8_t> &oData) const
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    if (!serialVerified_)
+    {
+        return false;
+    }
+    auto it = entries_.find(key(index, subIndex));
+    if (it == entries_.end())
+    {
+        return false;
+    }
+    oData = it->second;
+    return true;
+}
+
+//!*******************************************************************************
+//!  function :    store
+//!*******************************************************************************
+//!  \brief        Stores a parameter read from the device, non cacheable indices
+//!                are ignored
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                ISDU index
+//!  \param[in]    subIndex             ISDU subindex
+//!  \param[in]    oData                parameter data read from the device
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void ParameterCache::store(uint16_t index, uint8_t subIndex, const vector<uint8_t> &oData)
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    if (readOnly_.count(key(index, subIndex)) != 0)
+    {
+        entries_[key(index, subIndex)] = oData;
+    }
+}
+
+//!*******************************************************************************
+//!  function :    invalidate
+//!*******************************************************************************
+//!  \brief        Drops a single entry, used after an ISDU write to the index
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                ISDU index
+//!  \param[in]    subIndex             ISDU subindex
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void ParameterCache::invalidate(uint16_t index, uint8_t subIndex)
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    if (subIndex == 0)
+    {
+        // the entire object was written, drop all of its subindices as well
+        entries_.erase(entries_.lower_bound(key(index, 0)), entries_.upper_bound(key(index, 0xFF)));
+    }
+    else
+    {
+        entries_.erase(key(index, subIndex));
+        entries_.erase(key(index, 0)); // the entire object contains the written subindex
+    }
+}
+
+//!*******************************************************************************
+//!  function :    clear
+//!*******************************************************************************
+//!  \brief        Drops all entries and the device identity
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void ParameterCache::clear()
+{
+    lock_guard<mutex> lock(cacheMutex_);
+    entries_.clear();
+    serialNumber_.clear();
+    VendorID_ = 0;
+    DeviceID_ = 0;
+    serialVerified_ = false;
+}
@@ -0,0 +1,465 @@
+#include "PayloadEncoder.h"
+#include <cstring>
+#include <string_view>
+/*!
+ * @file PayloadEncoder.cpp
+ * @brief Compact binary process data payloads (CBOR, MessagePack) with
+ *        integer field ids and the schema describing them
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+namespace
+{
+
+void appendBigEndian(std::string &out, uint64_t value, unsigned bytes)
+{
+    while (bytes-- > 0u)
+    {
+        out += static_cast<char>(value >> (8u * bytes));
+    }
+}
+
+uint32_t bitsOf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint64_t bitsOf(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/** \brief RFC 8949, definite lengths and the shortest argument encoding. */
+class CborWriter
+{
+public:
+    explicit CborWriter(std::string &out) : out_(out) {}
+
+    void array(std::size_t size) { head(4u, size); }
+    void map(std::size_t size) { head(5u, size); }
+    void uinteger(uint64_t value) { head(0u, value); }
+    void boolean(bool value) { out_ += static_cast<char>(value ? 0xF5 : 0xF4); }
+    void null() { out_ += static_cast<char>(0xF6); }
+
+    void integer(int64_t value)
+    {
+        if (value < 0)
+        {
+            head(1u, ~static_cast<uint64_t>(value)); // -1 - value
+        }
+        else
+        {
+            head(0u, static_cast<uint64_t>(value));
+        }
+    }
+
+    void text(std::string_view value)
+    {
+        head(3u, value.size());
+        out_.append(value.data(), value.size());
+    }
+
+    void float32(float value)
+    {
+        out_ += static_cast<char>(0xFA);
+        appendBigEndian(out_, bitsOf(value), 4u);
+    }
+
+    void float64(double value)
+    {
+        out_ += static_cast<char>(0xFB);
+        appendBigEndian(out_, bitsOf(value), 8u);
+    }
+
+    void bytes(const uint8_t *data, std::size_t length)
+    {
+        head(2u, length);
+        out_.append(reinterpret_cast<const char *>(data), length);
+    }
+
+private:
+    void head(uint8_t major, uint64_t argument)
+    {
+        const char type = static_cast<char>(major << 5u);
+        if (argument < 24u)
+        {
+            out_ += static_cast<char>(type | static_cast<char>(argument));
+        }
+        else if (argument <= 0xFFu)
+        {
+            out_ += static_cast<char>(type | 24);
+            appendBigEndian(out_, argument, 1u);
+        }
+        else if (argument <= 0xFFFFu)
+        {
+            out_ += static_cast<char>(type | 25);
+            appendBigEndian(out_, argument, 2u);
+        }
+        else if (argument <= 0xFFFFFFFFu)
+        {
+            out_ += static_cast<char>(type | 26);
+            appendBigEndian(out_, argument, 4u);
+        }
+        else
+        {
+            out_ += static_cast<char>(type | 27);
+            appendBigEndian(out_, argument, 8u);
+        }
+    }
+
+    std::string &out_;
+};
+
+/** \brief MessagePack with the smallest format of every value. */
+class MsgPackWriter
+{
+public:
+    explicit MsgPackWriter(std::string &out) : out_(out) {}
+
+    void array(std::size_t size) { container(0x90u, 0xDCu, size); }
+    void map(std::size_t size) { container(0x80u, 0xDEu, size); }
+    void boolean(bool value) { out_ += static_cast<char>(value ? 0xC3 : 0xC2); }
+    void null() { out_ += static_cast<char>(0xC0); }
+
+    void integer(int64_t value)
+    {
+        if (value >= 0)
+        {
+            uinteger(static_cast<uint64_t>(value));
+        }
+        else if (value >= -32)
+        {
+            out_ += static_cast<char>(value); // negative fixint
+        }
+        else if (value >= INT8_MIN)
+        {
+            out_ += static_cast<char>(0xD0);
+            appendBigEndian(out_, static_cast<uint64_t>(value), 1u);
+        }
+        else if (value >= INT16_MIN)
+        {
+            out_ += static_cast<char>(0xD1);
+            appendBigEndian(out_, static_cast<uint64_t>(value), 2u);
+        }
+        else if (value >= INT32_MIN)
+        {
+            out_ += static_cast<char>(0xD2);
+            appendBigEndian(out_, static_cast<uint64_t>(value), 4u);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xD3);
+            appendBigEndian(out_, static_cast<uint64_t>(value), 8u);
+        }
+    }
+
+    void text(std::string_view value)
+    {
+        if (value.size() < 32u)
+        {
+            out_ += static_cast<char>(0xA0u | value.size());
+        }
+        else if (value.size() <= 0xFFu)
+        {
+            out_ += static_cast<char>(0xD9);
+            appendBigEndian(out_, value.size(), 1u);
+        }
+        else if (value.size() <= 0xFFFFu)
+        {
+            out_ += static_cast<char>(0xDA);
+            appendBigEndian(out_, value.size(), 2u);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xDB);
+            appendBigEndian(out_, value.size(), 4u);
+        }
+        out_.append(value.data(), value.size());
+    }
+
+    void uinteger(uint64_t value)
+    {
+        if (value < 0x80u)
+        {
+            out_ += static_cast<char>(value);
+        }
+        else if (value <= 0xFFu)
+        {
+            out_ += static_cast<char>(0xCC);
+            appendBigEndian(out_, value, 1u);
+        }
+        else if (value <= 0xFFFFu)
+        {
+            out_ += static_cast<char>(0xCD);
+            appendBigEndian(out_, value, 2u);
+        }
+        else if (value <= 0xFFFFFFFFu)
+        {
+            out_ += static_cast<char>(0xCE);
+            appendBigEndian(out_, value, 4u);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xCF);
+            appendBigEndian(out_, value, 8u);
+        }
+    }
+
+    void float32(float value)
+    {
+        out_ += static_cast<char>(0xCA);
+        appendBigEndian(out_, bitsOf(value), 4u);
+    }
+
+    void float64(double value)
+    {
+        out_ += static_cast<char>(0xCB);
+        appendBigEndian(out_, bitsOf(value), 8u);
+    }
+
+    void bytes(const uint8_t *data, std::size_t length)
+    {
+        if (length <= 0xFFu)
+        {
+            out_ += static_cast<char>(0xC4);
+            appendBigEndian(out_, length, 1u);
+        }
+        else if (length <= 0xFFFFu)
+        {
+            out_ += static_cast<char>(0xC5);
+            appendBigEndian(out_, length, 2u);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xC6);
+            appendBigEndian(out_, length, 4u);
+        }
+        out_.append(reinterpret_cast<const char *>(data), length);
+    }
+
+private:
+    // fix formats hold up to 15 items, then 16 and 32 bit sizes
+    void container(uint8_t fix, uint8_t size16, std::size_t size)
+    {
+        if (size < 16u)
+        {
+            out_ += static_cast<char>(fix | size);
+        }
+        else if (size <= 0xFFFFu)
+        {
+            out_ += static_cast<char>(size16);
+            appendBigEndian(out_, size, 2u);
+        }
+        else
+        {
+            out_ += static_cast<char>(size16 + 1u);
+            appendBigEndian(out_, size, 4u);
+        }
+    }
+
+    std::string &out_;
+};
+
+template <class Writer>
+void writeValues(Writer &writer, const DecodePlan &plan, const IolValue *values, uint64_t timestamp)
+{
+    const std::size_t count = plan.elements.size();
+    writer.array(3u);
+    writer.uinteger(plan.id);
+    writer.uinteger(timestamp);
+    writer.map(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const PlanElement &element = plan.elements[i];
+        const IolValue &value = values[i];
+        writer.uinteger(i);
+        switch (value.type)
+        {
+        case IolType::BooleanT:
+            writer.boolean(value.boolean);
+            break;
+        case IolType::UIntegerT:
+            if (element.scaled)
+            {
+                writer.float64(element.gradient * value.uinteger + element.offset);
+            }
+            else
+            {
+                writer.uinteger(value.uinteger);
+            }
+            break;
+        case IolType::IntegerT:
+            if (element.scaled)
+            {
+                writer.float64(element.gradient * value.integer + element.offset);
+            }
+            else
+            {
+                writer.integer(value.integer);
+            }
+            break;
+        case IolType::Float32T:
+            if (element.scaled)
+            {
+                writer.float64(element.gradient * value.float32 + element.offset);
+            }
+            else
+            {
+                writer.float32(value.float32);
+            }
+            break;
+        case IolType::StringT:
+            writer.text(value.string());
+            break;
+        case IolType::OctetStringT:
+            writer.bytes(value.bytes.data, value.bytes.length);
+            break;
+        case IolType::TimeT:
+        case IolType::TimeSpanT:
+            writer.integer(value.integer);
+            break;
+        default:
+            writer.null();
+            break;
+        }
+    }
+}
+
+template <class Writer>
+void writeRaw(Writer &writer, uint32_t planId, const uint8_t *data, std::size_t length, uint64_t timestamp)
+{
+    writer.array(3u);
+    writer.uinteger(planId);
+    writer.uinteger(timestamp);
+    writer.bytes(data, length);
+}
+
+} // namespace
+
+/**
+ * \brief Parses the encoding name used by the REST API.
+ *
+ * \param name "json", "cbor" or "msgpack"
+ * \return false if the name is unknown, encoding is left unchanged then
+ */
+bool payloadEncodingFromString(const std::string &name, PayloadEncoding &encoding)
+{
+    for (PayloadEncoding candidate : {PayloadEncoding::Json, PayloadEncoding::Cbor, PayloadEncoding::MsgPack})
+    {
+        if (name == payloadEncodingName(candidate))
+        {
+            encoding = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *payloadEncodingName(PayloadEncoding encoding)
+{
+    switch (encoding)
+    {
+    case PayloadEncoding::Cbor:
+        return "cbor";
+    case PayloadEncoding::MsgPack:
+        return "msgpack";
+    default:
+        return "json";
+    }
+}
+
+namespace payload
+{
+
+/**
+ * \brief Writes the decoded values of a sample.
+ *
+ * \param encoding Cbor or MsgPack
+ * \param plan decode plan the values were decoded with
+ * \param values plan.elements.size() values
+ * \param timestamp acquisition time in ns since epoch
+ * \param out cleared and filled with the payload
+ */
+void encodeValues(PayloadEncoding encoding, const DecodePlan &plan, const IolValue *values, uint64_t timestamp, std::string &out)
+{
+    out.clear();
+    if (encoding == PayloadEncoding::MsgPack)
+    {
+        MsgPackWriter writer(out);
+        writeValues(writer, plan, values, timestamp);
+    }
+    else
+    {
+        CborWriter writer(out);
+        writeValues(writer, plan, values, timestamp);
+    }
+}
+
+/**
+ * \brief Writes the raw PD of a sample, decoding is left to the subscriber.
+ *
+ * \param encoding Cbor or MsgPack
+ * \param planId DecodePlan::id of the device, 0 if unknown
+ * \param timestamp acquisition time in ns since epoch
+ * \param out cleared and filled with the payload
+ */
+void encodeRaw(PayloadEncoding encoding, uint32_t planId, const uint8_t *data, std::size_t length, uint64_t timestamp, std::string &out)
+{
+    out.clear();
+    if (encoding == PayloadEncoding::MsgPack)
+    {
+        MsgPackWriter writer(out);
+        writeRaw(writer, planId, data, length, timestamp);
+    }
+    else
+    {
+        CborWriter writer(out);
+        writeRaw(writer, planId, data, length, timestamp);
+    }
+}
+
+/**
+ * \brief Describes the payloads of a port, published retained next to them.
+ *
+ * \param format payload settings of the port
+ * \param plan decode plan of the device, nullptr if unknown
+ */
+nlohmann::json schema(const PayloadFormat &format, const DecodePlan *plan)
+{
+    nlohmann::json result;
+    result["Encoding"] = payloadEncodingName(format.encoding);
+    if (format.encoding != PayloadEncoding::Json)
+    {
+        result["Raw"] = format.raw || (plan == nullptr);
+        result["Message"] = {"PlanId", "Timestamp", result["Raw"].get<bool>() ? "Data" : "Values"};
+        result["Timestamp"] = "ns since epoch";
+    }
+    result["PlanId"] = (plan != nullptr) ? plan->id : 0u;
+    result["Fields"] = nlohmann::json::array();
+    if (plan != nullptr)
+    {
+        for (std::size_t i = 0; i < plan->elements.size(); i++)
+        {
+            const PlanElement &element = plan->elements[i];
+            nlohmann::json field;
+            field["Id"] = i;
+            field["Key"] = plan->keys[element.keyIndex];
+            field["Type"] = iolTypeName(element.type);
+            field["BitOffset"] = element.bitOffset;
+            field["BitLength"] = element.bitLength;
+            field["Gradient"] = element.gradient;
+            field["Offset"] = element.offset;
+            result["Fields"].push_back(field);
+        }
+    }
+    return result;
+}
+
+} // namespace payload
@@ -0,0 +1,556 @@
+/*!
+ * @file PublishFilter.cpp
+ * @brief Decides per port whether the process data of a cycle has to be
+ *        published: raw byte compare first, deadbands on the decoded values
+ *        second and a heartbeat as upper limit for the silence.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "PublishFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    PublishFilter
+//!*******************************************************************************
+//!  \brief        Constructor for PublishFilter. Change driven with the default
+//!                heartbeat, no deadbands (every change is published).
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+PublishFilter::PublishFilter()
+    : changeDriven_(true),
+      heartbeat_(PUBLISH_HEARTBEAT_MS),
+      published_(false),
+      lastLength_(0),
+      lastValid_(0),
+      lastRaw_{0},
+      publishedRaw_{0},
+      deadbandPlan_(nullptr),
+      suppressed_(0)
+{
+}
+
+//!*******************************************************************************
+//!  function :    PublishFilter
+//!*******************************************************************************
+//!  \brief        Copy constructor, the mutex itself is not copied
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                filter to copy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+PublishFilter::PublishFilter(const PublishFilter &other)
+{
+    lock_guard<mutex> lock(other.filterMutex_);
+    changeDriven_ = other.changeDriven_;
+    heartbeat_ = other.heartbeat_;
+    deadbands_ = other.deadbands_;
+    published_ = other.published_;
+    lastLength_ = other.lastLength_;
+    lastValid_ = other.lastValid_;
+    memcpy(lastRaw_, other.lastRaw_, sizeof(lastRaw_));
+    lastValues_ = other.lastValues_;
+    lastPlan_.reset();       // lastDecoded_ would point into other, publish the next values
+    deadbandPlan_ = nullptr; // planDeadbands_ would point into the deadbands of other
+    lastPublish_ = other.lastPublish_;
+    suppressed_ = other.suppressed_;
+}
+
+//!*******************************************************************************
+//!  function :    operator=
+//!*******************************************************************************
+//!  \brief        Copy assignment, the mutex itself is not copied
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                filter to copy
+//!
+//!  \return       reference to this filter
+//!
+//!*******************************************************************************
+PublishFilter &PublishFilter::operator=(const PublishFilter &other)
+{
+    if (this != &other)
+    {
+        lock(filterMutex_, other.filterMutex_);
+        lock_guard<mutex> lockThis(filterMutex_, adopt_lock);
+        lock_guard<mutex> lockOther(other.filterMutex_, adopt_lock);
+        changeDriven_ = other.changeDriven_;
+        heartbeat_ = other.heartbeat_;
+        deadbands_ = other.deadbands_;
+        published_ = other.published_;
+        lastLength_ = other.lastLength_;
+        lastValid_ = other.lastValid_;
+        memcpy(lastRaw_, other.lastRaw_, sizeof(lastRaw_));
+        lastValues_ = other.lastValues_;
+        lastPlan_.reset();
+        deadbandPlan_ = nullptr;
+        lastPublish_ = other.lastPublish_;
+        suppressed_ = other.suppressed_;
+    }
+    return *this;
+}
+
+//!*******************************************************************************
+//!  function :    ~PublishFilter
+//!*******************************************************************************
+//!  \brief        Destructor for PublishFilter
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+PublishFilter::~PublishFilter()
+{
+}
+
+//!*******************************************************************************
+//!  function :    setChangeDriven
+//!*******************************************************************************
+//!  \brief        Switches between change driven and cyclic publishing
+//!
+//!  \type         local
+//!
+//!  \param[in]    changeDriven         false: publish every cycle
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PublishFilter::setChangeDriven(bool changeDriven)
+{
+    lock_guard<mutex> lock(filterMutex_);
+    changeDriven_ = changeDriven;
+}
+
+//!*******************************************************************************
+//!  function :    setHeartbeat
+//!*******************************************************************************
+//!  \brief        Sets the maximum time without a publication
+//!
+//!  \type         local
+//!
+//!  \param[in]    heartbeat_ms         heartbeat in ms, 0 disables it
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PublishFilter::setHeartbeat(uint32_t heartbeat_ms)
+{
+    lock_guard<mutex> lock(filterMutex_);
+    heartbeat_ = chrono::milliseconds(heartbeat_ms);
+}
+
+//!*******************************************************************************
+//!  function :    setDeadband
+//!*******************************************************************************
+//!  \brief        Sets the deadband of a decoded element. A change is published
+//!                if it exceeds the absolute value and the percentage of the
+//!                last published value, whichever is larger.
+//!
+//!  \type         local
+//!
+//!  \param[in]    key                  element name as in the published JSON
+//!  \param[in]    absolute             absolute deadband
+//!  \param[in]    percent              deadband in percent of the last value
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PublishFilter::setDeadband(const string &key, double absolute, double percent)
+{
+    lock_guard<mutex> lock(filterMutex_);
+    Deadband deadband;
+    deadband.absolute = fabs(absolute);
+    deadband.percent = fabs(percent);
+    deadbands_[key] = deadband;
+    deadbandPlan_ = nullptr;
+}
+
+//!*******************************************************************************
+//!  function :    clearDeadbands
+//!*******************************************************************************
+//!  \brief        Removes all deadbands, every change is published again
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PublishFilter::clearDeadbands()
+{
+    lock_guard<mutex> lock(filterMutex_);
+    deadbands_.clear();
+    deadbandPlan_ = nullptr;
+}
+
+//!*******************************************************************************
+//!  function :    reset
+//!*******************************************************************************
+//!  \brief        Forgets the last publication, the next cycle is published
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PublishFilter::reset()
+{
+    lock_guard<mutex> lock(filterMutex_);
+    published_ = false;
+    lastValues_ = nlohmann::json();
+    lastPlan_.reset();
+}
+
+//!*******************************************************************************
+//!  function :    heartbeatDue
+//!*******************************************************************************
+//!  \brief        Returns if the port has been silent for the heartbeat time
+//!
+//!  \type         local
+//!
+//!  \param[in]    now                  current time
+//!
+//!  \return       true if a publication is due
+//!
+//!*******************************************************************************
+bool PublishFilter::heartbeatDue(chrono::steady_clock::time_point now) const
+{
+    return (heartbeat_.count() > 0) && ((now - lastPublish_) >= heartbeat_);
+}
+
+//!*******************************************************************************
+//!  function :    rawEqual
+//!*******************************************************************************
+//!  \brief        Compares the raw PD with the one of the last check
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               PD sample of this cycle
+//!
+//!  \return       true if length, validity and all bytes are equal
+//!
+//!*******************************************************************************
+bool PublishFilter::rawEqual(const PDSample &sample) const
+{
+    return (sample.length == lastLength_) && (sample.valid == lastValid_) && (memcmp(sample.data, lastRaw_, sample.length) == 0);
+}
+
+//!*******************************************************************************
+//!  function :    valueChanged
+//!*******************************************************************************
+//!  \brief        Compares a decoded element with the last published value.
+//!                Numbers with a deadband are compared against it, everything
+//!                else has to be equal.
+//!
+//!  \type         local
+//!
+//!  \param[in]    key                  element name
+//!  \param[in]    value                decoded value of this cycle
+//!  \param[in]    last                 last published value
+//!
+//!  \return       true if the change has to be published
+//!
+//!*******************************************************************************
+bool PublishFilter::valueChanged(const string &key, const nlohmann::json &value, const nlohmann::json &last) const
+{
+    auto deadband = deadbands_.find(key);
+    if ((deadband == deadbands_.end()) || !value.is_number() || !last.is_number())
+    {
+        return value != last;
+    }
+    double current = value.get<double>();
+    double previous = last.get<double>();
+    double limit = max(deadband->second.absolute, fabs(previous) * deadband->second.percent / 100.0);
+    return fabs(current - previous) > limit;
+}
+
+//!*******************************************************************************
+//!  function :    valueChanged
+//!*******************************************************************************
+//!  \brief        Same as above for a value decoded without JSON, the values are
+//!                scaled as in the published payload before they are compared
+//!
+//!  \type         local
+//!
+//!  \param[in]    element              plan element of the value
+//!  \param[in]    deadband             deadband of the element, nullptr if none
+//!  \param[in]    value                decoded value of this cycle
+//!  \param[in]    last                 last published value
+//!
+//!  \return       true if the change has to be published
+//!
+//!*******************************************************************************
+bool PublishFilter::valueChanged(const PlanElement &element, const Deadband *deadband, const IolValue &value, const IolValue &last) const
+{
+    if (value.type != last.type)
+    {
+        return true;
+    }
+    double current = 0;
+    double previous = 0;
+    switch (value.type)
+    {
+    case IolType::BooleanT:
+        return value.boolean != last.boolean;
+    case IolType::UIntegerT:
+        current = element.gradient * value.uinteger + element.offset;
+        previous = element.gradient * last.uinteger + element.offset;
+        break;
+    case IolType::IntegerT:
+        current = element.gradient * value.integer + element.offset;
+        previous = element.gradient * last.integer + element.offset;
+        break;
+    case IolType::Float32T:
+        current = element.gradient * value.float32 + element.offset;
+        previous = element.gradient * last.float32 + element.offset;
+        break;
+    case IolType::TimeT:
+    case IolType::TimeSpanT:
+        if (deadband == nullptr)
+        {
+            return value.integer != last.integer; // ns don't fit into a double
+        }
+        current = double(value.integer);
+        previous = double(last.integer);
+        break;
+    case IolType::StringT:
+    case IolType::OctetStringT:
+        return (value.bytes.length != last.bytes.length) || (memcmp(value.bytes.data, last.bytes.data, value.bytes.length) != 0);
+    default:
+        return false; // both "Invalid"
+    }
+    if (deadband == nullptr)
+    {
+        return current != previous;
+    }
+    double limit = max(deadband->absolute, fabs(previous) * deadband->percent / 100.0);
+    return fabs(current - previous) > limit;
+}
+
+//!*******************************************************************************
+//!  function :    rememberRaw
+//!*******************************************************************************
+//!  \brief        Keeps the raw PD as reference for the next needsDecode
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               PD sample of this cycle
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void PublishFilter::rememberRaw(const PDSample &sample)
+{
+    lastLength_ = sample.length;
+    lastValid_ = sample.valid;
+    memcpy(lastRaw_, sample.data, sample.length);
+}
+
+//!*******************************************************************************
+//!  function :    needsDecode
+//!*******************************************************************************
+//!  \brief        Fast path, called every cycle before anything is decoded. An
+//!                unchanged raw PD is skipped unless the heartbeat is due.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               PD sample of this cycle
+//!  \param[in]    now                  current time
+//!
+//!  \return       true if the PD has to be decoded and passed to needsPublish
+//!
+//!*******************************************************************************
+bool PublishFilter::needsDecode(const PDSample &sample, chrono::steady_clock::time_point now)
+{
+    lock_guard<mutex> lock(filterMutex_);
+    if (!changeDriven_ || !published_ || !rawEqual(sample) || heartbeatDue(now))
+    {
+        return true;
+    }
+    suppressed_++;
+    return false;
+}
+
+//!*******************************************************************************
+//!  function :    needsPublish
+//!*******************************************************************************
+//!  \brief        Compares the decoded values against the deadbands. If the
+//!                cycle is published, its values become the new reference.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               PD sample the values were decoded from
+//!  \param[in]    values               decoded PD (flat JSON object)
+//!  \param[in]    now                  current time
+//!
+//!  \return       true if the values have to be published
+//!
+//!*******************************************************************************
+bool PublishFilter::needsPublish(const PDSample &sample, const nlohmann::json &values, chrono::steady_clock::time_point now)
+{
+    lock_guard<mutex> lock(filterMutex_);
+    bool publish = !changeDriven_ || !published_ || heartbeatDue(now) || (sample.valid != lastValid_) || (values.size() != lastValues_.size());
+    if (!publish && values.is_object())
+    {
+        for (auto it = values.begin(); it != values.end(); ++it)
+        {
+            auto last = lastValues_.find(it.key());
+            if ((last == lastValues_.end()) || valueChanged(it.key(), it.value(), *last))
+            {
+                publish = true;
+                break;
+            }
+        }
+    }
+    else if (!publish)
+    {
+        publish = (values != lastValues_);
+    }
+    // the raw compare always refers to the last decoded PD, the deadbands to
+    // the last published values so slow drifts are still published
+    rememberRaw(sample);
+    if (publish)
+    {
+        published_ = true;
+        lastValues_ = values;
+        lastPlan_.reset();
+        lastPublish_ = now;
+    }
+    else
+    {
+        suppressed_++;
+    }
+    return publish;
+}
+
+//!*******************************************************************************
+//!  function :    needsPublish
+//!*******************************************************************************
+//!  \brief        Same as above for PD decoded with a plan, so the cyclic path
+//!                doesn't have to build a JSON object. The deadbands are
+//!                resolved once per plan instead of once per value.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               PD sample the values were decoded from
+//!  \param[in]    plan                 decode plan of the device
+//!  \param[in]    values               plan->elements.size() values decoded
+//!                                     from sample.data
+//!  \param[in]    now                  current time
+//!
+//!  \return       true if the values have to be published
+//!
+//!*******************************************************************************
+bool PublishFilter::needsPublish(const PDSample &sample, const shared_ptr<const DecodePlan> &plan, const IolValue *values, chrono::steady_clock::time_point now)
+{
+    lock_guard<mutex> lock(filterMutex_);
+    const size_t count = plan->elements.size();
+    if (deadbandPlan_ != plan.get())
+    {
+        planDeadbands_.assign(count, nullptr);
+        for (size_t i = 0; i < count; i++)
+        {
+            auto deadband = deadbands_.find(plan->keys[plan->elements[i].keyIndex]);
+            if (deadband != deadbands_.end())
+            {
+                planDeadbands_[i] = &deadband->second;
+            }
+        }
+        deadbandPlan_ = plan.get();
+    }
+    bool publish = !changeDriven_ || !published_ || heartbeatDue(now) || (sample.valid != lastValid_) || (plan != lastPlan_);
+    for (size_t i = 0; !publish && (i < count); i++)
+    {
+        publish = valueChanged(plan->elements[i], planDeadbands_[i], values[i], lastDecoded_[i]);
+    }
+    rememberRaw(sample);
+    if (publish)
+    {
+        published_ = true;
+        lastPlan_ = plan;
+        lastDecoded_.assign(values, values + count);
+        if (plan->views)
+        {
+            // strings point into the PD of this cycle, keep a copy of it
+            memcpy(publishedRaw_, sample.data, sample.length);
+            for (IolValue &value : lastDecoded_)
+            {
+                if ((value.type == IolType::StringT) || (value.type == IolType::OctetStringT))
+                {
+                    value.bytes.data = publishedRaw_ + (value.bytes.data - sample.data);
+                }
+            }
+        }
+        lastValues_ = nlohmann::json();
+        lastPublish_ = now;
+    }
+    else
+    {
+        suppressed_++;
+    }
+    return publish;
+}
+
+//!*******************************************************************************
+//!  function :    getConfig
+//!*******************************************************************************
+//!  \brief        Configuration and statistics as JSON, used by the REST API
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       nlohmann::json
+//!
+//!*******************************************************************************
+nlohmann::json PublishFilter::getConfig() const
+{
+    lock_guard<mutex> lock(filterMutex_);
+    nlohmann::json config;
+    config["ChangeDriven"] = changeDriven_;
+    config["Heartbeat"] = heartbeat_.count();
+    config["Deadbands"] = nlohmann::json::array();
+    for (const auto &deadband : deadbands_)
+    {
+        nlohmann::json item;
+        item["Key"] = deadband.first;
+        item["Absolute"] = deadband.second.absolute;
+        item["Percent"] = deadband.second.percent;
+        config["Deadbands"].push_back(item);
+    }
+    config["Suppressed"] = suppressed_;
+    return config;
+}
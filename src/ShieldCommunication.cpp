@@ -19,6 +19,8 @@
 
 //!**** Header-Files ***********************************************************
 #include "ShieldCommunication.h"
+#include "JsonTemplate.h"
+#include "PDOutValues.h"
 #include <mosquitto.h>
 #include <stdio.h>
 #include <nlohmann/json.hpp>
@@ -26,6 +28,7 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <charconv>
 #include <spdlog/fmt/fmt.h>
 
 using json = nlohmann::json;
@@ -35,6 +38,19 @@ using json = nlohmann::json;
 
 //!**** Implementation *********************************************************
 
+// IRQ driven edge capture of the DI lines. wiringPi handlers have no parameter,
+// so there is one handler per DI pin (port 3 DI isn't connected to the Pi).
+constexpr uint8_t DI_INTERRUPT_PORTS = 3;
+static const HardwareRaspberry::PinNames diPins[DI_INTERRUPT_PORTS] = {HardwareRaspberry::port0DI, HardwareRaspberry::port1DI, HardwareRaspberry::port2DI};
+static SioChannel *diChannels[DI_INTERRUPT_PORTS] = {nullptr};
+static HardwareRaspberry *diHardware = nullptr;
+
+template <uint8_t N>
+static void diInterrupt()
+{
+    diChannels[N]->sample(diHardware->IO_Read(diPins[N]), SioChannel::now());
+}
+
 //!*******************************************************************************
 //!  function :    ShieldCommunication
 //!*******************************************************************************
@@ -90,13 +106,18 @@ void ShieldCommunication::Communication_startup(bool extended_board)
     hardware = HardwareRaspberry();
     hardware.begin();
 
-    // Create IODD manager
-    // instance = IoddManager();
+    // Create IODD service, installed IODDs extend the builtin device layouts
     service = IoddService();
+    if (service.loadIodds("iodd", "iodd/iodd.cache"))
+    {
+        cout << "IODD: layouts loaded from directory iodd" << endl;
+    }
 
     // Create drivers
     max14819::Max14819 *pDriver01 = new max14819::Max14819(max14819::DRIVER01, &hardware);
     max14819::Max14819 *pDriver23 = new max14819::Max14819(max14819::DRIVER23, &hardware);
+    pDriver01->setBusMutex(&max1Mutex);
+    pDriver23->setBusMutex(&max2Mutex);
     // Create ports
     ports.push_back(IOLMasterPortMax14819(pDriver01, max14819::PORT0PORT));
     ports.push_back(IOLMasterPortMax14819(pDriver01, max14819::PORT1PORT));
@@ -105,11 +126,46 @@ void ShieldCommunication::Communication_startup(bool extended_board)
         ports.push_back(IOLMasterPortMax14819(pDriver23, max14819::PORT2PORT));
         ports.push_back(IOLMasterPortMax14819(pDriver23, max14819::PORT3PORT));
     }
+    publishFilters = vector<PublishFilter>(ports.size());
+    payloadFormats = vector<PayloadFormat>(ports.size());
+    for (size_t chip = 0; chip < PIPELINE_CHIPS; chip++)
+    {
+        size_t firstPort = chip * PORTS_PER_CHIP;
+        chips[chip].firstPort = uint8_t(firstPort);
+        chips[chip].portCount = uint8_t((ports.size() > firstPort) ? min(PORTS_PER_CHIP, ports.size() - firstPort) : 0);
+    }
+    for (auto &pending : dataStoragePending)
+    {
+        pending.store(false, memory_order_relaxed);
+    }
+    for (auto &claimed : portClaimed)
+    {
+        claimed.store(false, memory_order_relaxed);
+    }
+
+    // Register the DI interrupts, the ports don't move in memory any more
+    void (*diHandlers[DI_INTERRUPT_PORTS])(void) = {diInterrupt<0>, diInterrupt<1>, diInterrupt<2>};
+    diHardware = &hardware;
+    for (uint8_t i = 0; (i < DI_INTERRUPT_PORTS) && (i < ports.size()); i++)
+    {
+        diChannels[i] = ports.at(i).get_SioDI();
+        if (hardware.IO_Interrupt(diPins[i], diHandlers[i]) != SUCCESS)
+        {
+            hardware.Serial_Write("Error register DI interrupt");
+        }
+    }
 
     // Start IO-Link communication
+    uint8_t port_nr = 0;
     for (auto &nr : ports)
     {
         nr.begin();
+        if (nr.get_DeviceConnection() == 0)
+        {
+            registerReadOnly(nr);
+            dataStorage.synchronize(nr, port_nr); // upload/download parameters if the checksum differs
+        }
+        port_nr++;
     }
 
     // Start MQTT init
@@ -124,6 +180,13 @@ void ShieldCommunication::Communication_startup(bool extended_board)
         mosquitto_destroy(mosq);
         return;
     }
+    // network loop in its own thread: reads the PUBACKs of QoS 1, sends the
+    // keepalive and reconnects, without it the inflight window fills up
+    rc = mosquitto_loop_start(mosq);
+    if (rc != MOSQ_ERR_SUCCESS)
+    {
+        printf("Error starting the MQTT network loop: %s\n", mosquitto_strerror(rc));
+    }
 }
 
 //!*******************************************************************************
@@ -149,6 +212,7 @@ void ShieldCommunication::Communication_shutdown()
     char buf[] = "Stop IO-Link communication";
     hardware.Serial_Write(buf);
     mosquitto_disconnect(mosq);
+    mosquitto_loop_stop(mosq, false);
     mosquitto_destroy(mosq);
 
     mosquitto_lib_cleanup();
@@ -208,22 +272,14 @@ void ShieldCommunication::ISDU_Write(uint8_t port_nr, uint16_t index, uint8_t su
 
     if (OnRequestData || ProcessDataIn || ProcessDataOut) // if Device Connected -> write Data to device
     {
-        if (port_nr == 0 || 1)
+        lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+        if (portClaimed[port_nr].load(memory_order_acquire))
         {
-            max1Mutex.lock();
+            retVal = ERROR; // Port_startup works on the port
         }
         else
         {
-            max2Mutex.lock();
-        }
-        retVal = ports.at(port_nr).writeISDU(oData.size(), oData, index, subIndex);
-        if (port_nr == 0 || 1)
-        {
-            max1Mutex.unlock();
-        }
-        else
-        {
-            max2Mutex.unlock();
+            retVal = ports.at(port_nr).writeISDU(oData.size(), oData, index, subIndex);
         }
     }
     else
@@ -265,39 +321,97 @@ void ShieldCommunication::ISDU_Read(uint8_t port_nr, uint16_t index, uint8_t sub
     ProcessDataIn = get<1>(ports.at(port_nr).getLengthParameter());
     ProcessDataOut = get<2>(ports.at(port_nr).getLengthParameter());
 
-    if (OnRequestData || ProcessDataIn || ProcessDataOut) // if Device Connected -> write Data to device
+    if (!(OnRequestData || ProcessDataIn || ProcessDataOut)) // no Device connected, the cache may belong to the last one
+    {
+        retVal = ERROR;
+        cout << "ERROR - No Device connected" << endl;
+    }
+    else if (ports.at(port_nr).lookupCachedISDU(oData, index, subIndex))
+    {
+        // static parameter of the verified device already known, no IO-Link communication needed
+    }
+    else // Device Connected -> read Data from device
     {
         // hardware.wait_for(500);
-        if (port_nr == 0 || 1)
+        lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+        if (portClaimed[port_nr].load(memory_order_acquire))
         {
-            max1Mutex.lock();
+            retVal = ERROR; // Port_startup works on the port
         }
         else
         {
-            max2Mutex.lock();
+            // read ISDU (static parameters are stored in the parameter cache)
+            retVal = ports.at(port_nr).readISDUCached(oData, index, subIndex);
+        }
+    }
+    Data = oData;
+    /*for(int i=0;i<Data.size();i++)
+    {
+        cout<<"Wert: "<<int(Data[i])<<endl;
+    }*/
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    ISDU_Batch
+//!*******************************************************************************
+//!  \brief        Function to proof if a device is connected and after that
+//!                executing a list of ISDU read/write requests with one lock
+//!                acquisition
+//!
+//!  \type         local
+//!
+//!  \param[in]    uint8_t port_nr
+//!                vector<IsduRequest> &requests (as reference, data and status
+//!                are filled in per request)
+//!
+//!  \return       0 if all requests succeeded
+//!
+//!*******************************************************************************
+
+uint8_t ShieldCommunication::ISDU_Batch(uint8_t port_nr, vector<IsduRequest> &requests)
+{
+    uint8_t retVal = SUCCESS;
+
+    if (port_nr >= ports.size())
+    {
+        for (auto &request : requests)
+        {
+            request.status = ERROR;
         }
-        // read ISDU
-        retVal = ports.at(port_nr).readISDU(oData, index, subIndex);
-        if (port_nr == 0 || 1)
+        return ERROR;
+    }
+    // check if Port is connected
+    int OnRequestData = get<0>(ports.at(port_nr).getLengthParameter());
+    int ProcessDataIn = get<1>(ports.at(port_nr).getLengthParameter());
+    int ProcessDataOut = get<2>(ports.at(port_nr).getLengthParameter());
+
+    if (OnRequestData || ProcessDataIn || ProcessDataOut) // if Device Connected -> execute requests
+    {
+        lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+        if (portClaimed[port_nr].load(memory_order_acquire))
         {
-            max1Mutex.unlock();
+            retVal = ERROR; // Port_startup works on the port
+            for (auto &request : requests)
+            {
+                request.status = ERROR;
+            }
         }
         else
         {
-            max2Mutex.unlock();
+            retVal = ports.at(port_nr).processISDUBatch(requests);
         }
     }
     else
     {
         retVal = ERROR;
+        for (auto &request : requests)
+        {
+            request.status = ERROR;
+        }
         cout << "ERROR - No Device connected" << endl;
     }
-    Data = oData;
-    /*for(int i=0;i<Data.size();i++)
-    {
-        cout<<"Wert: "<<int(Data[i])<<endl;
-    }*/
-    return;
+    return retVal;
 }
 
 //!*******************************************************************************
@@ -417,35 +531,19 @@ void ShieldCommunication::Read_port(uint8_t port_nr)
 {
     uint8_t retVal = SUCCESS;
 
-    vector<uint8_t> pData;
-
     while (true)
     {
         if (ports.at(port_nr).get_DeviceConnection() == 0)
         { // if Device Connected
-            if (port_nr == 0 || port_nr == 1)
-            {
-                max1Mutex.lock();
-            }
-            else
+            lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+            if (portClaimed[port_nr].load(memory_order_acquire))
             {
-                max2Mutex.lock();
+                retVal = ERROR; // Port_startup works on the port, no cycle until it is done
+                break;
             }
-            ports.at(port_nr).readPD(pData);
+            ports.at(port_nr).readPD(); // stores the frame in the PDclass of the port
             retVal = ports.at(port_nr).readErrorRegister();
-            ports.at(port_nr).get_PDclass()->write_pd_storage(pData);
-            if (port_nr == 0 || port_nr == 1)
-            {
-                max1Mutex.unlock();
-            }
-            else
-            {
-                max2Mutex.unlock();
-            }
-            if (pData.size() > 0)
-            {
-                break; // Exit the loop if data was successfully read
-            }
+            break; // the frame (or its error) has been stored
         }
         else
         {
@@ -458,251 +556,1278 @@ void ShieldCommunication::Read_port(uint8_t port_nr)
 }
 
 //!*******************************************************************************
-//!  function :    PD_all_ports
+//!  function :    chipMutex
 //!*******************************************************************************
-//!  \brief        Function to read PD and write PD of all ports
+//!  \brief        Mutex of the MAX14819 driving a port, ports 0/1 are on
+//!                DRIVER01, ports 2/3 on DRIVER23
 //!
 //!  \type         local
 //!
-//!  \param[in]    void
+//!  \param[in]    port_nr              port number
+//!
+//!  \return       max1Mutex or max2Mutex
+//!
+//!*********************************************************
+
+recursive_mutex &ShieldCommunication::chipMutex(uint8_t port_nr)
+{
+    return (port_nr < PORTS_PER_CHIP) ? max1Mutex : max2Mutex;
+}
+
+//!*******************************************************************************
+//!  function :    claimPort
+//!*******************************************************************************
+//!  \brief        Reserves a port for a startup (begin, reconnect, Data
+//!                Storage) that runs without holding the chip mutex, the
+//!                driver only locks it per SPI transaction. The PD cycle and
+//!                the REST requests check the claim with the chip mutex held
+//!                and leave the port alone, the other port of the chip keeps
+//!                running.
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              port number
+//!
+//!  \return       true if claimed, false if someone else already has the port
+//!
+//!*********************************************************
+
+bool ShieldCommunication::claimPort(uint8_t port_nr)
+{
+    // taken under the chip mutex: a cycle that saw the port unclaimed is done
+    lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+    bool claimed = false;
+    return portClaimed[port_nr].compare_exchange_strong(claimed, true, memory_order_acq_rel);
+}
+
+//!*******************************************************************************
+//!  function :    releasePort
+//!*******************************************************************************
+//!  \brief        Hands a claimed port back to the PD cycle
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              port number
 //!
 //!  \return       void
 //!
 //!*********************************************************
 
-void ShieldCommunication::PD_all_ports()
+void ShieldCommunication::releasePort(uint8_t port_nr)
 {
-    string currentTime;
-    typedef std::chrono::high_resolution_clock Time;
-    typedef std::chrono::milliseconds ms;
-    typedef std::chrono::duration<float> fsec;
-    string TOPIC_ORIGINATOR_ID = "Shield";
-    string TOPIC_PORT = "Port";
-    string TOPIC_DATA_SELECTOR_EVENT = "pd";
-    nlohmann::json jsonobject;
-    nlohmann::json tmpobject;
-    string jsonstring;
-    string tmpstring;
-    char *pointer;
-    int OnRequestData = 0;
-    int ProcessDataIn = 0;
-    int ProcessDataOut = 0;
-    int port_nr = 0;
-    while (1)
+    portClaimed[port_nr].store(false, memory_order_release);
+}
+
+//!*******************************************************************************
+//!  function :    chipCount
+//!*******************************************************************************
+//!  \brief        Number of fitted MAX14819, one PD_chip_ports thread each
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       1 or 2 (extended board)
+//!
+//!*********************************************************
+
+size_t ShieldCommunication::chipCount() const
+{
+    size_t count = 0;
+    for (const auto &chip : chips)
     {
-        currentTime = getCurrentTimeStamp();
-        auto t0 = Time::now();
-        for (auto &nr : ports)
+        if (chip.portCount != 0)
         {
-            Read_port(port_nr);
-            hardware.wait_for(1);
-            Write_Port(port_nr);
-            OnRequestData = get<0>(nr.getLengthParameter());
-            ProcessDataIn = get<1>(nr.getLengthParameter());
-            ProcessDataOut = get<2>(nr.getLengthParameter());
-            if (OnRequestData || ProcessDataIn || ProcessDataOut) // if Device Connected
-            {
-                // TOPIC
-                std::string topic_str = fmt::format("{}/{}{}/{}", TOPIC_ORIGINATOR_ID, TOPIC_PORT, std::to_string(port_nr), TOPIC_DATA_SELECTOR_EVENT);
-                // JSON
-                jsonobject = nr.get_PDclass()->interpretProcessData(service);
-                jsonobject["ts"] = currentTime;
-                jsonstring = jsonobject.dump();
-                /* tmpobject = nr.get_PDclass()->interpretProcessData(instance);
-                 tmpobject["ts"] = currentTime;
-                 tmpstring = tmpobject.dump();*/
-                cout << "---------------------------------------------------------------------------------------------------------------" << endl;
-                cout << "interpreted ProcessData new: " << jsonstring << endl;
-                //  cout << "interpreted ProcessData old: " << tmpstring << endl;
-                pointer = &jsonstring[0];
-                int qos = 0; // QoS level
-                int retVal = mosquitto_publish(mosq, NULL, topic_str.c_str(), jsonstring.size(), pointer, qos, false);
-            }
-            port_nr++;
+            count++;
         }
-        port_nr = 0;
-        auto t1 = Time::now();
-        fsec fs = t1 - t0;
-        ms d = std::chrono::duration_cast<ms>(fs);
-        if (cycleTime - d.count() >= 0)
-            hardware.wait_for(uint32_t(cycleTime - uint32_t(d.count())));
     }
-    return;
+    return count;
 }
 
 //!*******************************************************************************
-//!  function :    Write
+//!  function :    PD_chip_ports
 //!*******************************************************************************
-//!  \brief        Function to proof if a device is connected and after that
-//!                writing Process-Data of the stored variable in
+//!  \brief        Acquisition stage of one MAX14819: reads and writes the PD
+//!                of its ports and hands the frames to PD_decode. Only bus
+//!                I/O happens here, decoding, logging and the broker never
+//!                stretch the cycle. The chips have their own SPI chip select
+//!                and mutex, so their threads don't wait for each other.
 //!
 //!  \type         local
 //!
-//!  \param[in]    void
+//!  \param[in]    chip                 0: ports 0/1, 1: ports 2/3
 //!
 //!  \return       void
 //!
 //!*********************************************************
 
-void ShieldCommunication::Write_Port(uint8_t port_nr)
+void ShieldCommunication::PD_chip_ports(uint8_t chip)
 {
-    uint8_t retVal = SUCCESS;
-    // check if Port is connected
+    if ((chip >= PIPELINE_CHIPS) || (chips[chip].portCount == 0))
+    {
+        return;
+    }
+    AcquisitionChip &context = chips[chip];
     int OnRequestData = 0;
     int ProcessDataIn = 0;
     int ProcessDataOut = 0;
-
-    OnRequestData = get<0>(ports.at(port_nr).getLengthParameter());
-    ProcessDataIn = get<1>(ports.at(port_nr).getLengthParameter());
-    ProcessDataOut = get<2>(ports.at(port_nr).getLengthParameter());
-
-    if (ports.at(port_nr).get_DeviceConnection() == 0) // if Device Connected -> write Data to device
+    PipelineSample item;
+    vector<uint64_t> lastSequence(context.portCount, 0); // of the last forwarded frame per port
+    while (1)
     {
-        if (ProcessDataOut == 0)
-            return;
-        uint8_t sizeAnswer = 2; // MC + CKS
-        vector<uint8_t> Datavector = ports.at(port_nr).get_PDclass()->get_procDataOut();
-        if (Datavector.size() != ProcessDataOut)
+        context.scheduler.beginCycle();
+        for (uint8_t index = 0; index < context.portCount; index++)
         {
-            Datavector.clear();
-            for (int i = 0; i < ProcessDataOut; i++)
+            const uint8_t port_nr = uint8_t(context.firstPort + index);
+            IOLMasterPortMax14819 &nr = ports.at(port_nr);
+            context.scheduler.beginPort(index);
+            Read_port(port_nr);
+            hardware.wait_for(1);
+            Write_Port(port_nr);
+            OnRequestData = get<0>(nr.getLengthParameter());
+            ProcessDataIn = get<1>(nr.getLengthParameter());
+            ProcessDataOut = get<2>(nr.getLengthParameter());
+            item.port = port_nr;
+            if (OnRequestData || ProcessDataIn || ProcessDataOut) // IO-Link mode, the lengths stay set after a dropout
             {
-                Datavector.push_back(0);
+                item.sio = false;
+                item.sample = nr.get_PDclass()->read_pd();
+                // only frames read in this cycle, not the last one again while the device is gone
+                if ((nr.get_DeviceConnection() == 0) && (item.sample.sequence != lastSequence.at(index)))
+                {
+                    lastSequence.at(index) = item.sample.sequence;
+                    context.stage.forward(context.samples, item);
+                }
+            }
+            else if ((nr.getPortMode() == IOL::PORT_MODE::SIO_INPUT) || (nr.getPortMode() == IOL::PORT_MODE::SIO_OUTPUT))
+            {
+                item.sio = true;
+                item.sample.timestamp = pdTimestamp();
+                context.stage.forward(context.samples, item);
             }
         }
-        Datavector.push_back(IOL::MC::PDOUT_VALID);
-        for (int i = 1; i < OnRequestData; i++)
-        {
-            Datavector.push_back(0);
-        }
-        uint8_t sizeData = Datavector.size();
-
-        if (ProcessDataOut + OnRequestData != int(sizeData)) // wrong PDout Length!
-        {
-            cout << "ERROR - Wrong PDout Length" << endl;
-            return;
-        }
-
-        if (port_nr == 0 || 1)
-        {
-            max1Mutex.lock();
-        }
-        else
-        {
-            max2Mutex.lock();
-        }
-        uint8_t Data[Datavector.size()];
-        for (int i = 0; i < Datavector.size(); i++)
-        {
-            Data[i] = Datavector[i];
-        }
-        uint8_t *pData = &Data[0];
-        retVal = ports.at(port_nr).writePD(sizeData, pData, sizeAnswer);
-        if (port_nr == 0 || 1)
-        {
-            max1Mutex.unlock();
-        }
-        else
-        {
-            max2Mutex.unlock();
-        }
-    }
-    else
-    {
-        retVal = ERROR;
-        // cout<<"ERROR - No Device connected"<<endl;
+        // absolute deadlines, the duration of the cycle doesn't shift the next one
+        int period = cycleTime.load(memory_order_relaxed);
+        context.scheduler.endCycle((period > 0) ? uint32_t(period) : 0);
     }
     return;
 }
 
 //!*******************************************************************************
-//!  function :    Write_procDataOut
+//!  function :    Port_startup
 //!*******************************************************************************
-//!  \brief        Function to proof if a device is connected and after that
-//!                reading Process-Data and store it in the right variable in PDclass
+//!  \brief        Gets devices back outside the PD cycle: the fast reconnect
+//!                of a dropped out device, the complete begin() of ports that
+//!                reconnect() marked (no, another or a differently configured
+//!                device) and the Data Storage synchronization afterwards.
+//!                The port is claimed instead of holding the chip mutex, the
+//!                wake-up and the startup delays don't stall the other port
+//!                of the chip.
 //!
 //!  \type         local
 //!
-//!  \param[in]    uint8_t port_nr
-//!                vector<uint8_t> Data
+//!  \param[in]    void
 //!
 //!  \return       void
 //!
 //!*********************************************************
 
-void ShieldCommunication::Write_procDataOut(uint8_t port_nr, vector<uint8_t> Data)
+void ShieldCommunication::Port_startup()
 {
-    cout << "Write_procDataOut" << endl;
-    for (uint8_t i : Data)
+    typedef std::chrono::steady_clock Time;
+    constexpr std::chrono::seconds STARTUP_RETRY_INTERVAL(5); // begin() takes seconds, don't repeat it right away
+    constexpr std::chrono::milliseconds STARTUP_POLL_INTERVAL(100); // also the time between two reconnect attempts
+    vector<Time::time_point> nextStartup(ports.size(), Time::now());
+    while (1)
     {
-        cout << int(i) << endl;
+        for (uint8_t port_nr = 0; port_nr < ports.size(); port_nr++)
+        {
+            IOLMasterPortMax14819 &nr = ports.at(port_nr);
+            bool startup = nr.needsFullStartup() && (Time::now() >= nextStartup.at(port_nr));
+            bool reconnect = !nr.needsFullStartup() && (nr.get_DeviceConnection() != 0) && nr.hasLastKnownDevice();
+            if (!(startup || reconnect || dataStoragePending[port_nr].load(memory_order_acquire)) || !claimPort(port_nr))
+            {
+                continue; // nothing to do or a REST request works on the port
+            }
+            bool synchronize = dataStoragePending[port_nr].exchange(false, memory_order_acq_rel);
+            if (startup)
+            {
+                nr.begin();
+                nextStartup.at(port_nr) = Time::now() + STARTUP_RETRY_INTERVAL;
+                synchronize = true;
+            }
+            else if (reconnect && (nr.reconnect() == SUCCESS))
+            {
+                synchronize = true;
+            }
+            if (synchronize && (nr.get_DeviceConnection() == 0))
+            {
+                registerReadOnly(nr);
+                dataStorage.synchronize(nr, port_nr);
+            }
+            releasePort(port_nr);
+        }
+        this_thread::sleep_for(STARTUP_POLL_INTERVAL);
     }
-    ports.at(port_nr).get_PDclass()->write_procDataOut(Data);
     return;
 }
 
 //!*******************************************************************************
-//!  function :    writeCycleTime
+//!  function :    registerReadOnly
 //!*******************************************************************************
-//!  \brief        ???
+//!  \brief        Adds the variables the IODD of the connected device declares
+//!                read-only (accessRights="ro") to the parameter cache of the
+//!                port. Called when a device was found, before the Data
+//!                Storage reads its parameters.
 //!
 //!  \type         local
 //!
-//!  \param[in]    int time_in_ms
+//!  \param[in]    &nr                  port with a connected device
 //!
 //!  \return       void
 //!
 //!*********************************************************
 
-void ShieldCommunication::writeCycleTime(int time_in_ms)
+void ShieldCommunication::registerReadOnly(IOLMasterPortMax14819 &nr)
 {
-    cycleTime = time_in_ms;
-    return;
+    vector<uint16_t> indices;
+    if (service.findReadOnly(get<0>(nr.getDeviceId()), get<1>(nr.getDeviceId()), indices))
+    {
+        for (uint16_t index : indices)
+        {
+            nr.get_ParameterCache()->addReadOnly(index, 0);
+        }
+    }
 }
 
 //!*******************************************************************************
-//!  function :    isDeviceConnected
+//!  function :    PD_decode
 //!*******************************************************************************
-//!  \brief        check on all ports if a device is connected (triggered by CROW)
+//!  \brief        Decode stage: filters, decodes and serializes the frames of
+//!                PD_chip_ports and hands the payloads to PD_publish
 //!
 //!  \type         local
 //!
-//!  \param[in]    vector<uint8_t>& portConnection
+//!  \param[in]    void
 //!
 //!  \return       void
 //!
 //!*********************************************************
 
-void ShieldCommunication::isDeviceConnected(vector<uint8_t> &portConnection)
+void ShieldCommunication::PD_decode()
 {
-    int portNummer = 0;
-    for (auto &nr : ports)
+    nlohmann::json jsonobject;
+    vector<unique_ptr<JsonTemplate>> payloadTemplates(ports.size()); // per port, rebuilt if the plan changes
+    vector<IolValue> values;
+    struct AdvertisedSchema
+    {
+        bool published = false;
+        PayloadFormat format;
+        uint32_t planId = 0;
+    };
+    vector<AdvertisedSchema> schemas(ports.size()); // last retained schema per port
+    PipelineSample item;
+    PipelineMessage message;
+    size_t nextChip = 0;
+    while (1)
     {
-        if (portNummer == 0 || 1)
+        // the chips are polled in turn, the samples of a port stay in order
+        bool popped = false;
+        for (size_t i = 0; (i < PIPELINE_CHIPS) && !popped; i++)
         {
-            max1Mutex.lock();
+            popped = chips[nextChip].samples.pop(item);
+            nextChip = (nextChip + 1) % PIPELINE_CHIPS;
         }
-        else
+        if (!popped)
         {
-            max2Mutex.lock();
+            hardware.wait_for(1);
+            continue;
         }
-
-        nr.isDeviceConnected();
-
-        if (portNummer == 0 || 1)
+        const uint8_t port_nr = item.port;
+        IOLMasterPortMax14819 &nr = ports.at(port_nr);
+        const PDSample &sample = item.sample;
+        auto sampleTime = chrono::system_clock::time_point(chrono::duration_cast<chrono::system_clock::duration>(chrono::nanoseconds(sample.timestamp)));
+        message.port = port_nr;
+        message.schema = false;
+        message.encoding = PayloadEncoding::Json;
+        if (item.sio)
         {
-            max1Mutex.unlock();
+            // SIO ports are published on the same topic as the process data
+            jsonobject = sioToJson(nr);
+            jsonobject["ts"] = getTimeStamp(sampleTime);
+            message.payload = jsonobject.dump();
+            decodeStage.forward(pipelineMessages, message);
+            continue;
         }
-        else
+        if (!sample.valid)
         {
-            max2Mutex.unlock();
+            continue; // frame with an error, the PD history keeps it but it isn't a measurement
         }
 
-        if (nr.get_DeviceConnection() == 0)
-            portConnection.push_back(0);
+        // unchanged PD (or changes within the deadbands) is only published with the heartbeat
+        PublishFilter &filter = publishFilters.at(port_nr);
+        auto now = std::chrono::steady_clock::now();
+        if (!filter.needsDecode(sample, now))
+        {
+            continue;
+        }
+        bool publish = false;
+        PayloadFormat format;
+        get_PayloadFormat(port_nr, format);
+        const string currentTime = (format.encoding == PayloadEncoding::Json) ? getTimeStamp(sampleTime) : string();
+        string &payload = message.payload;
+        shared_ptr<const DecodePlan> plan = nr.get_PDclass()->findPlan(service);
+        const bool decodable = plan && !plan->elements.empty();
+        if (decodable)
+        {
+            values.resize(plan->elements.size());
+            IoddService::decode(*plan, sample.data, sample.length, values.data());
+            publish = filter.needsPublish(sample, plan, values.data(), now);
+            if (publish && (format.encoding == PayloadEncoding::Json))
+            {
+                // only the values are written into the JSON template of the plan
+                unique_ptr<JsonTemplate> &jsonTemplate = payloadTemplates.at(port_nr);
+                if (!jsonTemplate || (jsonTemplate->plan() != plan.get()))
+                {
+                    jsonTemplate = make_unique<JsonTemplate>(plan);
+                }
+                jsonTemplate->serialize(values.data(), currentTime, payload);
+            }
+            else if (publish && format.raw)
+            {
+                payload::encodeRaw(format.encoding, plan->id, sample.data, sample.length, sample.timestamp, payload);
+            }
+            else if (publish)
+            {
+                payload::encodeValues(format.encoding, *plan, values.data(), sample.timestamp, payload);
+            }
+        }
         else
-            portConnection.push_back(1);
-
+        {
+            // JSON, raw PD of unknown devices
+            jsonobject = nr.get_PDclass()->interpretProcessData(service, sample);
+            publish = filter.needsPublish(sample, jsonobject, now);
+            if (publish && (format.encoding == PayloadEncoding::Json))
+            {
+                jsonobject["ts"] = currentTime;
+                payload = jsonobject.dump();
+            }
+            else if (publish)
+            {
+                payload::encodeRaw(format.encoding, 0u, sample.data, sample.length, sample.timestamp, payload);
+            }
+        }
+        if (!publish)
+        {
+            continue;
+        }
+        // the subscribers need the schema before the first payload in a new format
+        AdvertisedSchema &schema = schemas.at(port_nr);
+        const uint32_t planId = decodable ? plan->id : 0u;
+        if (!schema.published || (schema.format != format) || (schema.planId != planId))
+        {
+            PipelineMessage schemaMessage;
+            schemaMessage.port = port_nr;
+            schemaMessage.schema = true;
+            schemaMessage.payload = payload::schema(format, decodable ? plan.get() : nullptr).dump();
+            if (decodeStage.forward(pipelineMessages, schemaMessage))
+            {
+                schema.published = true;
+                schema.format = format;
+                schema.planId = planId;
+            }
+        }
+        message.encoding = format.encoding;
+        decodeStage.forward(pipelineMessages, message);
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    PD_publish
+//!*******************************************************************************
+//!  \brief        Publish stage: logs the payloads of PD_decode and publishes
+//!                them to MQTT (Shield/Port<n>/pd, retained Shield/Port<n>/schema)
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::PD_publish()
+{
+    string TOPIC_ORIGINATOR_ID = "Shield";
+    string TOPIC_PORT = "Port";
+    string TOPIC_DATA_SELECTOR_EVENT = "pd";
+    string TOPIC_DATA_SELECTOR_SCHEMA = "schema";
+    vector<string> pdTopics;
+    vector<string> schemaTopics;
+    for (size_t port_nr = 0; port_nr < ports.size(); port_nr++)
+    {
+        pdTopics.push_back(fmt::format("{}/{}{}/{}", TOPIC_ORIGINATOR_ID, TOPIC_PORT, std::to_string(port_nr), TOPIC_DATA_SELECTOR_EVENT));
+        schemaTopics.push_back(fmt::format("{}/{}{}/{}", TOPIC_ORIGINATOR_ID, TOPIC_PORT, std::to_string(port_nr), TOPIC_DATA_SELECTOR_SCHEMA));
+    }
+    PipelineMessage message;
+    while (1)
+    {
+        if (!pipelineMessages.pop(message))
+        {
+            hardware.wait_for(1);
+            continue;
+        }
+        int retVal;
+        if (message.schema)
+        {
+            // retained, the subscribers decode with it. The PUBACK is handled by the
+            // network loop thread, mosquitto_publish doesn't wait for it.
+            int qos = 1;
+            retVal = mosquitto_publish(mosq, NULL, schemaTopics.at(message.port).c_str(), message.payload.size(), message.payload.c_str(), qos, true);
+            if (retVal != MOSQ_ERR_SUCCESS)
+            {
+                cout << "Schema of port " << int(message.port) << " not published: " << mosquitto_strerror(retVal) << endl;
+            }
+        }
+        else
+        {
+            int qos = 0; // QoS level
+            retVal = mosquitto_publish(mosq, NULL, pdTopics.at(message.port).c_str(), message.payload.size(), message.payload.c_str(), qos, false);
+        }
+        publishStage.count(retVal == MOSQ_ERR_SUCCESS);
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    PD_pipeline_status
+//!*******************************************************************************
+//!  \brief        Counters of the PD pipeline stages (triggered by CROW)
+//!
+//!  \type         local
+//!
+//!  \param[in]    reset                clear the counters after reading
+//!  \param[out]   result               JSON object with the counters
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::PD_pipeline_status(bool reset, nlohmann::json &result)
+{
+    auto stageToJson = [](const PipelineStage &stage, const char *processed, const char *dropped, size_t capacity)
+    {
+        nlohmann::json object;
+        object[processed] = stage.processed.load(std::memory_order_relaxed);
+        object[dropped] = stage.dropped.load(std::memory_order_relaxed);
+        if (capacity != 0)
+        {
+            object["MaxQueued"] = stage.maxQueued.load(std::memory_order_relaxed);
+            object["Capacity"] = capacity;
+        }
+        return object;
+    };
+    nlohmann::json acquisition = nlohmann::json::array();
+    size_t queuedSamples = 0;
+    for (size_t chip = 0; chip < chipCount(); chip++)
+    {
+        acquisition.push_back(stageToJson(chips[chip].stage, "Samples", "Dropped", chips[chip].samples.capacity()));
+        queuedSamples += chips[chip].samples.size();
+    }
+    result["Acquisition"] = acquisition; // per chip
+    result["Decode"] = stageToJson(decodeStage, "Messages", "Dropped", pipelineMessages.capacity());
+    result["Publish"] = stageToJson(publishStage, "Published", "Failed", 0);
+    result["Queued"] = {{"Samples", queuedSamples}, {"Messages", pipelineMessages.size()}};
+    if (reset)
+    {
+        for (auto &chip : chips)
+        {
+            chip.stage.reset();
+        }
+        decodeStage.reset();
+        publishStage.reset();
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    PD_cycle_status
+//!*******************************************************************************
+//!  \brief        Overrun policy and timing statistics of the PD cycle
+//!                (triggered by CROW)
+//!
+//!  \type         local
+//!
+//!  \param[in]    policy               new overrun policy ("skip", "catchup"), empty keeps it
+//!  \param[in]    reset                clear the statistics after reading
+//!  \param[out]   result               JSON object with the statistics
+//!
+//!  \return       SUCCESS or ERROR (unknown policy)
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::PD_cycle_status(const string &policy, bool reset, nlohmann::json &result)
+{
+    if (!policy.empty())
+    {
+        OverrunPolicy overrunPolicy;
+        if (!CycleScheduler::policyFromString(policy, overrunPolicy))
+        {
+            return ERROR;
+        }
+        for (auto &chip : chips)
+        {
+            chip.scheduler.setPolicy(overrunPolicy);
+        }
+    }
+    // every chip has its own cycle, PortStart is indexed by the ports of the chip
+    nlohmann::json cycles = nlohmann::json::array();
+    for (size_t chip = 0; chip < chipCount(); chip++)
+    {
+        nlohmann::json cycle = chips[chip].scheduler.toJson();
+        nlohmann::json chipPorts = nlohmann::json::array();
+        for (uint8_t index = 0; index < chips[chip].portCount; index++)
+        {
+            chipPorts.push_back(chips[chip].firstPort + index);
+        }
+        cycle["Ports"] = chipPorts;
+        cycles.push_back(cycle);
+        if (reset)
+        {
+            chips[chip].scheduler.reset();
+        }
+    }
+    result["Chips"] = cycles;
+    result["CycleTime_ms"] = cycleTime.load(memory_order_relaxed);
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    Write
+//!*******************************************************************************
+//!  \brief        Function to proof if a device is connected and after that
+//!                writing Process-Data of the stored variable in
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::Write_Port(uint8_t port_nr)
+{
+    uint8_t retVal = SUCCESS;
+    // check if Port is connected
+    int OnRequestData = 0;
+    int ProcessDataIn = 0;
+    int ProcessDataOut = 0;
+
+    OnRequestData = get<0>(ports.at(port_nr).getLengthParameter());
+    ProcessDataIn = get<1>(ports.at(port_nr).getLengthParameter());
+    ProcessDataOut = get<2>(ports.at(port_nr).getLengthParameter());
+
+    if (ports.at(port_nr).get_DeviceConnection() == 0) // if Device Connected -> write Data to device
+    {
+        if (ProcessDataOut == 0)
+            return;
+        lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+        if (portClaimed[port_nr].load(memory_order_acquire))
+        {
+            return; // Port_startup works on the port
+        }
+        retVal = ports.at(port_nr).writeProcessDataOut(); // PDout latched at the start of this cycle
+    }
+    else
+    {
+        retVal = ERROR;
+        // cout<<"ERROR - No Device connected"<<endl;
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    Write_procDataOut
+//!*******************************************************************************
+//!  \brief        Function to proof if a device is connected and after that
+//!                reading Process-Data and store it in the right variable in PDclass
+//!
+//!  \type         local
+//!
+//!  \param[in]    uint8_t port_nr
+//!                vector<uint8_t> Data
+//!
+//!  \return       sequence number of the update, applied at the next cycle
+//!
+//!*********************************************************
+
+uint64_t ShieldCommunication::Write_procDataOut(uint8_t port_nr, vector<uint8_t> Data)
+{
+    lock_guard<mutex> lock(pdOutWriteMutex);
+    return ports.at(port_nr).get_PDclass()->write_procDataOut(Data);
+}
+
+//!*******************************************************************************
+//!  function :    Write_procDataOutValues
+//!*******************************************************************************
+//!  \brief        Writes fields of the PD out by name (or field id), packed
+//!                with the PD out plan of the device into the PD out to be sent
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!  \param[in]    encoding             Json, Cbor or MsgPack, see PDOutValues
+//!  \param[in]    body                 the values
+//!  \param[out]   sequence             sequence number of the update, applied
+//!                                     at the next cycle
+//!  \param[out]   error                problem, if ERROR is returned
+//!
+//!  \return       SUCCESS or ERROR
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::Write_procDataOutValues(uint8_t port_nr, PayloadEncoding encoding, const string &body, uint64_t &sequence, string &error)
+{
+    if (port_nr >= ports.size())
+    {
+        error = "invalid port";
+        return ERROR;
+    }
+    PDclass *pd = ports.at(port_nr).get_PDclass();
+    shared_ptr<const DecodePlan> plan = pd->findOutPlan(service);
+    if (!plan)
+    {
+        error = "no PD out layout known for the device";
+        return ERROR;
+    }
+    PDOutValues values;
+    bool parsed;
+    if (encoding == PayloadEncoding::Json)
+    {
+        const nlohmann::json object = nlohmann::json::parse(body, nullptr, false);
+        parsed = values.fromJson(*plan, object, error);
+    }
+    else
+    {
+        parsed = values.fromBinary(encoding, *plan, reinterpret_cast<const uint8_t *>(body.data()), body.size(), error);
+    }
+    if (!parsed)
+    {
+        return ERROR;
+    }
+    {
+        lock_guard<mutex> lock(pdOutWriteMutex);
+        sequence = pd->write_procDataOut(*plan, values.values());
+    }
+    if (sequence == 0)
+    {
+        error = "the PD out of the port is shorter than the layout";
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    waitProcDataOut
+//!*******************************************************************************
+//!  \brief        Waits until a PD out update has been sent to the device
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!  \param[in]    sequence             sequence number from Write_procDataOut
+//!  \param[in]    timeout_ms           maximum time to wait
+//!  \param[out]   ack                  last acknowledged PD out
+//!
+//!  \return       SUCCESS if the update (or a newer one) reached the wire
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::waitProcDataOut(uint8_t port_nr, uint64_t sequence, uint32_t timeout_ms, PDOutAck &ack)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    PDclass *pdclass = ports.at(port_nr).get_PDclass();
+    ack = pdclass->read_procDataOutAck();
+    while (ack.sequence < sequence)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return ERROR;
+        }
+        this_thread::sleep_for(std::chrono::microseconds(200));
+        ack = pdclass->read_procDataOutAck();
+    }
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    PD_out_status
+//!*******************************************************************************
+//!  \brief        Pending and acknowledged PD out sequence and the request to
+//!                wire latency histogram of a port
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!  \param[in]    resetLatency         clear the histogram after reading it
+//!  \param[out]   result               JSON object
+//!
+//!  \return       SUCCESS, ERROR on an invalid port
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::PD_out_status(uint8_t port_nr, bool resetLatency, nlohmann::json &result)
+{
+    if (port_nr >= ports.size())
+    {
+        return ERROR;
+    }
+    PDclass *pdclass = ports.at(port_nr).get_PDclass();
+    PDOutAck ack = pdclass->read_procDataOutAck();
+    result = nlohmann::json::object();
+    result["Port"] = port_nr;
+    result["Pending"] = pdclass->read_procDataOut().sequence;
+    result["Applied"] = ack.sequence;
+    result["RequestTimestamp"] = ack.requestTimestamp;
+    result["WireTimestamp"] = ack.wireTimestamp;
+    result["Latency"] = pdclass->get_outLatency().toJson();
+    if (resetLatency)
+    {
+        pdclass->get_outLatency().reset();
+    }
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    writeCycleTime
+//!*******************************************************************************
+//!  \brief        ???
+//!
+//!  \type         local
+//!
+//!  \param[in]    int time_in_ms
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::writeCycleTime(int time_in_ms)
+{
+    cycleTime = time_in_ms;
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    SIO_poll
+//!*******************************************************************************
+//!  \brief        Function to sample the lines of all ports in SIO mode which
+//!                have no interrupt (CQ level and DI of port 3 out of the
+//!                IOStCfg register). Every register read takes the mutex of
+//!                the chip, it must not interleave with the PD thread of the
+//!                chip or a REST request.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::SIO_poll()
+{
+    constexpr chrono::microseconds SIO_POLL_INTERVAL(250);
+    constexpr chrono::milliseconds SIO_IDLE_INTERVAL(10);
+    uint8_t level = 0;
+    while (1)
+    {
+        bool active = false;
+        for (uint8_t port_nr = 0; port_nr < ports.size(); port_nr++)
+        {
+            auto &nr = ports.at(port_nr);
+            if (nr.get_SioCQ()->isEnabled())
+            {
+                uint8_t retVal;
+                {
+                    lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+                    retVal = portClaimed[port_nr].load(memory_order_acquire) ? ERROR : nr.readCQ(level);
+                }
+                if (retVal == SUCCESS)
+                {
+                    nr.get_SioCQ()->sample(level, SioChannel::now());
+                    active = true;
+                }
+            }
+            if ((port_nr >= DI_INTERRUPT_PORTS) && nr.get_SioDI()->isEnabled())
+            {
+                uint8_t retVal;
+                {
+                    lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+                    retVal = portClaimed[port_nr].load(memory_order_acquire) ? ERROR : nr.readDI(level);
+                }
+                if (retVal == SUCCESS)
+                {
+                    nr.get_SioDI()->sample(level, SioChannel::now());
+                    active = true;
+                }
+            }
+        }
+        if (active)
+            this_thread::sleep_for(SIO_POLL_INTERVAL);
+        else
+            this_thread::sleep_for(SIO_IDLE_INTERVAL);
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    sioToJson
+//!*******************************************************************************
+//!  \brief        Converts the state of a SIO port and all edges captured since
+//!                the last call into JSON
+//!
+//!  \type         local
+//!
+//!  \param[in]    &port               port in SIO mode
+//!
+//!  \return       json object
+//!
+//!*********************************************************
+
+nlohmann::json ShieldCommunication::sioToJson(IOLMasterPortMax14819 &port)
+{
+    nlohmann::json jsonobject;
+    SioEdge edge;
+    jsonobject["Mode"] = (port.getPortMode() == IOL::PORT_MODE::SIO_OUTPUT) ? "SIO_OUT" : "SIO_IN";
+    jsonobject["CQ"] = port.get_SioCQ()->getLevel();
+    jsonobject["DI"] = port.get_SioDI()->getLevel();
+    jsonobject["CQPulses"] = port.get_SioCQ()->getPulseCount();
+    jsonobject["DIPulses"] = port.get_SioDI()->getPulseCount();
+    jsonobject["Overruns"] = port.get_SioCQ()->getOverruns() + port.get_SioDI()->getOverruns();
+    jsonobject["CQEdges"] = nlohmann::json::array();
+    while (port.get_SioCQ()->popEdge(edge))
+    {
+        jsonobject["CQEdges"].push_back({{"Level", edge.level}, {"ts_ns", edge.timestamp}});
+    }
+    jsonobject["DIEdges"] = nlohmann::json::array();
+    while (port.get_SioDI()->popEdge(edge))
+    {
+        jsonobject["DIEdges"].push_back({{"Level", edge.level}, {"ts_ns", edge.timestamp}});
+    }
+    return jsonobject;
+}
+
+//!*******************************************************************************
+//!  function :    setPortMode
+//!*******************************************************************************
+//!  \brief        Switches a port between IO-Link, SIO input, SIO output and
+//!                inactive (triggered by CROW)
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr             port number
+//!  \param[in]    mode                IOL::PORT_MODE
+//!  \param[in]    debounce_us         debounce time of the SIO lines
+//!
+//!  \return       0 if success
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::setPortMode(uint8_t port_nr, uint16_t mode, uint32_t debounce_us)
+{
+    if (port_nr >= ports.size())
+    {
+        return ERROR;
+    }
+    if (!claimPort(port_nr))
+    {
+        return ERROR; // Port_startup works on the port
+    }
+    // claimed, the startup of IO-Link mode doesn't hold the chip mutex across its delays
+    ports.at(port_nr).get_SioCQ()->setDebounce(debounce_us);
+    ports.at(port_nr).get_SioDI()->setDebounce(debounce_us);
+    uint8_t retValue = ports.at(port_nr).setPortMode(mode);
+    if ((mode == IOL::PORT_MODE::IOLINK) && (ports.at(port_nr).get_DeviceConnection() == 0))
+    {
+        dataStoragePending[port_nr].store(true, memory_order_release); // Port_startup synchronizes
+    }
+    releasePort(port_nr);
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    writeCQ
+//!*******************************************************************************
+//!  \brief        Drives the CQ line of a port in SIO output mode (triggered by
+//!                CROW)
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr             port number
+//!  \param[in]    level               HIGH or LOW
+//!
+//!  \return       0 if success
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::writeCQ(uint8_t port_nr, uint8_t level)
+{
+    if (port_nr >= ports.size())
+    {
+        return ERROR;
+    }
+    lock_guard<recursive_mutex> lock(chipMutex(port_nr));
+    if (portClaimed[port_nr].load(memory_order_acquire))
+    {
+        return ERROR; // Port_startup works on the port
+    }
+    return ports.at(port_nr).writeCQ(level);
+}
+
+//!*******************************************************************************
+//!  function :    PD_history
+//!*******************************************************************************
+//!  \brief        Reads the PD history of a port. Served from the ring buffer of
+//!                the port without taking the chip mutex.
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!  \param[in]    bySequence           true: from is a sequence number and to is
+//!                                     ignored, false: from/to are ns since epoch
+//!  \param[in]    from                 first sequence number / start time
+//!  \param[in]    to                   end time (included)
+//!  \param[in]    step                 downsampling, every step-th sample
+//!  \param[in]    maxCount             maximum number of samples
+//!  \param[in]    decode               add the decoded values of every sample
+//!  \param[out]   result               JSON object with the samples
+//!
+//!  \return       SUCCESS, ERROR on an invalid port
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::PD_history(uint8_t port_nr, bool bySequence, uint64_t from, uint64_t to, size_t step, size_t maxCount, bool decode, nlohmann::json &result)
+{
+    if (port_nr >= ports.size())
+    {
+        return ERROR;
+    }
+    const PDHistory &history = ports.at(port_nr).get_PDclass()->get_history();
+    vector<PDSample> samples;
+    samples.reserve(min(maxCount, history.depth()));
+    if (bySequence)
+    {
+        history.querySequence(from, step, maxCount, samples);
+    }
+    else
+    {
+        history.queryTime(from, to, step, maxCount, samples);
+    }
+
+    result = nlohmann::json::object();
+    result["Port"] = port_nr;
+    result["Newest"] = history.newestSequence();
+    result["Depth"] = history.depth();
+    result["Samples"] = nlohmann::json::array();
+    for (const PDSample &sample : samples)
+    {
+        result["Samples"].push_back(pdSampleToJson(sample));
+    }
+    if (decode)
+    {
+        nlohmann::json measurements = ports.at(port_nr).get_PDclass()->interpretHistory(service, samples);
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            result["Samples"][i]["Values"] = move(measurements[i]);
+        }
+    }
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    pdSampleToJson
+//!*******************************************************************************
+//!  \brief        Raw PD sample as JSON, the data as hex string
+//!
+//!  \type         local
+//!
+//!  \param[in]    sample               PD sample
+//!
+//!  \return       nlohmann::json
+//!
+//!*********************************************************
+
+nlohmann::json ShieldCommunication::pdSampleToJson(const PDSample &sample)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    string data;
+    data.reserve(2 * sample.length);
+    for (uint8_t i = 0; i < sample.length; i++)
+    {
+        data.push_back(hexDigits[sample.data[i] >> 4]);
+        data.push_back(hexDigits[sample.data[i] & 0x0F]);
+    }
+    nlohmann::json jsonobject;
+    jsonobject["Sequence"] = sample.sequence;
+    jsonobject["Timestamp"] = sample.timestamp;
+    jsonobject["Valid"] = (sample.valid != 0);
+    jsonobject["Data"] = data;
+    return jsonobject;
+}
+
+//!*******************************************************************************
+//!  function :    get_PublishFilter
+//!*******************************************************************************
+//!  \brief        Returns the publish filter of a port
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!
+//!  \return       pointer to the filter, nullptr on an invalid port
+//!
+//!*********************************************************
+
+PublishFilter *ShieldCommunication::get_PublishFilter(uint8_t port_nr)
+{
+    if (port_nr >= publishFilters.size())
+    {
+        return nullptr;
+    }
+    return &publishFilters.at(port_nr);
+}
+
+//!*******************************************************************************
+//!  function :    set_PayloadFormat
+//!*******************************************************************************
+//!  \brief        Selects the encoding of the PD published by a port. The
+//!                schema topic is republished with the next payload.
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!  \param[in]    format               encoding and raw/decoded values
+//!
+//!  \return       SUCCESS or ERROR on an invalid port
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::set_PayloadFormat(uint8_t port_nr, const PayloadFormat &format)
+{
+    lock_guard<mutex> lock(payloadFormatsMutex);
+    if (port_nr >= payloadFormats.size())
+    {
+        return ERROR;
+    }
+    payloadFormats.at(port_nr) = format;
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    get_PayloadFormat
+//!*******************************************************************************
+//!  \brief        Returns the encoding of the PD published by a port
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr              Port number (0 - 3)
+//!  \param[out]   format               encoding and raw/decoded values
+//!
+//!  \return       SUCCESS or ERROR on an invalid port
+//!
+//!*********************************************************
+
+uint8_t ShieldCommunication::get_PayloadFormat(uint8_t port_nr, PayloadFormat &format)
+{
+    lock_guard<mutex> lock(payloadFormatsMutex);
+    if (port_nr >= payloadFormats.size())
+    {
+        return ERROR;
+    }
+    format = payloadFormats.at(port_nr);
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    Event_dispatch
+//!*******************************************************************************
+//!  \brief        Function to push the events of all ports to MQTT
+//!                (Shield/Port<n>/event) and to the clients of the /events
+//!                websocket. Only consumer of the event queues of the ports.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::Event_dispatch()
+{
+    string TOPIC_ORIGINATOR_ID = "Shield";
+    string TOPIC_PORT = "Port";
+    string TOPIC_DATA_SELECTOR_EVENT = "event";
+    IOLEvent event;
+    while (1)
+    {
+        for (uint8_t port_nr = 0; port_nr < ports.size(); port_nr++)
+        {
+            // the queues are lock-free, no driver mutex needed
+            while (ports.at(port_nr).popEvent(event))
+            {
+                nlohmann::json jsonobject = eventToJson(port_nr, event);
+                string jsonstring = jsonobject.dump();
+                std::string topic_str = fmt::format("{}/{}{}/{}", TOPIC_ORIGINATOR_ID, TOPIC_PORT, std::to_string(port_nr), TOPIC_DATA_SELECTOR_EVENT);
+                int qos = 1; // events must not get lost, the network loop handles the PUBACKs
+                int retVal = mosquitto_publish(mosq, NULL, topic_str.c_str(), jsonstring.size(), jsonstring.c_str(), qos, false);
+                if (retVal != MOSQ_ERR_SUCCESS)
+                {
+                    cout << "Event of port " << int(port_nr) << " not published: " << mosquitto_strerror(retVal) << endl;
+                }
+
+                lock_guard<mutex> lock(eventClientsMutex);
+                for (auto client : eventClients)
+                {
+                    client->send_text(jsonstring);
+                }
+            }
+        }
+        hardware.wait_for(10);
+    }
+    return;
+}
+
+//!*******************************************************************************
+//!  function :    eventToJson
+//!*******************************************************************************
+//!  \brief        Converts an event into the JSON format for MQTT and websocket
+//!
+//!  \type         local
+//!
+//!  \param[in]    port_nr             port the event belongs to
+//!  \param[in]    event               event read out of the device
+//!
+//!  \return       json object
+//!
+//!*********************************************************
+
+nlohmann::json ShieldCommunication::eventToJson(uint8_t port_nr, const IOLEvent &event)
+{
+    nlohmann::json jsonobject;
+    jsonobject["Port"] = port_nr;
+    jsonobject["Code"] = event.code;
+    jsonobject["Qualifier"] = event.qualifier;
+    switch (event.qualifier & IOL::EVENT::MODE_MASK)
+    {
+    case IOL::EVENT::MODE_SINGLE_SHOT:
+        jsonobject["Mode"] = "SingleShot";
+        break;
+    case IOL::EVENT::MODE_DISAPPEARS:
+        jsonobject["Mode"] = "Disappears";
+        break;
+    case IOL::EVENT::MODE_APPEARS:
+        jsonobject["Mode"] = "Appears";
+        break;
+    default:
+        jsonobject["Mode"] = "Unknown";
+        break;
+    }
+    switch (event.qualifier & IOL::EVENT::TYPE_MASK)
+    {
+    case IOL::EVENT::TYPE_NOTIFICATION:
+        jsonobject["Type"] = "Notification";
+        break;
+    case IOL::EVENT::TYPE_WARNING:
+        jsonobject["Type"] = "Warning";
+        break;
+    case IOL::EVENT::TYPE_ERROR:
+        jsonobject["Type"] = "Error";
+        break;
+    default:
+        jsonobject["Type"] = "Unknown";
+        break;
+    }
+    jsonobject["Source"] = (event.qualifier & IOL::EVENT::SOURCE_MASTER) ? "Master" : "Device";
+    jsonobject["Instance"] = event.qualifier & IOL::EVENT::INSTANCE_MASK;
+    jsonobject["ts"] = getTimeStamp(chrono::system_clock::time_point(chrono::duration_cast<chrono::system_clock::duration>(chrono::nanoseconds(event.timestamp))));
+    return jsonobject;
+}
+
+//!*******************************************************************************
+//!  function :    addEventClient
+//!*******************************************************************************
+//!  \brief        Registers a websocket connection for the event push
+//!
+//!  \type         local
+//!
+//!  \param[in]    *client             websocket connection
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::addEventClient(crow::websocket::connection *client)
+{
+    lock_guard<mutex> lock(eventClientsMutex);
+    eventClients.insert(client);
+}
+
+//!*******************************************************************************
+//!  function :    removeEventClient
+//!*******************************************************************************
+//!  \brief        Removes a closed websocket connection from the event push
+//!
+//!  \type         local
+//!
+//!  \param[in]    *client             websocket connection
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::removeEventClient(crow::websocket::connection *client)
+{
+    lock_guard<mutex> lock(eventClientsMutex);
+    eventClients.erase(client);
+}
+
+//!*******************************************************************************
+//!  function :    isDeviceConnected
+//!*******************************************************************************
+//!  \brief        check on all ports if a device is connected (triggered by CROW)
+//!
+//!  \type         local
+//!
+//!  \param[in]    vector<uint8_t>& portConnection
+//!
+//!  \return       void
+//!
+//!*********************************************************
+
+void ShieldCommunication::isDeviceConnected(vector<uint8_t> &portConnection)
+{
+    int portNummer = 0;
+    for (auto &nr : ports)
+    {
+        if (claimPort(uint8_t(portNummer))) // otherwise Port_startup works on the port, report its state
+        {
+            bool wasConnected = (nr.get_DeviceConnection() == 0);
+            nr.isDeviceConnected();
+            if (!wasConnected && (nr.get_DeviceConnection() == 0))
+            {
+                dataStoragePending[portNummer].store(true, memory_order_release); // device (re)connected, Port_startup synchronizes
+            }
+            releasePort(uint8_t(portNummer));
+        }
+
+        if (nr.get_DeviceConnection() == 0)
+            portConnection.push_back(0);
+        else
+            portConnection.push_back(1);
+
         if (portNummer >= 3)
             portNummer = 0;
         else
@@ -739,7 +1864,11 @@ void ShieldCommunication::writeIP(string newIP)
 std::string ShieldCommunication::getCurrentTimeStamp()
 {
     // aktuelle Zeit holen
-    auto now = std::chrono::system_clock::now();
+    return getTimeStamp(std::chrono::system_clock::now());
+}
+
+std::string ShieldCommunication::getTimeStamp(std::chrono::system_clock::time_point now)
+{
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
     auto timer = std::chrono::system_clock::to_time_t(now);
 
@@ -750,6 +1879,40 @@ std::string ShieldCommunication::getCurrentTimeStamp()
     return ss.str();
 }
 
+//!*******************************************************************************
+//!  function :    hexToBytes
+//!*******************************************************************************
+//!  \brief        Converts a hex string of the REST API ("0a1b", an odd length
+//!                gets a leading 0) into bytes
+//!
+//!  \type         local
+//!
+//!  \param[in]    str                  hex string
+//!  \param[out]   data                 bytes
+//!
+//!  \return       false if a character isn't a hex digit
+//!
+//!*********************************************************
+
+static bool hexToBytes(string str, vector<uint8_t> &data)
+{
+    if ((str.length() % 2) != 0)
+        str = "0" + str; //length correction
+    data.clear();
+    for (size_t i = 0; i < str.size(); i = i + 2)
+    {
+        uint8_t value = 0;
+        const char *last = str.data() + i + 2;
+        auto result = std::from_chars(str.data() + i, last, value, 16);
+        if ((result.ec != std::errc()) || (result.ptr != last))
+        {
+            return false;
+        }
+        data.push_back(value);
+    }
+    return true;
+}
+
 int main()
 {
 
@@ -758,9 +1921,26 @@ int main()
     ShieldCommunication shield(true); // create object of shield
 
     // Threads
-    // Start the PD thread (read/writes PD cyclic)
-    thread PD_all_portsThread(&ShieldCommunication::PD_all_ports, &shield);
-    PD_all_portsThread.detach();
+    // Start one PD thread per MAX14819 (read/writes PD cyclic), the chips run concurrently
+    for (size_t chip = 0; chip < shield.chipCount(); chip++)
+    {
+        thread PD_chip_portsThread(&ShieldCommunication::PD_chip_ports, &shield, uint8_t(chip));
+        PD_chip_portsThread.detach();
+    }
+    // Start the startup thread (full startup and Data Storage of reconnected devices)
+    thread Port_startupThread(&ShieldCommunication::Port_startup, &shield);
+    Port_startupThread.detach();
+    // Start the decode and publish stages of the PD pipeline
+    thread PD_decodeThread(&ShieldCommunication::PD_decode, &shield);
+    PD_decodeThread.detach();
+    thread PD_publishThread(&ShieldCommunication::PD_publish, &shield);
+    PD_publishThread.detach();
+    // Start the SIO thread (samples the lines of ports in SIO mode)
+    thread SIO_pollThread(&ShieldCommunication::SIO_poll, &shield);
+    SIO_pollThread.detach();
+    // Start the event thread (pushes the device events to MQTT and websocket)
+    thread Event_dispatchThread(&ShieldCommunication::Event_dispatch, &shield);
+    Event_dispatchThread.detach();
 
     // CROW
     //===================================================================================================================================
@@ -795,7 +1975,24 @@ int main()
                 }
                 //end of conversion
 
-                shield.Write_procDataOut(uint8_t(x["Port"].i()), pData); //calling method to actually write
+                uint8_t port_nr = uint8_t(x["Port"].i());
+                uint64_t sequence = shield.Write_procDataOut(port_nr, pData); //calling method to actually write
+
+                if (x.has("Wait")) // optional: wait (ms) until the data is on the wire and acknowledge it
+                {
+                    PDOutAck ack;
+                    uint8_t retVal = shield.waitProcDataOut(port_nr, sequence, uint32_t(x["Wait"].u()), ack);
+                    crow::json::wvalue returnObject;
+                    returnObject["Port"] = port_nr;
+                    returnObject["Sequence"] = sequence;
+                    returnObject["Applied"] = (retVal == SUCCESS);
+                    returnObject["WireTimestamp"] = ack.wireTimestamp;
+                    if ((retVal == SUCCESS) && (ack.sequence == sequence))
+                    {
+                        returnObject["Latency"] = (ack.wireTimestamp - ack.requestTimestamp) / 1000u; // us
+                    }
+                    return crow::response{ returnObject };
+                }
 
                 std::ostringstream os;
 
@@ -803,6 +2000,47 @@ int main()
 
                 return crow::response{ os.str() }; });
 
+    CROW_ROUTE(app, "/writeProcessDataValues/<uint>") // send the PD out fields of the Port as JSON object {Key: value} or as CBOR/MessagePack (Content-Type application/cbor, application/msgpack) map {field id or Key: value}, optional ?Wait=ms
+        .methods("POST"_method)([&shield](const crow::request &req, unsigned int port)
+                                {
+                PayloadEncoding encoding = PayloadEncoding::Json;
+                const string contentType = req.get_header_value("Content-Type");
+                if (contentType == "application/cbor")
+                {
+                    encoding = PayloadEncoding::Cbor;
+                }
+                else if ((contentType == "application/msgpack") || (contentType == "application/x-msgpack"))
+                {
+                    encoding = PayloadEncoding::MsgPack;
+                }
+
+                uint8_t port_nr = uint8_t(port);
+                uint64_t sequence = 0;
+                string error;
+                if ((port > 255u) || (shield.Write_procDataOutValues(port_nr, encoding, req.body, sequence, error) != SUCCESS))
+                {
+                    return crow::response(400, error);
+                }
+
+                nlohmann::json result;
+                result["Port"] = port_nr;
+                result["Sequence"] = sequence;
+                const char *wait = req.url_params.get("Wait");
+                if (wait != nullptr) // wait (ms) until the data is on the wire and acknowledge it
+                {
+                    PDOutAck ack;
+                    uint8_t retVal = shield.waitProcDataOut(port_nr, sequence, uint32_t(strtoul(wait, nullptr, 10)), ack);
+                    result["Applied"] = (retVal == SUCCESS);
+                    result["WireTimestamp"] = ack.wireTimestamp;
+                    if ((retVal == SUCCESS) && (ack.sequence == sequence))
+                    {
+                        result["Latency"] = (ack.wireTimestamp - ack.requestTimestamp) / 1000u; // us
+                    }
+                }
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
     //===================================================================================================================================
     CROW_ROUTE(app, "/writeCycleTime") // add a delay in reading & writing ProcessData
         .methods("POST"_method)([&shield](const crow::request &req)
@@ -908,6 +2146,65 @@ int main()
 
                 return crow::response{ os.str() }; });
 
+    //===================================================================================================================================
+    CROW_ROUTE(app, "/isdubatch") // send a Port and a list of Requests (Index, Subindex, optional Data to write) to execute them back-to-back
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port") || !x.has("Requests") || (x["Port"].t() != crow::json::type::Number) || (x["Requests"].t() != crow::json::type::List)) return crow::response(400);
+
+                uint8_t port_nr = uint8_t(x["Port"].i());
+                vector<IsduRequest> requests;
+
+                for (auto &item : x["Requests"])
+                {
+                    if (!item.has("Index") || (item["Index"].t() != crow::json::type::Number)) return crow::response(400);
+                    if (item.has("Subindex") && (item["Subindex"].t() != crow::json::type::Number)) return crow::response(400);
+                    if (item.has("Data") && (item["Data"].t() != crow::json::type::String)) return crow::response(400);
+                    IsduRequest request;
+                    request.index = uint16_t(item["Index"].i());
+                    request.subIndex = item.has("Subindex") ? uint8_t(item["Subindex"].i()) : 0;
+                    request.write = item.has("Data");
+                    request.status = ERROR;
+                    request.errorCode = 0;
+                    if (request.write && !hexToBytes(string(item["Data"]), request.data))
+                    {
+                        return crow::response(400);
+                    }
+                    requests.push_back(request);
+                }
+
+                shield.ISDU_Batch(port_nr, requests); //no extra thread, the whole batch runs in the request handler
+
+                crow::json::wvalue returnObject;
+                returnObject["Port"] = x["Port"];
+                vector<crow::json::wvalue> results;
+                for (auto &request : requests)
+                {
+                    crow::json::wvalue result;
+                    result["Index"] = request.index;
+                    result["Subindex"] = request.subIndex;
+                    result["Status"] = (request.status == SUCCESS) ? "OK" : "ERROR";
+                    if (request.status != SUCCESS)
+                    {
+                        result["ErrorCode"] = request.errorCode;
+                    }
+                    if (!request.write)
+                    {
+                        std::ostringstream os;
+                        for (int i = 0; i < request.data.size(); i++)
+                        {
+                            os << hex << int(request.data.at(i)) << " ";
+                        }
+                        result["Data"] = os.str();
+                    }
+                    results.push_back(std::move(result));
+                }
+                returnObject["Results"] = std::move(results);
+                return crow::response{ returnObject }; });
+
     //===================================================================================================================================
 
     CROW_ROUTE(app, "/checkDevices") // please use GET-methods
@@ -982,6 +2279,214 @@ int main()
 
                 return crow::response{ os.str() }; });
 
+    CROW_ROUTE(app, "/portmode") // send Port, Mode (IOLINK, SIO_IN, SIO_OUT, INACTIVE) and optional Debounce in us
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port") || !x.has("Mode")) return crow::response(400);
+
+                string mode = string(x["Mode"]);
+                uint16_t portMode;
+                if (mode == "IOLINK")
+                    portMode = IOL::PORT_MODE::IOLINK;
+                else if (mode == "SIO_IN")
+                    portMode = IOL::PORT_MODE::SIO_INPUT;
+                else if (mode == "SIO_OUT")
+                    portMode = IOL::PORT_MODE::SIO_OUTPUT;
+                else if (mode == "INACTIVE")
+                    portMode = IOL::PORT_MODE::INACTIVE;
+                else
+                    return crow::response(400);
+                uint32_t debounce = x.has("Debounce") ? uint32_t(x["Debounce"].u()) : 0;
+
+                if (shield.setPortMode(uint8_t(x["Port"].i()), portMode, debounce) != SUCCESS)
+                    return crow::response(500);
+
+                std::ostringstream os;
+
+                os << "Port mode was written successfully!";
+
+                return crow::response{ os.str() }; });
+
+    CROW_ROUTE(app, "/writeCQ") // send Port and Level (0/1) to drive the CQ line of a port in SIO output mode
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port") || !x.has("Level")) return crow::response(400);
+
+                if (shield.writeCQ(uint8_t(x["Port"].i()), uint8_t(x["Level"].i())) != SUCCESS)
+                    return crow::response(409);
+
+                std::ostringstream os;
+
+                os << "Done!";
+
+                return crow::response{ os.str() }; });
+
+    CROW_ROUTE(app, "/pdhistory") // send Port and either Sequence (first sequence number) or From/To (ns since epoch) or Last (ms), optional Step, Max and Decode (bool)
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port")) return crow::response(400);
+
+                bool bySequence = x.has("Sequence");
+                uint64_t from = 0;
+                uint64_t to = UINT64_MAX;
+                if (bySequence)
+                {
+                    from = uint64_t(x["Sequence"].u());
+                }
+                else if (x.has("Last"))
+                {
+                    uint64_t now = pdTimestamp();
+                    uint64_t last = uint64_t(x["Last"].u());
+                    uint64_t span = (last < now / 1000000u) ? last * 1000000u : now; // clamped, no underflow and no overflow
+                    from = now - span;
+                }
+                else
+                {
+                    if (x.has("From")) from = uint64_t(x["From"].u());
+                    if (x.has("To")) to = uint64_t(x["To"].u());
+                }
+                size_t step = x.has("Step") ? size_t(x["Step"].u()) : 1;
+                size_t maxCount = x.has("Max") ? size_t(x["Max"].u()) : PD_HISTORY_DEPTH;
+                bool decode = x.has("Decode") && x["Decode"].b();
+
+                nlohmann::json result;
+                if (shield.PD_history(uint8_t(x["Port"].i()), bySequence, from, to, step, maxCount, decode, result) != SUCCESS)
+                {
+                    return crow::response(400);
+                }
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
+    CROW_ROUTE(app, "/publishfilter") // send Port and optional ChangeDriven (bool), Heartbeat (ms, 0 = off) and Deadbands [{Key, Absolute, Percent}], returns the filter settings
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port")) return crow::response(400);
+
+                PublishFilter *filter = shield.get_PublishFilter(uint8_t(x["Port"].i()));
+                if (filter == nullptr) return crow::response(400);
+
+                // validate the whole body first, a rejected request changes nothing
+                auto isBool = [](const crow::json::rvalue &value)
+                { return (value.t() == crow::json::type::True) || (value.t() == crow::json::type::False); };
+                if (x.has("ChangeDriven") && !isBool(x["ChangeDriven"])) return crow::response(400);
+                if (x.has("Heartbeat") && (x["Heartbeat"].t() != crow::json::type::Number)) return crow::response(400);
+                if (x.has("Deadbands"))
+                {
+                    if (x["Deadbands"].t() != crow::json::type::List) return crow::response(400);
+                    for (auto &item : x["Deadbands"])
+                    {
+                        if (!item.has("Key") || (item["Key"].t() != crow::json::type::String)) return crow::response(400);
+                        if (item.has("Absolute") && (item["Absolute"].t() != crow::json::type::Number)) return crow::response(400);
+                        if (item.has("Percent") && (item["Percent"].t() != crow::json::type::Number)) return crow::response(400);
+                    }
+                }
+
+                if (x.has("ChangeDriven")) filter->setChangeDriven(x["ChangeDriven"].b());
+                if (x.has("Heartbeat")) filter->setHeartbeat(uint32_t(x["Heartbeat"].u()));
+                if (x.has("Deadbands"))
+                {
+                    filter->clearDeadbands();
+                    for (auto &item : x["Deadbands"])
+                    {
+                        double absolute = item.has("Absolute") ? item["Absolute"].d() : 0.0;
+                        double percent = item.has("Percent") ? item["Percent"].d() : 0.0;
+                        filter->setDeadband(string(item["Key"]), absolute, percent);
+                    }
+                }
+                filter->reset(); // publish the next cycle with the new settings
+
+                nlohmann::json result = filter->getConfig();
+                result["Port"] = x["Port"].i();
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
+    CROW_ROUTE(app, "/payloadformat") // send Port and optional Encoding ("json", "cbor", "msgpack") and Raw (bool, PD bytes instead of values), returns the settings
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port")) return crow::response(400);
+
+                uint8_t port_nr = uint8_t(x["Port"].i());
+                PayloadFormat format;
+                if (shield.get_PayloadFormat(port_nr, format) != SUCCESS) return crow::response(400);
+                if (x.has("Encoding") && !payloadEncodingFromString(string(x["Encoding"]), format.encoding)) return crow::response(400);
+                if (x.has("Raw")) format.raw = x["Raw"].b();
+                shield.set_PayloadFormat(port_nr, format);
+                shield.get_PublishFilter(port_nr)->reset(); // publish the next cycle in the new format
+
+                nlohmann::json result;
+                result["Port"] = x["Port"].i();
+                result["Encoding"] = payloadEncodingName(format.encoding);
+                result["Raw"] = format.raw;
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
+    CROW_ROUTE(app, "/pdoutstatus") // send Port and optional Reset (bool) to clear the latency histogram
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+                auto x = crow::json::load(req.body);
+
+                if (!x || !x.has("Port")) return crow::response(400);
+
+                nlohmann::json result;
+                bool reset = x.has("Reset") && x["Reset"].b();
+                if (shield.PD_out_status(uint8_t(x["Port"].i()), reset, result) != SUCCESS)
+                {
+                    return crow::response(400);
+                }
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
+    CROW_ROUTE(app, "/pipeline") // send optional Reset (bool) to clear the counters, returns the counters of the PD pipeline stages
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+                auto x = crow::json::load(req.body);
+
+                bool reset = x && x.has("Reset") && x["Reset"].b();
+                nlohmann::json result;
+                shield.PD_pipeline_status(reset, result);
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
+    CROW_ROUTE(app, "/cycle") // send optional Policy ("skip", "catchup") and Reset (bool), returns the timing statistics of the PD cycle
+        .methods("POST"_method)([&shield](const crow::request &req)
+                                {
+                auto x = crow::json::load(req.body);
+
+                string policy = (x && x.has("Policy")) ? string(x["Policy"].s()) : string();
+                bool reset = x && x.has("Reset") && x["Reset"].b();
+                nlohmann::json result;
+                if (shield.PD_cycle_status(policy, reset, result) != SUCCESS)
+                {
+                    return crow::response(400);
+                }
+                crow::response response{ result.dump() };
+                response.add_header("Content-Type", "application/json");
+                return response; });
+
+    CROW_ROUTE(app, "/events") // websocket, every device event is pushed as JSON text message
+        .websocket()
+        .onopen([&shield](crow::websocket::connection &conn)
+                { shield.addEventClient(&conn); })
+        .onclose([&shield](crow::websocket::connection &conn, const std::string &)
+                 { shield.removeEventClient(&conn); });
+
     //======End API======
 
     app.port(18080).multithreaded().run();
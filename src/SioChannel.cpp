@@ -0,0 +1,358 @@
+/*!
+ * @file SioChannel.cpp
+ * @brief Sampling of a switching signal (CQ or DI line in SIO mode) with
+ *        timestamped edge capture, debounce and pulse counting.
+ * @copyright 2022 Balluff GmbH
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *	    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	 Unless required by applicable law or agreed to in writing, software
+ *	 distributed under the License is distributed on an "AS IS" BASIS,
+ *	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	 See the License for the specific language governing permissions and
+ *	 limitations under the License.
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+//!***** Header-Files ************************************************************
+#include "SioChannel.h"
+#include <chrono>
+
+//!***** Implementation **********************************************************
+
+//!*******************************************************************************
+//!  function :    SioChannel
+//!*******************************************************************************
+//!  \brief        Constructor for SioChannel, no debounce by default
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+SioChannel::SioChannel()
+    : level_(0),
+      pulseCount_(0),
+      overruns_(0),
+      debounce_(0),
+      enabled_(false),
+      primed_(false),
+      lastEdge_(0)
+{
+}
+
+//!*******************************************************************************
+//!  function :    SioChannel
+//!*******************************************************************************
+//!  \brief        Copy constructor, only allowed while the channel isn't sampled
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                channel to copy
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+SioChannel::SioChannel(const SioChannel &other)
+    : edges_(other.edges_),
+      level_(other.level_.load()),
+      pulseCount_(other.pulseCount_.load()),
+      overruns_(other.overruns_.load()),
+      debounce_(other.debounce_.load()),
+      enabled_(other.enabled_.load()),
+      primed_(other.primed_.load()),
+      lastEdge_(other.lastEdge_)
+{
+}
+
+//!*******************************************************************************
+//!  function :    operator=
+//!*******************************************************************************
+//!  \brief        Copy assignment, only allowed while the channel isn't sampled
+//!
+//!  \type         local
+//!
+//!  \param[in]    other                channel to copy
+//!
+//!  \return       reference to this channel
+//!
+//!*******************************************************************************
+SioChannel &SioChannel::operator=(const SioChannel &other)
+{
+    if (this != &other)
+    {
+        edges_ = other.edges_;
+        level_ = other.level_.load();
+        pulseCount_ = other.pulseCount_.load();
+        overruns_ = other.overruns_.load();
+        debounce_ = other.debounce_.load();
+        enabled_ = other.enabled_.load();
+        primed_ = other.primed_.load();
+        lastEdge_ = other.lastEdge_;
+    }
+    return *this;
+}
+
+//!*******************************************************************************
+//!  function :    ~SioChannel
+//!*******************************************************************************
+//!  \brief        Destructor for SioChannel
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+SioChannel::~SioChannel()
+{
+}
+
+//!*******************************************************************************
+//!  function :    now
+//!*******************************************************************************
+//!  \brief        Timestamp for a sample in ns since epoch
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       timestamp
+//!
+//!*******************************************************************************
+uint64_t SioChannel::now()
+{
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count());
+}
+
+//!*******************************************************************************
+//!  function :    enable
+//!*******************************************************************************
+//!  \brief        Starts the sampling. The first sample only sets the start
+//!                level, no edge is reported for it.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void SioChannel::enable()
+{
+    primed_.store(false, memory_order_relaxed);
+    enabled_.store(true, memory_order_release);
+}
+
+//!*******************************************************************************
+//!  function :    disable
+//!*******************************************************************************
+//!  \brief        Stops the sampling, captured edges stay in the ring
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void SioChannel::disable()
+{
+    enabled_.store(false, memory_order_release);
+}
+
+//!*******************************************************************************
+//!  function :    isEnabled
+//!*******************************************************************************
+//!  \brief        Returns if the channel is sampled
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       true if enabled
+//!
+//!*******************************************************************************
+bool SioChannel::isEnabled() const
+{
+    return enabled_.load(memory_order_acquire);
+}
+
+//!*******************************************************************************
+//!  function :    sample
+//!*******************************************************************************
+//!  \brief        Feeds a sample of the line (producer side, IRQ handler or
+//!                polling thread). A level change is accepted as edge if the
+//!                last accepted edge is older than the debounce time, shorter
+//!                changes are treated as bouncing and ignored.
+//!
+//!  \type         local
+//!
+//!  \param[in]    level                sampled level
+//!  \param[in]    timestamp            time of the sample in ns since epoch
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void SioChannel::sample(uint8_t level, uint64_t timestamp)
+{
+    level = level ? 1 : 0;
+    if (!enabled_.load(memory_order_acquire))
+    {
+        return;
+    }
+    if (!primed_.load(memory_order_relaxed))
+    {
+        level_.store(level, memory_order_relaxed);
+        lastEdge_ = 0;
+        primed_.store(true, memory_order_relaxed);
+        return;
+    }
+    if (level == level_.load(memory_order_relaxed))
+    {
+        return;
+    }
+    if ((lastEdge_ != 0) && ((timestamp - lastEdge_) < debounce_.load(memory_order_relaxed)))
+    {
+        return; // bouncing
+    }
+    lastEdge_ = timestamp;
+    level_.store(level, memory_order_relaxed);
+    if (level)
+    {
+        pulseCount_.fetch_add(1, memory_order_relaxed);
+    }
+    SioEdge edge;
+    edge.timestamp = timestamp;
+    edge.level = level;
+    if (!edges_.push(edge))
+    {
+        overruns_.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+//!*******************************************************************************
+//!  function :    popEdge
+//!*******************************************************************************
+//!  \brief        Takes the oldest captured edge (consumer side)
+//!
+//!  \type         local
+//!
+//!  \param[out]   &edge                oldest edge
+//!
+//!  \return       true if an edge was available
+//!
+//!*******************************************************************************
+bool SioChannel::popEdge(SioEdge &edge)
+{
+    return edges_.pop(edge);
+}
+
+//!*******************************************************************************
+//!  function :    getLevel
+//!*******************************************************************************
+//!  \brief        Returns the debounced level
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       0 or 1
+//!
+//!*******************************************************************************
+uint8_t SioChannel::getLevel() const
+{
+    return level_.load(memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    getPulseCount
+//!*******************************************************************************
+//!  \brief        Returns the number of rising edges since the last reset
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       pulse count
+//!
+//!*******************************************************************************
+uint32_t SioChannel::getPulseCount() const
+{
+    return pulseCount_.load(memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    resetPulseCount
+//!*******************************************************************************
+//!  \brief        Sets the pulse counter back to 0
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void SioChannel::resetPulseCount()
+{
+    pulseCount_.store(0, memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    getOverruns
+//!*******************************************************************************
+//!  \brief        Returns the number of edges lost because the ring was full
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       number of lost edges
+//!
+//!*******************************************************************************
+uint32_t SioChannel::getOverruns() const
+{
+    return overruns_.load(memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    setDebounce
+//!*******************************************************************************
+//!  \brief        Sets the debounce time, 0 disables the debounce
+//!
+//!  \type         local
+//!
+//!  \param[in]    debounce_us          debounce time in us
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void SioChannel::setDebounce(uint32_t debounce_us)
+{
+    debounce_.store(uint64_t(debounce_us) * 1000u, memory_order_relaxed);
+}
+
+//!*******************************************************************************
+//!  function :    getDebounce
+//!*******************************************************************************
+//!  \brief        Returns the debounce time
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       debounce time in us
+//!
+//!*******************************************************************************
+uint32_t SioChannel::getDebounce() const
+{
+    return uint32_t(debounce_.load(memory_order_relaxed) / 1000u);
+}
@@ -0,0 +1,383 @@
+#include "IoddLoader.h"
+#include "IoddService.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+/*!
+ * @file IoddCodegen.cpp
+ * @brief Build-time generator for process data decoders. Compiles the
+ *        builtin layouts and IODD files into a header with constexpr element
+ *        tables and one decode/encode function per device, every field is
+ *        extracted with fixed shifts and masks.
+ *
+ *        iodd_codegen [--builtin] -o IoddGenerated.h [IODD.xml ...]
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+namespace
+{
+
+std::string quoted(const std::string &text)
+{
+    std::string result = "\"";
+    for (char c : text)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+std::string hex(uint64_t value)
+{
+    std::ostringstream text;
+    text << "0x" << std::hex << std::uppercase << value << "ull";
+    return text.str();
+}
+
+/** \brief Expression for byte n (counted from the right) of the process data. */
+std::string byteFromRight(uint32_t n)
+{
+    return "end[-" + std::to_string(n + 1u) + "]";
+}
+
+/** \brief Expression for the bytes first..last (from the right) as one integer. */
+std::string bytesFromRight(uint32_t first, uint32_t last)
+{
+    std::string expression;
+    for (uint32_t n = last + 1u; n-- > first;)
+    {
+        if (!expression.empty())
+        {
+            expression += " | ";
+        }
+        const uint32_t shift = 8u * (n - first);
+        expression += "(uint64_t(" + byteFromRight(n) + ")" + (shift ? " << " + std::to_string(shift) + "u" : "") + ")";
+    }
+    return expression;
+}
+
+/** \brief Bit read for a BooleanT (from the right), the MSB of its bit range. */
+uint32_t booleanBit(const PlanElement &element)
+{
+    return uint32_t(element.bitOffset) + element.bitLength - 1u;
+}
+
+/** \brief Same conditions as the extractors of IoddService, Invalid otherwise. */
+bool isValid(const PlanElement &element)
+{
+    switch (element.type)
+    {
+    case IolType::BooleanT:
+        return element.bitLength != 0u;
+    case IolType::UIntegerT:
+    case IolType::IntegerT:
+        return (element.bitLength >= 2u) && (element.bitLength <= 64u);
+    case IolType::Float32T:
+        return element.bitLength == 32u;
+    case IolType::TimeT:
+    case IolType::TimeSpanT:
+        return element.bitLength == 64u;
+    case IolType::StringT:
+    case IolType::OctetStringT:
+        return (element.bitLength != 0u) && !(element.bitOffset & 7u) && !(element.bitLength & 7u);
+    default:
+        return false;
+    }
+}
+
+bool isOctets(const PlanElement &element)
+{
+    return (element.type == IolType::StringT) || (element.type == IolType::OctetStringT);
+}
+
+/** \brief Number of bytes needed by all valid elements. */
+uint32_t minimumLength(const DecodePlan &plan)
+{
+    uint32_t bits = 0;
+    for (const PlanElement &element : plan.elements)
+    {
+        if (isValid(element))
+        {
+            bits = std::max<uint32_t>(bits, uint32_t(element.bitOffset) + element.bitLength);
+        }
+    }
+    return (bits + 7u) / 8u;
+}
+
+uint64_t fieldMask(const PlanElement &element)
+{
+    return (element.bitLength == 64u) ? ~0ull : ((1ull << element.bitLength) - 1u);
+}
+
+/** \brief Expression for the bits of a field of up to 64 bits as uint64_t. */
+std::string fieldBits(const PlanElement &element)
+{
+    const uint32_t shift = element.bitOffset & 7u;
+    const uint32_t first = element.bitOffset / 8u;
+    const uint32_t last = (uint32_t(element.bitOffset) + element.bitLength - 1u) / 8u;
+    if (last - first < 8u)
+    {
+        return "(((" + bytesFromRight(first, last) + ") >> " + std::to_string(shift) + "u) & " + hex(fieldMask(element)) + ")";
+    }
+    // 64 bits spread over 9 bytes
+    return "((((" + bytesFromRight(first, last - 1u) + ") >> " + std::to_string(shift) + "u) | (uint64_t(" + byteFromRight(last) + ") << " +
+           std::to_string(64u - shift) + "u)) & " + hex(fieldMask(element)) + ")";
+}
+
+void writeDecoder(std::ostream &out, const DecodePlan &plan)
+{
+    out << "inline bool decode(const uint8_t *data, std::size_t dataLength, IolValue *values)\n{\n";
+    out << "    if (dataLength < MIN_LENGTH)\n    {\n        return false;\n    }\n";
+    out << "    const uint8_t *const end = data + dataLength;\n";
+    for (std::size_t i = 0; i < plan.elements.size(); i++)
+    {
+        const PlanElement &element = plan.elements[i];
+        const std::string value = "    values[" + std::to_string(i) + "] = ";
+        const std::string length = std::to_string(element.bitLength) + "u";
+        if (!isValid(element))
+        {
+            out << value << "IolValue();\n";
+            continue;
+        }
+        switch (element.type)
+        {
+        case IolType::BooleanT:
+        {
+            const uint32_t bit = booleanBit(element);
+            out << value << "makeBoolean((" << byteFromRight(bit / 8u) << " >> " << (bit & 7u) << "u) & 1u);\n";
+            break;
+        }
+        case IolType::UIntegerT:
+            out << value << "makeUInteger(" << fieldBits(element) << ");\n";
+            break;
+        case IolType::IntegerT:
+            out << value << "makeInteger(" << fieldBits(element) << ", " << length << ");\n";
+            break;
+        case IolType::Float32T:
+            out << value << "makeFloat32(uint32_t" << fieldBits(element) << ");\n";
+            break;
+        case IolType::TimeT:
+            out << value << "makeTime(" << fieldBits(element) << ");\n";
+            break;
+        case IolType::TimeSpanT:
+            out << value << "makeTimeSpan(" << fieldBits(element) << ");\n";
+            break;
+        case IolType::StringT:
+        case IolType::OctetStringT:
+            out << value << (element.type == IolType::StringT ? "makeString" : "makeOctetString") << "(end - "
+                << (uint32_t(element.bitOffset) + element.bitLength) / 8u << "u, " << element.bitLength / 8u << "u);\n";
+            break;
+        default:
+            break;
+        }
+    }
+    out << "    return true;\n}\n";
+}
+
+/** \brief Expression for the bits an encoded value of values[index] has in the PD. */
+std::string encodedBits(const PlanElement &element, const std::string &index)
+{
+    const std::string value = "values[" + index + "]";
+    switch (element.type)
+    {
+    case IolType::UIntegerT:
+        return value + ".uinteger";
+    case IolType::IntegerT:
+        return "uint64_t(" + value + ".integer)";
+    case IolType::Float32T:
+        return "uint64_t(float32Bits(" + value + ".float32))";
+    case IolType::TimeT:
+        return "nsToIolTime(" + value + ".integer)";
+    case IolType::TimeSpanT:
+        return "nsToIolTimeSpan(" + value + ".integer)";
+    default:
+        return "0u";
+    }
+}
+
+void writeEncoder(std::ostream &out, const DecodePlan &plan)
+{
+    out << "inline bool encode(const IolValue *values, uint8_t *data, std::size_t dataLength)\n{\n";
+    out << "    if (dataLength < MIN_LENGTH)\n    {\n        return false;\n    }\n";
+    out << "    uint8_t *const end = data + dataLength;\n";
+    for (std::size_t i = 0; i < plan.elements.size(); i++)
+    {
+        const PlanElement &element = plan.elements[i];
+        const std::string index = std::to_string(i);
+        const uint32_t shift = element.bitOffset & 7u;
+        const uint32_t first = element.bitOffset / 8u;
+        if (!isValid(element))
+        {
+            continue;
+        }
+        out << "    if (values[" << index << "].type == IolType::" << iolTypeName(element.type) << ")\n    {\n";
+        if (element.type == IolType::BooleanT)
+        {
+            const uint32_t bit = booleanBit(element);
+            const std::string target = byteFromRight(bit / 8u);
+            const unsigned mask = 1u << (bit & 7u);
+            out << "        " << target << " = uint8_t((" << target << " & ~" << mask << "u) | (values[" << index << "].boolean ? " << mask << "u : 0u));\n";
+        }
+        else if (isOctets(element))
+        {
+            out << "        copyOctets(end - " << (uint32_t(element.bitOffset) + element.bitLength) / 8u << "u, " << element.bitLength / 8u << "u, values[" << index << "]);\n";
+        }
+        else
+        {
+            const uint32_t last = (uint32_t(element.bitOffset) + element.bitLength - 1u) / 8u;
+            const uint64_t mask = fieldMask(element);
+            out << "        const uint64_t value = " << encodedBits(element, index) << " & " << hex(mask) << ";\n";
+            for (uint32_t n = first; n <= last; n++)
+            {
+                // part of the field in this byte
+                const uint32_t fieldShift = 8u * (n - first);
+                const unsigned byteMask = unsigned(((n == first) ? (mask << shift) : (mask >> (fieldShift - shift))) & 0xFFu);
+                std::string part;
+                if (n == first)
+                {
+                    part = "(value << " + std::to_string(shift) + "u)";
+                }
+                else
+                {
+                    part = "(value >> " + std::to_string(fieldShift - shift) + "u)";
+                }
+                const std::string target = byteFromRight(n);
+                if (byteMask == 0xFFu)
+                {
+                    out << "        " << target << " = uint8_t" << part << ";\n";
+                }
+                else
+                {
+                    out << "        " << target << " = uint8_t((" << target << " & ~" << byteMask << "u) | (uint8_t" << part << " & " << byteMask << "u));\n";
+                }
+            }
+        }
+        out << "    }\n";
+    }
+    out << "    return true;\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool builtin = false;
+    std::string output;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--builtin")
+        {
+            builtin = true;
+        }
+        else if ((argument == "-o") && (i + 1 < argc))
+        {
+            output = argv[++i];
+        }
+        else
+        {
+            files.push_back(argument);
+        }
+    }
+    if (output.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " [--builtin] -o <header> [IODD.xml ...]" << std::endl;
+        return 1;
+    }
+
+    // later inputs replace the layouts of the same device, as at runtime
+    std::vector<IoddLayout> layouts;
+    if (builtin)
+    {
+        layouts = IoddService::builtinLayouts();
+    }
+    for (const std::string &file : files)
+    {
+        std::ifstream input(file, std::ios::binary);
+        std::stringstream content;
+        content << input.rdbuf();
+        std::vector<IoddLayout> fileLayouts;
+        if (!input || !parseIodd(content.str(), fileLayouts))
+        {
+            std::cerr << file << ": no process data" << std::endl;
+            return 1;
+        }
+        for (IoddLayout &layout : fileLayouts)
+        {
+            if (!layout.isDefault)
+            {
+                continue;
+            }
+            layouts.erase(std::remove_if(layouts.begin(), layouts.end(),
+                                         [&layout](const IoddLayout &other) {
+                                             return (other.vendorId == layout.vendorId) && (other.deviceId == layout.deviceId) && (other.direction == layout.direction);
+                                         }),
+                          layouts.end());
+            layouts.push_back(std::move(layout));
+        }
+    }
+
+    std::ostringstream out;
+    out << "#pragma once\n// Generated by iodd_codegen, do not edit.\n";
+    out << "#include \"GeneratedDecoder.h\"\n\nnamespace iodd_generated\n{\n";
+    std::vector<std::string> entries;
+    for (const IoddLayout &layout : layouts)
+    {
+        const DecodePlan plan = compileDecodePlan(layout.elements);
+        if (plan.elements.empty())
+        {
+            std::cerr << "vendor " << layout.vendorId << " device " << layout.deviceId << ": using the generic decoder" << std::endl;
+            continue;
+        }
+        const bool in = (layout.direction == PDDirection::In);
+        const std::string name = "v" + std::to_string(layout.vendorId) + "_d" + std::to_string(layout.deviceId) + (in ? "_in" : "_out");
+        out << "\nnamespace " << name << "\n{\n";
+        out << "constexpr std::size_t MIN_LENGTH = " << minimumLength(plan) << "u;\n";
+        out << "constexpr GeneratedElement elements[] = {\n";
+        out.precision(17);
+        for (std::size_t i = 0; i < plan.elements.size(); i++)
+        {
+            const PlanElement &element = plan.elements[i];
+            out << "    {" << quoted(plan.keys[element.keyIndex]) << ", " << "IolType::" << iolTypeName(element.type) << ", " << element.bitOffset << "u, "
+                << element.bitLength << "u, " << layout.elements[i].subindex << "u, " << element.gradient << ", " << element.offset << "},\n";
+        }
+        out << "};\n";
+        writeDecoder(out, plan);
+        if (!in)
+        {
+            writeEncoder(out, plan);
+        }
+        out << "} // namespace " << name << "\n";
+        entries.push_back("    {" + std::to_string(layout.vendorId) + "u, " + std::to_string(layout.deviceId) + "u, " + (in ? "PDDirection::In" : "PDDirection::Out") + ", " +
+                          name + "::elements, sizeof(" + name + "::elements) / sizeof(GeneratedElement), &" + name + "::decode, " + (in ? "nullptr" : "&" + name + "::encode") + "},\n");
+    }
+    out << "\nconstexpr std::size_t layoutCount = " << entries.size() << "u;\n";
+    out << "constexpr GeneratedLayout layouts[" << std::max<std::size_t>(entries.size(), 1u) << "] = {\n";
+    for (const std::string &entry : entries)
+    {
+        out << entry;
+    }
+    out << "};\n\n} // namespace iodd_generated\n";
+
+    // leave the header untouched if nothing changed, avoids rebuilding IoddService.cpp
+    std::ifstream existing(output, std::ios::binary);
+    std::stringstream existingContent;
+    existingContent << existing.rdbuf();
+    if (existing && (existingContent.str() == out.str()))
+    {
+        return 0;
+    }
+    std::ofstream header(output, std::ios::binary | std::ios::trunc);
+    header << out.str();
+    return header ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include "IoddService.h"
+#include "JsonTemplate.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+/*!
+ * @file PayloadBenchmark.cpp
+ * @brief Compares the MQTT process data payload written from a JsonTemplate
+ *        with the one built and dumped by nlohmann, for the builtin devices.
+ *        Fails if a single payload differs.
+ *
+ *        payload_benchmark [iterations]
+ *
+ * @copyright 2022 Balluff GmbH, all rights reserved
+ * @author See AUTHORS file
+ * @since 18.10.2026
+ */
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double nanoseconds(Clock::duration duration, long iterations)
+{
+    return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const long iterations = (argc > 1) ? std::atol(argv[1]) : 100000;
+    if (iterations <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    IoddService service;
+    std::mt19937_64 random(1);
+    const std::string timestamp = "2022-08-11 10:15:42.123";
+    std::string payload;
+    std::size_t sink = 0;
+    long mismatches = 0;
+
+    std::printf("%-10s %-10s %8s %14s %14s\n", "VendorID", "DeviceID", "elements", "nlohmann [ns]", "template [ns]");
+    for (const IoddLayout &layout : IoddService::builtinLayouts())
+    {
+        std::shared_ptr<const DecodePlan> plan = service.findPlan(layout.vendorId, layout.deviceId, 1);
+        if ((layout.direction != PDDirection::In) || !plan || plan->elements.empty())
+        {
+            continue;
+        }
+        const JsonTemplate json(plan);
+        std::vector<uint8_t> data(PD_MAX_LENGTH);
+        std::vector<IolValue> values(plan->elements.size());
+
+        // random PD, including short records (Invalid) and NaN/Inf floats
+        for (long i = 0; i < iterations; i++)
+        {
+            for (uint8_t &byte : data)
+            {
+                byte = static_cast<uint8_t>(random());
+            }
+            IoddService::decode(*plan, data.data(), random() % (data.size() + 1), values.data());
+            nlohmann::json expected = IoddService::toJson(*plan, values.data());
+            expected["ts"] = timestamp;
+            json.serialize(values.data(), timestamp, payload);
+            if (payload != expected.dump())
+            {
+                if (mismatches++ == 0)
+                {
+                    std::fprintf(stderr, "expected %s\nwritten  %s\n", expected.dump().c_str(), payload.c_str());
+                }
+            }
+        }
+
+        IoddService::decode(*plan, data.data(), data.size(), values.data());
+        const Clock::time_point start = Clock::now();
+        for (long i = 0; i < iterations; i++)
+        {
+            nlohmann::json object = IoddService::toJson(*plan, values.data());
+            object["ts"] = timestamp;
+            const std::string dumped = object.dump();
+            sink += dumped.size();
+        }
+        const Clock::time_point middle = Clock::now();
+        for (long i = 0; i < iterations; i++)
+        {
+            json.serialize(values.data(), timestamp, payload);
+            sink += payload.size();
+        }
+        const Clock::time_point end = Clock::now();
+        std::printf("%-10u %-10u %8zu %14.0f %14.0f\n", layout.vendorId, layout.deviceId, plan->elements.size(),
+                    nanoseconds(middle - start, iterations), nanoseconds(end - middle, iterations));
+    }
+    std::printf("%ld mismatching payloads (%zu)\n", mismatches, sink % 10);
+    return (mismatches == 0) ? 0 : 1;
+}